@@ -379,6 +379,31 @@ public class GameController implements MessageListener {
         });
     }
 
+    private void handleTurnTimeout(String player, String nextPlayer) {
+        // The server already turned the revealed card face down
+        final List<Integer> revealedCards = new ArrayList<>(flippedIndices);
+        flippedIndices.clear();
+        flippedThisTurn = 0;
+
+        Platform.runLater(() -> {
+            for (int index : revealedCards) {
+                if (!cardMatched[index]) {
+                    cardButtons[index].setText("?");
+                    cardButtons[index].setStyle("-fx-font-size: 24px; -fx-font-weight: bold;");
+                }
+            }
+
+            updateTurnLabel(nextPlayer);
+            if (player.equals(nickname)) {
+                updateStatus("Time is up! " + nextPlayer + "'s turn.");
+            } else if (nextPlayer.equals(nickname)) {
+                updateStatus(player + " ran out of time. Your turn now.");
+            } else {
+                updateStatus(player + " ran out of time. " + nextPlayer + "'s turn.");
+            }
+        });
+    }
+
     private void showAlert(String message) {
         Platform.runLater(() -> {
             Alert alert = new Alert(Alert.AlertType.INFORMATION);
@@ -551,6 +576,13 @@ public class GameController implements MessageListener {
                 handleMismatch(nextPlayer);
                 break;
 
+            case "TURN_TIMEOUT":
+                // Format: TURN_TIMEOUT <player> <next_player>
+                if (parts.length >= 3) {
+                    handleTurnTimeout(parts[1], parts[2]);
+                }
+                break;
+
             case "GAME_END":
                 handleGameEnd(message, false);
                 break;
@@ -563,9 +595,14 @@ public class GameController implements MessageListener {
                 returnToLobby();
                 break;
 
+            case "ROOM_CLOSED":
+                // Server closed the room - LEFT_ROOM follows
+                System.out.println("Room closed: " + message);
+                break;
+
             case "PING":
                 // Respond to PING with PONG
-                connection.sendMessage("PONG");
+                connection.sendPong(message);
                 break;
 
             case "ERROR":
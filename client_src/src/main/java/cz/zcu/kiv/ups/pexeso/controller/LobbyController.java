@@ -3,6 +3,7 @@ package cz.zcu.kiv.ups.pexeso.controller;
 import cz.zcu.kiv.ups.pexeso.model.Room;
 import cz.zcu.kiv.ups.pexeso.network.ClientConnection;
 import cz.zcu.kiv.ups.pexeso.network.MessageListener;
+import cz.zcu.kiv.ups.pexeso.protocol.ProtocolConstants;
 import cz.zcu.kiv.ups.pexeso.util.Logger;
 import javafx.application.Platform;
 import javafx.collections.FXCollections;
@@ -185,7 +186,12 @@ public class LobbyController implements MessageListener {
         }
 
         // Send with error checking
-        boolean sent = connection.sendMessage("JOIN_ROOM " + selectedRoom.getId());
+        // Tagged request: if the join fails (room full/gone), the list is stale - refresh it right away
+        boolean sent = connection.sendMessage("JOIN_ROOM " + selectedRoom.getId(), reply -> {
+            if (reply.startsWith(ProtocolConstants.CMD_ERROR)) {
+                refreshRooms();
+            }
+        });
         if (sent) {
             updateStatus("Joining room...");
         } else {
@@ -258,7 +264,7 @@ public class LobbyController implements MessageListener {
                 break;
             case "PING":
                 // Respond to PING with PONG
-                connection.sendMessage("PONG");
+                connection.sendPong(message);
                 break;
             case "ERROR":
                 handleError(message);
@@ -156,6 +156,9 @@ public class LoginController implements MessageListener {
 
                 // Connection successful, send HELLO
                 String helloMessage = ProtocolConstants.CMD_HELLO + " " + nickname;
+                if (ProtocolConstants.USE_BINARY_PROTOCOL) {
+                    helloMessage += " " + ProtocolConstants.CAP_BINARY;
+                }
                 connection.sendMessage(helloMessage);
                 log("Sent: " + helloMessage);
 
@@ -225,11 +228,17 @@ public class LoginController implements MessageListener {
             log("Successfully authenticated!");
             // Switch to lobby view
             switchToLobby();
+        } else if (message.startsWith(ProtocolConstants.CMD_QUEUE_POSITION)) {
+            // Format: QUEUE_POSITION <position> <waiting> - server is full, HELLO is answered once a slot frees up
+            String[] parts = message.split(" ");
+            if (parts.length >= 3) {
+                log("Server is full, waiting in queue: position " + parts[1] + " of " + parts[2]);
+            }
         } else if (message.startsWith(ProtocolConstants.CMD_ERROR)) {
             log("Server error: " + message);
         } else if (message.startsWith(ProtocolConstants.CMD_PING)) {
             // Respond to PING with PONG
-            connection.sendMessage(ProtocolConstants.CMD_PONG);
+            connection.sendPong(message);
             log("Sent: " + ProtocolConstants.CMD_PONG);
         }
     }
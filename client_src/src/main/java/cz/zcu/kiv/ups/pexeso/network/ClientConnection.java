@@ -3,15 +3,20 @@ package cz.zcu.kiv.ups.pexeso.network;
 import cz.zcu.kiv.ups.pexeso.protocol.ProtocolConstants;
 import cz.zcu.kiv.ups.pexeso.util.Logger;
 
-import java.io.BufferedReader;
+import java.io.BufferedInputStream;
 import java.util.Arrays;
 import java.util.HashSet;
 import java.io.IOException;
-import java.io.InputStreamReader;
+import java.io.InputStream;
+import java.io.OutputStream;
 import java.io.PrintWriter;
 import java.net.Socket;
 import java.net.SocketTimeoutException;
 import java.nio.charset.StandardCharsets;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.function.Consumer;
 
 /**
  * Manages TCP connection to the game server
@@ -21,7 +26,13 @@ public class ClientConnection {
 
     private Socket socket;
     private PrintWriter out;
-    private BufferedReader in;
+    private OutputStream rawOut;  // Socket stream for binary frames
+    private InputStream in;
+    private volatile boolean binaryMode = false;  // Switched on by "WELCOME <id> BIN"
+
+    // Pipelined requests: "#<id> COMMAND", server echoes the ID on its replies
+    private final AtomicInteger nextRequestId = new AtomicInteger(1);
+    private final Map<Integer, Consumer<String>> pendingRequests = new ConcurrentHashMap<>();
     private Thread readerThread;
     private volatile boolean running = false;
     private MessageListener listener;
@@ -29,12 +40,14 @@ public class ClientConnection {
     private String serverHost;
     private int serverPort;
     private int clientId = -1;  // Client ID for reconnection
+    private volatile String sessionToken = null;  // Secret for RECONNECT (from WELCOME)
     private boolean autoReconnect = false;  // Enable auto-reconnect after authentication
     private volatile boolean reconnecting = false;
     private volatile boolean userDisconnect = false;  // Track user-initiated disconnect
     private volatile boolean serverShutdown = false;  // Track server shutdown
     private volatile boolean invalidDataDisconnect = false;  // Track disconnect due to invalid data
     private int invalidMessageCount = 0;  // Track invalid messages (disconnect after 3)
+    private volatile long lastEventSeq = 0;  // Last room event sequence number seen (for delta resync)
     private static final int MAX_INVALID_MESSAGES = 3;
 
     // Valid protocol commands from server
@@ -58,9 +71,16 @@ public class ClientConnection {
         ProtocolConstants.CMD_GAME_END_FORFEIT,
         ProtocolConstants.CMD_GAME_STATE,
         ProtocolConstants.CMD_LEFT_ROOM,
+        ProtocolConstants.CMD_ROOM_CLOSED,
         ProtocolConstants.CMD_PING,
         ProtocolConstants.CMD_PLAYER_DISCONNECTED,
         ProtocolConstants.CMD_SERVER_SHUTDOWN,
+        ProtocolConstants.CMD_QUICK_MATCH_WAITING,
+        ProtocolConstants.CMD_QUICK_MATCH_CANCELLED,
+        ProtocolConstants.CMD_SPECTATING,
+        ProtocolConstants.CMD_TURN_TIMEOUT,
+        ProtocolConstants.CMD_LEADERBOARD,
+        ProtocolConstants.CMD_QUEUE_POSITION,
         ProtocolConstants.CMD_ERROR
     ));
 
@@ -87,6 +107,8 @@ public class ClientConnection {
         this.serverShutdown = false;  // Reset server shutdown flag for new connection
         this.invalidDataDisconnect = false;  // Reset invalid data flag for new connection
         this.invalidMessageCount = 0;  // Reset invalid message counter for new connection
+        this.lastEventSeq = 0;  // New session starts outside any room
+        this.sessionToken = null;
 
         Logger.info("Connecting to " + host + ":" + port);
 
@@ -98,8 +120,7 @@ public class ClientConnection {
             socket.setSoTimeout(ProtocolConstants.READ_TIMEOUT_MS);
 
             // Setup streams
-            out = new PrintWriter(socket.getOutputStream(), true, StandardCharsets.UTF_8);
-            in = new BufferedReader(new InputStreamReader(socket.getInputStream(), StandardCharsets.UTF_8));
+            openStreams();
 
             // Start reader thread
             running = true;
@@ -133,6 +154,19 @@ public class ClientConnection {
         }
 
         try {
+            if (binaryMode) {
+                byte[] frame = MessageCodec.encodeFrame(message);
+                if (frame == null) {
+                    Logger.warning("Cannot encode binary frame for: " + message);
+                    return false;
+                }
+                synchronized (rawOut) {
+                    rawOut.write(frame);
+                    rawOut.flush();
+                }
+                return true;
+            }
+
             out.println(message);
             return !out.checkError();
         } catch (Exception e) {
@@ -141,6 +175,116 @@ public class ClientConnection {
         }
     }
 
+    /**
+     * Answer a PING, echoing its timestamp so the server can measure round-trip time
+     * Format: PING [ms] -> PONG [ms]
+     *
+     * @param ping PING message as received from server
+     * @return true if sent successfully, false otherwise
+     */
+    public boolean sendPong(String ping) {
+        String[] parts = ping.split(" ");
+        if (parts.length > 1) {
+            return sendMessage(ProtocolConstants.CMD_PONG + " " + parts[1]);
+        }
+        return sendMessage(ProtocolConstants.CMD_PONG);
+    }
+
+    /**
+     * Send a request tagged with a request ID so it can be pipelined with others
+     * The first reply carrying the ID is passed to the callback (on the network thread);
+     * every reply is still delivered to the listener as usual
+     *
+     * @param message Message to send
+     * @param onReply Callback for the first reply (without the ID prefix)
+     * @return true if sent successfully, false otherwise
+     */
+    public boolean sendMessage(String message, Consumer<String> onReply) {
+        int requestId = nextRequestId.getAndIncrement();
+        pendingRequests.put(requestId, onReply);
+
+        boolean sent = sendMessage(ProtocolConstants.REQUEST_ID_PREFIX + requestId + " " + message);
+        if (!sent) {
+            pendingRequests.remove(requestId);
+        }
+        return sent;
+    }
+
+    /**
+     * Strip the request ID prefix from a reply and complete the pending request
+     * Format: #<id> <message>
+     *
+     * @param message Message as received from server
+     * @return Message without prefix
+     */
+    private String unwrapRequestId(String message) {
+        if (!message.startsWith(ProtocolConstants.REQUEST_ID_PREFIX)) {
+            return message;
+        }
+
+        int space = message.indexOf(' ');
+        if (space < 0) {
+            return message;  // Malformed - rejected as unknown command
+        }
+
+        String inner = message.substring(space + 1);
+        try {
+            int requestId = Integer.parseInt(message.substring(ProtocolConstants.REQUEST_ID_PREFIX.length(), space));
+            Consumer<String> callback = pendingRequests.remove(requestId);
+            if (callback != null) {
+                // Callback sees the plain command (room event envelope stripped)
+                String reply = inner;
+                if (inner.startsWith(ProtocolConstants.CMD_SEQ + " ")) {
+                    String[] parts = inner.split(" ", 3);
+                    if (parts.length == 3) {
+                        reply = parts[2];
+                    }
+                }
+                callback.accept(reply);
+            }
+        } catch (NumberFormatException e) {
+            return message;
+        }
+        return inner;
+    }
+
+    /**
+     * Open socket streams for a fresh connection (always starts in text mode)
+     */
+    private void openStreams() throws IOException {
+        rawOut = socket.getOutputStream();
+        out = new PrintWriter(rawOut, true, StandardCharsets.UTF_8);
+        in = new BufferedInputStream(socket.getInputStream());
+        binaryMode = false;
+        pendingRequests.clear();  // Replies to requests on a dead connection never arrive
+    }
+
+    /**
+     * Read next message in the current wire mode (text line or binary frame)
+     *
+     * @return Message text, or null on end of stream
+     */
+    private String readMessage() throws IOException {
+        return binaryMode ? MessageCodec.readFrame(in) : MessageCodec.readLine(in);
+    }
+
+    /**
+     * Switch to binary framing if WELCOME acknowledges the capability, keep the session token
+     * Format: WELCOME <client_id> [BIN] [SESSION <token>] [message]
+     */
+    private void handleWelcome(String welcome) {
+        String[] parts = welcome.split(" ");
+        if (parts.length >= 3 && ProtocolConstants.CAP_BINARY.equals(parts[2])) {
+            binaryMode = true;
+            Logger.info("Server accepted binary protocol");
+        }
+        for (int i = 2; i + 1 < parts.length; i++) {
+            if (ProtocolConstants.SESSION_KEYWORD.equals(parts[i])) {
+                sessionToken = parts[i + 1];
+            }
+        }
+    }
+
     /**
      * Check if connected to server
      *
@@ -208,14 +352,51 @@ public class ClientConnection {
         return VALID_SERVER_COMMANDS.contains(command);
     }
 
+    /**
+     * Strip the SEQ envelope from a room event and remember its sequence number
+     * Format: SEQ <seq> <message>
+     * Entering or leaving a room resets the sequence, because numbering is per room
+     *
+     * @param message Message as received from server
+     * @return Message without envelope
+     */
+    private String unwrapRoomEvent(String message) {
+        String inner = message;
+        long seq = -1;
+
+        if (message.startsWith(ProtocolConstants.CMD_SEQ + " ")) {
+            String[] parts = message.split(" ", 3);
+            if (parts.length < 3) {
+                return message;  // Malformed envelope - rejected as unknown command
+            }
+            try {
+                seq = Long.parseLong(parts[1]);
+                inner = parts[2];
+            } catch (NumberFormatException e) {
+                return message;
+            }
+        }
+
+        if (inner.startsWith(ProtocolConstants.CMD_ROOM_CREATED) ||
+            inner.startsWith(ProtocolConstants.CMD_ROOM_JOINED) ||
+            inner.startsWith(ProtocolConstants.CMD_LEFT_ROOM)) {
+            lastEventSeq = 0;
+        }
+        if (seq > lastEventSeq) {
+            lastEventSeq = seq;
+        }
+
+        return inner;
+    }
+
     /**
      * Reader thread loop - reads messages from server
      */
     private void readerLoop() {
         try {
             String line;
-            while (running && (line = in.readLine()) != null) {
-                final String message = line.trim();
+            while (running && (line = readMessage()) != null) {
+                String message = line.trim();
 
                 // Validate message: reject binary/non-printable data
                 if (!isValidMessage(message)) {
@@ -235,6 +416,10 @@ public class ClientConnection {
                     continue;  // Skip this message, try next one
                 }
 
+                // Strip request ID and sequence envelope from room events
+                message = unwrapRequestId(message);
+                message = unwrapRoomEvent(message);
+
                 // Validate protocol command: reject unknown commands
                 if (!isValidProtocolCommand(message)) {
                     invalidMessageCount++;
@@ -256,6 +441,11 @@ public class ClientConnection {
                 // Valid message received - reset invalid counter
                 invalidMessageCount = 0;
 
+                // Everything after an acknowledging WELCOME is framed
+                if (message.startsWith(ProtocolConstants.CMD_WELCOME)) {
+                    handleWelcome(message);
+                }
+
                 if (!message.isEmpty()) {
                     // Check for server shutdown before passing to listener
                     if (message.startsWith(ProtocolConstants.CMD_SERVER_SHUTDOWN)) {
@@ -414,7 +604,7 @@ public class ClientConnection {
      * @return true if reconnect successful, false otherwise
      */
     public boolean reconnect() {
-        if (clientId <= 0 || reconnecting) {
+        if (clientId <= 0 || sessionToken == null || reconnecting) {
             return false;
         }
 
@@ -431,16 +621,24 @@ public class ClientConnection {
             socket.setSoTimeout(ProtocolConstants.READ_TIMEOUT_MS);
 
             // Setup streams
-            out = new PrintWriter(socket.getOutputStream(), true, StandardCharsets.UTF_8);
-            in = new BufferedReader(new InputStreamReader(socket.getInputStream(), StandardCharsets.UTF_8));
+            openStreams();
 
-            // Send RECONNECT command
-            out.println("RECONNECT " + clientId);
+            // Send RECONNECT command with last seen room event (server replays only what we missed)
+            String reconnectMessage = "RECONNECT " + sessionToken + " " + lastEventSeq;
+            if (ProtocolConstants.USE_BINARY_PROTOCOL) {
+                reconnectMessage += " " + ProtocolConstants.CAP_BINARY;
+            }
+            out.println(reconnectMessage);
 
-            // Wait for response
-            String response = in.readLine();
+            // Wait for response (a full server queues the connection and reports its place first)
+            String response = MessageCodec.readLine(in);
+            while (response != null && response.startsWith(ProtocolConstants.CMD_QUEUE_POSITION)) {
+                response = MessageCodec.readLine(in);
+            }
 
             if (response != null && response.startsWith("WELCOME")) {
+                handleWelcome(response);
+
                 // Reconnect successful, restart reader thread
                 running = true;
                 userDisconnect = false;
@@ -0,0 +1,250 @@
+package cz.zcu.kiv.ups.pexeso.network;
+
+import cz.zcu.kiv.ups.pexeso.protocol.ProtocolConstants;
+
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Wire codec for text lines and the negotiated binary framing
+ *
+ * Frame:  varint body_length, body
+ * Body:   [0x00, varint request_id], opcode (1 byte), fields
+ * Field:  varint (value << 2 | tag); tag 0 = zigzag integer,
+ *         tag 1 = string (value = byte length, bytes follow), tag 2 = command opcode
+ *
+ * Must stay in sync with server_src/codec.c (same opcode order).
+ */
+public final class MessageCodec {
+
+    private static final int FIELD_INT = 0;
+    private static final int FIELD_STRING = 1;
+    private static final int FIELD_COMMAND = 2;
+    private static final int OPCODE_REQUEST_ID = 0;
+
+    private static final int MAX_FRAME_SIZE = ProtocolConstants.MAX_MESSAGE_LENGTH * 2;
+
+    // Opcode = index + 1, append only
+    private static final String[] OPCODES = {
+        "HELLO", "LIST_ROOMS", "CREATE_ROOM", "JOIN_ROOM", "LEAVE_ROOM",
+        "READY", "START_GAME", "FLIP", "PONG", "RECONNECT",
+        "WELCOME", "ROOM_LIST", "ROOM_CREATED", "ROOM_JOINED", "PLAYER_JOINED",
+        "PLAYER_LEFT", "PLAYER_READY", "PLAYER_RECONNECTED", "PLAYER_DISCONNECTED",
+        "ROOM_OWNER_CHANGED", "GAME_CREATED", "GAME_START", "GAME_STATE", "GAME_END",
+        "GAME_END_FORFEIT", "YOUR_TURN", "CARD_REVEAL", "MATCH", "MISMATCH",
+        "LEFT_ROOM", "PING", "SERVER_SHUTDOWN", "ERROR", "SEQ",
+        "READY_OK", "ROOM_CLOSED", "QUICK_MATCH", "QUICK_MATCH_WAITING", "QUICK_MATCH_CANCELLED",
+        "SPECTATE", "SPECTATING", "TURN_TIMEOUT", "ADD_BOT",
+        "LEADERBOARD", "QUEUE_POSITION"
+    };
+
+    private static final Map<String, Integer> OPCODE_BY_NAME = new HashMap<>();
+
+    static {
+        for (int i = 0; i < OPCODES.length; i++) {
+            OPCODE_BY_NAME.put(OPCODES[i], i + 1);
+        }
+    }
+
+    private MessageCodec() {
+        // Utility class - no instantiation
+    }
+
+    /**
+     * Read one newline-terminated text message (byte-wise, so a switch to
+     * binary framing right after it never loses buffered bytes)
+     *
+     * @param in Input stream
+     * @return Line without newline, or null on end of stream
+     */
+    public static String readLine(InputStream in) throws IOException {
+        ByteArrayOutputStream line = new ByteArrayOutputStream();
+        int b;
+        while ((b = in.read()) != -1) {
+            if (b == '\n') {
+                return line.toString(StandardCharsets.UTF_8);
+            }
+            if (b != '\r') {
+                line.write(b);
+            }
+        }
+        return line.size() > 0 ? line.toString(StandardCharsets.UTF_8) : null;
+    }
+
+    /**
+     * Read one binary frame and decode it to the equivalent text message
+     *
+     * @param in Input stream
+     * @return Text message, or null on end of stream
+     */
+    public static String readFrame(InputStream in) throws IOException {
+        int first = in.read();
+        if (first == -1) {
+            return null;
+        }
+
+        // Length prefix
+        int length = first & 0x7F;
+        int shift = 7;
+        int b = first;
+        while ((b & 0x80) != 0) {
+            b = in.read();
+            if (b == -1) {
+                throw new EOFException("Truncated frame length");
+            }
+            if (shift > 28) {
+                throw new IOException("Frame length overflow");
+            }
+            length |= (b & 0x7F) << shift;
+            shift += 7;
+        }
+        if (length <= 0 || length > MAX_FRAME_SIZE) {
+            throw new IOException("Invalid frame length: " + length);
+        }
+
+        byte[] body = new byte[length];
+        int read = 0;
+        while (read < length) {
+            int n = in.read(body, read, length - read);
+            if (n == -1) {
+                throw new EOFException("Truncated frame");
+            }
+            read += n;
+        }
+
+        return decodeBody(body);
+    }
+
+    private static String decodeBody(byte[] body) throws IOException {
+        StringBuilder sb = new StringBuilder();
+        int[] pos = {0};
+
+        // Optional request ID prefix
+        if ((body[0] & 0xFF) == OPCODE_REQUEST_ID) {
+            pos[0] = 1;
+            long requestId = readVarint(body, pos);
+            if (pos[0] >= body.length) {
+                throw new IOException("Truncated request frame");
+            }
+            sb.append(ProtocolConstants.REQUEST_ID_PREFIX).append(requestId).append(' ');
+        }
+
+        int opcode = body[pos[0]++] & 0xFF;
+        if (opcode < 1 || opcode > OPCODES.length) {
+            throw new IOException("Unknown opcode: " + opcode);
+        }
+        sb.append(OPCODES[opcode - 1]);
+        while (pos[0] < body.length) {
+            long field = readVarint(body, pos);
+            int tag = (int) (field & 0x3);
+            long value = field >>> 2;
+
+            sb.append(' ');
+            if (tag == FIELD_INT) {
+                sb.append((int) ((value >>> 1) ^ -(value & 1)));
+            } else if (tag == FIELD_STRING) {
+                if (value > body.length - pos[0]) {
+                    throw new IOException("Truncated string field");
+                }
+                sb.append(new String(body, pos[0], (int) value, StandardCharsets.UTF_8));
+                pos[0] += (int) value;
+            } else if (tag == FIELD_COMMAND && value >= 1 && value <= OPCODES.length) {
+                sb.append(OPCODES[(int) value - 1]);
+            } else {
+                throw new IOException("Invalid field tag: " + tag);
+            }
+        }
+        return sb.toString();
+    }
+
+    private static long readVarint(byte[] buf, int[] pos) throws IOException {
+        long result = 0;
+        int shift = 0;
+        while (pos[0] < buf.length && shift <= 28) {
+            int b = buf[pos[0]++] & 0xFF;
+            result |= (long) (b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return result;
+            }
+            shift += 7;
+        }
+        throw new IOException("Malformed varint");
+    }
+
+    /**
+     * Encode a text message as a binary frame
+     *
+     * @param message Text message (without newline)
+     * @return Frame bytes, or null if the command has no opcode
+     */
+    public static byte[] encodeFrame(String message) {
+        String[] tokens = message.split(" ", -1);
+        ByteArrayOutputStream body = new ByteArrayOutputStream();
+        int first = 0;
+
+        // Optional request ID prefix (#<id>)
+        if (tokens.length > 1 && tokens[0].startsWith(ProtocolConstants.REQUEST_ID_PREFIX)) {
+            Integer requestId = parseCanonicalInt(tokens[0].substring(ProtocolConstants.REQUEST_ID_PREFIX.length()));
+            if (requestId == null || requestId <= 0) {
+                return null;
+            }
+            body.write(OPCODE_REQUEST_ID);
+            writeVarint(body, requestId);
+            first = 1;
+        }
+
+        Integer opcode = OPCODE_BY_NAME.get(tokens[first]);
+        if (opcode == null) {
+            return null;
+        }
+        body.write(opcode);
+
+        for (int i = first + 1; i < tokens.length; i++) {
+            String token = tokens[i];
+            Integer intValue = parseCanonicalInt(token);
+            Integer command = OPCODE_BY_NAME.get(token);
+
+            long zigzag = intValue != null ? ((long) (intValue << 1) ^ (intValue >> 31)) & 0xFFFFFFFFL : 0;
+            if (intValue != null && zigzag <= (0xFFFFFFFFL >>> 2)) {
+                writeVarint(body, (zigzag << 2) | FIELD_INT);
+            } else if (command != null) {
+                writeVarint(body, ((long) command << 2) | FIELD_COMMAND);
+            } else {
+                byte[] bytes = token.getBytes(StandardCharsets.UTF_8);
+                writeVarint(body, ((long) bytes.length << 2) | FIELD_STRING);
+                body.write(bytes, 0, bytes.length);
+            }
+        }
+
+        ByteArrayOutputStream frame = new ByteArrayOutputStream();
+        writeVarint(frame, body.size());
+        frame.write(body.toByteArray(), 0, body.size());
+        return frame.toByteArray();
+    }
+
+    // Integer in canonical form only, so decoding reproduces the exact token
+    private static Integer parseCanonicalInt(String token) {
+        if (token.isEmpty() || token.length() > 11) {
+            return null;
+        }
+        try {
+            int value = Integer.parseInt(token);
+            return Integer.toString(value).equals(token) ? value : null;
+        } catch (NumberFormatException e) {
+            return null;
+        }
+    }
+
+    private static void writeVarint(ByteArrayOutputStream out, long value) {
+        do {
+            int b = (int) (value & 0x7F);
+            value >>>= 7;
+            out.write(b | (value != 0 ? 0x80 : 0));
+        } while (value != 0);
+    }
+}
@@ -16,6 +16,10 @@ public class ProtocolConstants {
     public static final String CMD_FLIP = "FLIP";
     public static final String CMD_PONG = "PONG";
     public static final String CMD_RECONNECT = "RECONNECT";
+    public static final String CMD_QUICK_MATCH = "QUICK_MATCH";  // QUICK_MATCH [max_players] [board_size] | QUICK_MATCH CANCEL
+    public static final String CMD_SPECTATE = "SPECTATE";  // SPECTATE <room_id> (LEAVE_ROOM stops watching)
+    public static final String CMD_ADD_BOT = "ADD_BOT";  // ADD_BOT [skill] [think_ms] (room owner, before the game)
+    public static final String CMD_LEADERBOARD = "LEADERBOARD";  // Request and reply: LEADERBOARD <count> [<nick> <games> <wins> <pairs> <flips_per_game>]...
 
     // Server to Client commands
     public static final String CMD_WELCOME = "WELCOME";
@@ -37,10 +41,17 @@ public class ProtocolConstants {
     public static final String CMD_GAME_END_FORFEIT = "GAME_END_FORFEIT";
     public static final String CMD_GAME_STATE = "GAME_STATE";
     public static final String CMD_LEFT_ROOM = "LEFT_ROOM";
+    public static final String CMD_ROOM_CLOSED = "ROOM_CLOSED";
     public static final String CMD_PING = "PING";
     public static final String CMD_PLAYER_DISCONNECTED = "PLAYER_DISCONNECTED";
     public static final String CMD_SERVER_SHUTDOWN = "SERVER_SHUTDOWN";
     public static final String CMD_ERROR = "ERROR";
+    public static final String CMD_SEQ = "SEQ";  // Envelope: SEQ <seq> <room event>
+    public static final String CMD_QUICK_MATCH_WAITING = "QUICK_MATCH_WAITING";
+    public static final String CMD_QUICK_MATCH_CANCELLED = "QUICK_MATCH_CANCELLED";
+    public static final String CMD_SPECTATING = "SPECTATING";
+    public static final String CMD_TURN_TIMEOUT = "TURN_TIMEOUT";  // TURN_TIMEOUT <player> <next_player>
+    public static final String CMD_QUEUE_POSITION = "QUEUE_POSITION";  // QUEUE_POSITION <position> <waiting> (server full)
 
     // Error codes
     public static final String ERR_INVALID_COMMAND = "INVALID_COMMAND";
@@ -55,8 +66,20 @@ public class ProtocolConstants {
     public static final String ERR_GAME_NOT_STARTED = "GAME_NOT_STARTED";
     public static final String ERR_NOT_YOUR_TURN = "NOT_YOUR_TURN";
     public static final String ERR_INVALID_CARD = "INVALID_CARD";
+    public static final String ERR_ALREADY_QUEUED = "ALREADY_QUEUED";
+    public static final String ERR_NOT_QUEUED = "NOT_QUEUED";
     public static final String ERR_NOT_IMPLEMENTED = "NOT_IMPLEMENTED";
 
+    // Pipelining: optional request ID prefix "#<id> " echoed on replies
+    public static final String REQUEST_ID_PREFIX = "#";
+
+    // Capabilities
+    public static final String CAP_BINARY = "BIN";  // Binary framing after WELCOME (see MessageCodec)
+    public static final boolean USE_BINARY_PROTOCOL = true;
+
+    // Session token issued in WELCOME, sent back in RECONNECT
+    public static final String SESSION_KEYWORD = "SESSION";
+
     // Message format
     public static final String MESSAGE_DELIMITER = "\n";
     public static final int MAX_MESSAGE_LENGTH = 1024;
@@ -0,0 +1,458 @@
+#include "admin.h"
+#include "client_handler.h"
+#include "client_list.h"
+#include "room.h"
+#include "game.h"
+#include "server.h"
+#include "worker_pool.h"
+#include "logger.h"
+#include "clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define ADMIN_POLL_INTERVAL_MS 500  // How often the accept loop checks for shutdown
+
+// Growable reply buffer
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} admin_buffer_t;
+
+static pthread_t admin_thread;
+static int admin_fd = -1;
+static int admin_running = 0;
+static char admin_path[108];
+
+static void buffer_printf(admin_buffer_t *buffer, const char *format, ...) {
+    while (1) {
+        size_t available = buffer->capacity - buffer->length;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer->data + buffer->length, available, format, args);
+        va_end(args);
+
+        if (written < 0) {
+            return;
+        }
+        if ((size_t)written < available) {
+            buffer->length += written;
+            return;
+        }
+
+        size_t capacity = buffer->capacity * 2 + written;
+        char *data = (char *)realloc(buffer->data, capacity);
+        if (data == NULL) {
+            return;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+}
+
+// Nicknames and room names are protocol tokens, but escape anyway
+static void buffer_json_string(admin_buffer_t *buffer, const char *text) {
+    buffer_printf(buffer, "\"");
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            buffer_printf(buffer, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            buffer_printf(buffer, "\\u%04x", (unsigned char)*c);
+        } else {
+            buffer_printf(buffer, "%c", *c);
+        }
+    }
+    buffer_printf(buffer, "\"");
+}
+
+static const char* client_state_name(client_state_t state) {
+    switch (state) {
+        case STATE_DISCONNECTED:  return "disconnected";
+        case STATE_CONNECTED:     return "connected";
+        case STATE_AUTHENTICATED: return "authenticated";
+        case STATE_IN_LOBBY:      return "lobby";
+        case STATE_IN_ROOM:       return "room";
+        case STATE_IN_GAME:       return "game";
+        default:                  return "unknown";
+    }
+}
+
+static const char* room_state_name(room_state_t state) {
+    switch (state) {
+        case ROOM_STATE_WAITING:  return "waiting";
+        case ROOM_STATE_PLAYING:  return "playing";
+        case ROOM_STATE_FINISHED: return "finished";
+        default:                  return "unknown";
+    }
+}
+
+static const char* game_state_name(int state) {
+    switch (state) {
+        case GAME_STATE_WAITING:  return "waiting";
+        case GAME_STATE_PLAYING:  return "playing";
+        case GAME_STATE_FINISHED: return "finished";
+        default:                  return "unknown";
+    }
+}
+
+// Rooms are copied under the room lock, formatting happens afterwards
+static void dump_rooms(admin_buffer_t *buffer) {
+    int max_rooms = server_get_config()->max_rooms;
+    room_info_t *infos = (room_info_t *)malloc((size_t)max_rooms * sizeof(room_info_t));
+    if (infos == NULL) {
+        buffer_printf(buffer, "[]");
+        return;
+    }
+
+    int count = room_get_info_all(infos, max_rooms);
+
+    buffer_printf(buffer, "[");
+    for (int i = 0; i < count; i++) {
+        room_info_t *info = &infos[i];
+
+        buffer_printf(buffer, "%s{\"id\":%d,\"name\":", i > 0 ? "," : "", info->room_id);
+        buffer_json_string(buffer, info->name);
+        buffer_printf(buffer, ",\"state\":\"%s\",\"players\":%d,\"max_players\":%d,\"board_size\":%d,"
+                      "\"event_seq\":%u,\"mailbox_depth\":%d,\"spectators\":%d,\"turn_seconds\":%d,\"owner\":",
+                      room_state_name(info->state), info->player_count, info->max_players,
+                      info->board_size, info->event_seq, worker_pool_queue_depth(info->room_id),
+                      info->spectators, info->turn_seconds);
+        buffer_json_string(buffer, info->owner);
+
+        buffer_printf(buffer, ",\"seats\":[");
+        int first = 1;
+        for (int j = 0; j < MAX_PLAYERS_PER_ROOM; j++) {
+            if (info->player_ids[j] == 0) {
+                continue;
+            }
+            buffer_printf(buffer, "%s{\"client_id\":%d,\"nickname\":", first ? "" : ",", info->player_ids[j]);
+            buffer_json_string(buffer, info->players[j]);
+            buffer_printf(buffer, "}");
+            first = 0;
+        }
+        buffer_printf(buffer, "]");
+
+        if (info->has_game) {
+            buffer_printf(buffer, ",\"game\":{\"state\":\"%s\",\"current_player\":%d,"
+                          "\"matched_pairs\":%d,\"total_pairs\":%d,\"scores\":[",
+                          game_state_name(info->game_state), info->current_player,
+                          info->matched_pairs, info->total_pairs);
+            for (int j = 0; j < info->player_count && j < MAX_PLAYERS_PER_ROOM; j++) {
+                buffer_printf(buffer, "%s%d", j > 0 ? "," : "", info->scores[j]);
+            }
+            buffer_printf(buffer, "],\"ready\":[");
+            for (int j = 0; j < info->player_count && j < MAX_PLAYERS_PER_ROOM; j++) {
+                buffer_printf(buffer, "%s%d", j > 0 ? "," : "", info->ready[j]);
+            }
+            buffer_printf(buffer, "]}");
+        } else {
+            buffer_printf(buffer, ",\"game\":null");
+        }
+
+        buffer_printf(buffer, "}");
+    }
+    buffer_printf(buffer, "]");
+
+    free(infos);
+}
+
+static void dump_clients(admin_buffer_t *buffer) {
+    int max_clients = server_get_config()->max_clients;
+    client_t **clients = (client_t **)malloc((size_t)max_clients * sizeof(client_t *));
+    if (clients == NULL) {
+        buffer_printf(buffer, "[]");
+        return;
+    }
+
+    int count = client_list_get_all(clients, max_clients);
+    int64_t now_ms = clock_now_ms();
+
+    buffer_printf(buffer, "[");
+    for (int i = 0; i < count; i++) {
+        client_t *client = clients[i];
+        room_t *room = client->room;
+
+        buffer_printf(buffer, "%s{\"id\":%d,\"nickname\":", i > 0 ? "," : "", client->client_id);
+        buffer_json_string(buffer, client->nickname);
+        buffer_printf(buffer, ",\"state\":\"%s\",\"room\":%d,\"disconnected\":%s,\"binary\":%s,"
+                      "\"srtt_ms\":%d,\"rttvar_ms\":%d,\"heartbeat_interval\":%d,\"idle_s\":%ld,"
+                      "\"bytes_in\":%llu,\"bytes_out\":%llu,\"queued_commands\":%d,\"errors\":%d}",
+                      client_state_name(client->state), room != NULL ? room->room_id : 0,
+                      client->is_disconnected ? "true" : "false",
+                      client->binary_mode ? "true" : "false",
+                      client->srtt_ms, client->rttvar_ms, client->heartbeat_interval,
+                      (long)((now_ms - client->last_activity_ms) / 1000),
+                      (unsigned long long)atomic_load(&client->bytes_in),
+                      (unsigned long long)atomic_load(&client->bytes_out),
+                      coro_wait_pending(&client->pending_commands), client->invalid_message_count);
+        client_list_release(client);
+    }
+    buffer_printf(buffer, "]");
+
+    free(clients);
+}
+
+// Target is a client ID or a nickname
+static void kick_client(admin_buffer_t *buffer, const char *target) {
+    client_t *client = isdigit((unsigned char)target[0]) ? client_list_find_by_id(atoi(target))
+                                                          : client_list_find_by_nickname(target);
+    if (client == NULL) {
+        buffer_printf(buffer, "ERROR no client %s", target);
+        return;
+    }
+    int client_id = client->client_id;
+
+    // Same as a PONG timeout: the handler sees EOF and cleans up on its own thread
+    int fd = client->socket_fd;
+    if (fd < 0) {
+        buffer_printf(buffer, "ERROR client %d is not connected", client_id);
+        client_list_release(client);
+        return;
+    }
+    shutdown(fd, SHUT_RDWR);
+
+    logger_log(LOG_WARNING, "Admin: Client %d (%s) kicked", client_id, client->nickname);
+    buffer_printf(buffer, "OK kicked %d", client_id);
+    client_list_release(client);
+}
+
+// Runs on the room's worker so it can't interleave with the room's commands
+static void close_room_task(void *arg) {
+    int *room_id = (int *)arg;
+    room_t *room = room_get_by_id(*room_id);
+    if (room == NULL) {
+        *room_id = 0;
+        return;
+    }
+    room_close(room, "Closed by server");
+}
+
+static void close_room(admin_buffer_t *buffer, int room_id) {
+    if (room_get_by_id(room_id) == NULL) {
+        buffer_printf(buffer, "ERROR no room %d", room_id);
+        return;
+    }
+
+    int target = room_id;
+    worker_pool_run_sync(room_id, close_room_task, &target);
+    if (target == 0) {
+        buffer_printf(buffer, "ERROR no room %d", room_id);
+        return;
+    }
+
+    logger_log(LOG_WARNING, "Admin: Room %d closed", room_id);
+    buffer_printf(buffer, "OK closed %d", room_id);
+}
+
+static void write_snapshot(admin_buffer_t *buffer) {
+    admin_buffer_t snapshot = { (char *)malloc(4096), 0, 4096 };
+    if (snapshot.data == NULL) {
+        buffer_printf(buffer, "ERROR out of memory");
+        return;
+    }
+
+    buffer_printf(&snapshot, "{\"time\":%ld,\"rooms\":", (long)time(NULL));
+    dump_rooms(&snapshot);
+    buffer_printf(&snapshot, ",\"clients\":");
+    dump_clients(&snapshot);
+    buffer_printf(&snapshot, "}\n");
+
+    char path[64];
+    snprintf(path, sizeof(path), "snapshot-%ld.json", (long)time(NULL));
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL || fwrite(snapshot.data, 1, snapshot.length, file) != snapshot.length) {
+        buffer_printf(buffer, "ERROR cannot write %s: %s", path, strerror(errno));
+    } else {
+        logger_log(LOG_INFO, "Admin: Snapshot written to %s", path);
+        buffer_printf(buffer, "OK %s", path);
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+
+    free(snapshot.data);
+}
+
+static void handle_command(const char *line, admin_buffer_t *reply) {
+    char command[32] = {0};
+    char argument[64] = {0};
+    char extra[32] = {0};
+    sscanf(line, "%31s %63s %31s", command, argument, extra);
+
+    if (strcmp(command, "rooms") == 0) {
+        dump_rooms(reply);
+    } else if (strcmp(command, "clients") == 0) {
+        dump_clients(reply);
+    } else if (strcmp(command, "kick") == 0 && argument[0] != '\0') {
+        kick_client(reply, argument);
+    } else if (strcmp(command, "close_room") == 0 && argument[0] != '\0') {
+        close_room(reply, atoi(argument));
+    } else if (strcmp(command, "log_level") == 0) {
+        // "log_level room debug" is shorthand for "log_level room=debug"
+        if (extra[0] != '\0' && strlen(argument) + strlen(extra) + 2 <= sizeof(argument)) {
+            strcat(argument, "=");
+            strcat(argument, extra);
+        }
+
+        if (argument[0] != '\0' && logger_configure(argument) != 0) {
+            buffer_printf(reply, "ERROR invalid level spec '%s'", argument);
+            return;
+        }
+        if (argument[0] != '\0') {
+            logger_log(LOG_WARNING, "Admin: Log levels set to %s", argument);
+        }
+
+        buffer_printf(reply, "OK");
+        for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+            buffer_printf(reply, " %s=%s", logger_module_name((log_module_t)i),
+                          logger_level_name(logger_get_level((log_module_t)i)));
+        }
+    } else if (strcmp(command, "snapshot") == 0) {
+        write_snapshot(reply);
+    } else if (strcmp(command, "help") == 0) {
+        buffer_printf(reply, "OK rooms | clients | kick <id|nick> | close_room <id> | log_level [[module] level] | snapshot");
+    } else if (command[0] != '\0') {
+        buffer_printf(reply, "ERROR unknown command '%s' (try help)", command);
+    }
+}
+
+// Serve one admin connection until it closes or stays idle too long
+static void serve_connection(int fd) {
+    char line[ADMIN_MAX_LINE];
+    size_t line_length = 0;
+    admin_buffer_t reply = { (char *)malloc(4096), 0, 4096 };
+    if (reply.data == NULL) {
+        return;
+    }
+
+    while (admin_running) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, ADMIN_READ_TIMEOUT_MS) <= 0) {
+            break;
+        }
+
+        char c;
+        if (recv(fd, &c, 1, 0) <= 0) {
+            break;
+        }
+
+        if (c == '\r') {
+            continue;
+        }
+        if (c != '\n') {
+            if (line_length < sizeof(line) - 1) {
+                line[line_length++] = c;
+            }
+            continue;
+        }
+
+        line[line_length] = '\0';
+        line_length = 0;
+
+        reply.length = 0;
+        handle_command(line, &reply);
+        if (reply.length == 0) {
+            continue;
+        }
+        buffer_printf(&reply, "\n");
+
+        if (send(fd, reply.data, reply.length, MSG_NOSIGNAL) < 0) {
+            break;
+        }
+    }
+
+    free(reply.data);
+}
+
+static void* admin_thread_func(void *arg) {
+    (void)arg;
+
+    logger_log(LOG_INFO, "Admin socket listening on %s", admin_path);
+
+    while (admin_running) {
+        struct pollfd pfd = { admin_fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, ADMIN_POLL_INTERVAL_MS);
+        if (ready <= 0) {
+            continue;
+        }
+
+        int fd = accept(admin_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+
+        serve_connection(fd);
+        close(fd);
+    }
+
+    logger_log(LOG_INFO, "Admin thread terminated");
+    return NULL;
+}
+
+int admin_init(const char *path) {
+    if (path == NULL || path[0] == '\0') {
+        logger_log(LOG_INFO, "Admin socket disabled");
+        return 0;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    snprintf(admin_path, sizeof(admin_path), "%s", path);
+
+    admin_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (admin_fd < 0) {
+        logger_log(LOG_ERROR, "Failed to create admin socket: %s", strerror(errno));
+        return -1;
+    }
+
+    // A stale socket file from a crashed run would make bind() fail
+    unlink(path);
+
+    if (bind(admin_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(admin_fd, 4) < 0) {
+        logger_log(LOG_ERROR, "Failed to bind admin socket %s: %s", path, strerror(errno));
+        close(admin_fd);
+        admin_fd = -1;
+        return -1;
+    }
+    chmod(path, 0600);
+
+    admin_running = 1;
+    int result = pthread_create(&admin_thread, NULL, admin_thread_func, NULL);
+    if (result != 0) {
+        logger_log(LOG_ERROR, "Failed to create admin thread: %s", strerror(result));
+        admin_running = 0;
+        close(admin_fd);
+        admin_fd = -1;
+        unlink(path);
+        return -1;
+    }
+
+    return 0;
+}
+
+void admin_shutdown(void) {
+    if (admin_fd < 0) {
+        return;
+    }
+
+    admin_running = 0;
+    pthread_join(admin_thread, NULL);
+
+    close(admin_fd);
+    admin_fd = -1;
+    unlink(admin_path);
+}
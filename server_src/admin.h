@@ -0,0 +1,33 @@
+#ifndef ADMIN_H
+#define ADMIN_H
+
+/**
+ * Admin module - Unix-domain control socket for operators
+ *
+ * One command per line, one reply per command (JSON or OK/ERROR text):
+ *   rooms                 - rooms and games as JSON
+ *   clients               - clients with state, RTT, bytes and queued commands as JSON
+ *   kick <id|nickname>    - drop a client's connection
+ *   close_room <room_id>  - close a room, players return to the lobby
+ *   log_level [level]     - show or set the log level (info, warning, error)
+ *   snapshot              - write rooms and clients to snapshot-<time>.json
+ *   help                  - list commands
+ * Served by its own thread, so a slow admin client never blocks the game.
+ */
+
+#define ADMIN_MAX_LINE 256
+#define ADMIN_READ_TIMEOUT_MS 30000  // Idle admin connections are closed
+
+/**
+ * Start the admin socket thread
+ * @param path Socket path (empty string disables the socket)
+ * @return 0 on success or when disabled, -1 on error
+ */
+int admin_init(const char *path);
+
+/**
+ * Stop the admin thread and remove the socket file
+ */
+void admin_shutdown(void);
+
+#endif /* ADMIN_H */
@@ -0,0 +1,220 @@
+#define LOG_MODULE LOG_MODULE_SERVER
+
+#include "admission.h"
+#include "server.h"
+#include "timer.h"
+#include "clock.h"
+#include "protocol.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+
+// Timer keys
+#define ADMISSION_PROMOTE 0
+#define ADMISSION_TICK 1
+
+static client_t **queue = NULL;  // Ring, oldest at head
+static int queue_capacity = 0;
+static int queue_head = 0;
+static int queue_count = 0;
+static int running = 0;
+static int tick_scheduled = 0;  // Guarded by admission_mutex
+static pthread_mutex_t admission_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_int waiting = 0;            // queue_count, readable without the lock
+static atomic_int promote_scheduled = 0;
+
+static void admission_timer_fired(int key, unsigned int id);
+
+// Waiting clients never ran a handler: text framing, and the timer thread must not block
+static int send_line(client_t *client, const char *message) {
+    char line[MAX_MESSAGE_LENGTH];
+    int len = snprintf(line, sizeof(line), "%s\n", message);
+    return send(client->socket_fd, line, len, MSG_DONTWAIT | MSG_NOSIGNAL) == len ? 0 : -1;
+}
+
+static int send_position(client_t *client, int position, int total) {
+    char message[MAX_MESSAGE_LENGTH];
+    snprintf(message, sizeof(message), "%s %d %d", CMD_QUEUE_POSITION, position, total);
+    return send_line(client, message);
+}
+
+// The peer hung up (a pending HELLO is fine)
+static int peer_gone(client_t *client) {
+    char byte;
+    ssize_t n = recv(client->socket_fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+static void drop_client(client_t *client) {
+    close(client->socket_fd);
+    free(client);
+}
+
+static void schedule_promote(void) {
+    if (atomic_exchange(&promote_scheduled, 1) != 0) {
+        return;
+    }
+    if (timer_schedule(0, admission_timer_fired, ADMISSION_PROMOTE) == 0) {
+        atomic_store(&promote_scheduled, 0);
+    }
+}
+
+// Start waiting clients, oldest first, while slots are free
+static void promote_waiting(void) {
+    pthread_mutex_lock(&admission_mutex);
+    while (running && queue_count > 0) {
+        client_t *client = queue[queue_head];
+
+        // Time spent waiting doesn't count towards the inactivity timeout
+        client->last_activity_ms = clock_now_ms();
+        client->last_pong_ms = client->last_activity_ms;
+
+        int result = server_start_client(client);
+        if (result == 1) {
+            break;  // Still full
+        }
+
+        queue_head = (queue_head + 1) % queue_capacity;
+        queue_count--;
+        atomic_store(&waiting, queue_count);
+        if (result == 0) {
+            logger_log(LOG_INFO, "Client %d: Admitted from the waiting queue (%d still waiting)",
+                       client->client_id, queue_count);
+        }
+    }
+    pthread_mutex_unlock(&admission_mutex);
+}
+
+// Keep the waiting clients that pass a check, in order (admission_mutex held).
+// The check gets the client's position among the survivors and their count so far:
+// the clients kept plus the ones not checked yet (queue_count still counts the dropped).
+static void prune_queue(int (*gone)(client_t *client, int position, int total)) {
+    int kept = 0;
+    for (int i = 0; i < queue_count; i++) {
+        client_t *client = queue[(queue_head + i) % queue_capacity];
+        if (gone(client, kept + 1, kept + (queue_count - i))) {
+            logger_log(LOG_INFO, "Client %d: Left the waiting queue", client->client_id);
+            drop_client(client);
+            continue;
+        }
+        queue[(queue_head + kept) % queue_capacity] = client;
+        kept++;
+    }
+    queue_count = kept;
+    atomic_store(&waiting, queue_count);
+}
+
+static int check_peer(client_t *client, int position, int total) {
+    (void)position;
+    (void)total;
+    return peer_gone(client);
+}
+
+static int check_position_sent(client_t *client, int position, int total) {
+    return send_position(client, position, total) != 0;
+}
+
+static void admission_timer_fired(int key, unsigned int id) {
+    (void)id;
+
+    if (key == ADMISSION_PROMOTE) {
+        atomic_store(&promote_scheduled, 0);
+        promote_waiting();
+        return;
+    }
+
+    // Periodic tick: admit what fits (a missed wakeup costs one interval at most), then report
+    promote_waiting();
+
+    // Drop clients that left first so the positions add up
+    pthread_mutex_lock(&admission_mutex);
+    prune_queue(check_peer);
+    prune_queue(check_position_sent);
+    tick_scheduled = 0;
+    if (running && queue_count > 0 &&
+        timer_schedule(ADMISSION_POSITION_INTERVAL_MS, admission_timer_fired, ADMISSION_TICK) != 0) {
+        tick_scheduled = 1;
+    }
+    pthread_mutex_unlock(&admission_mutex);
+}
+
+int admission_init(int capacity) {
+    pthread_mutex_lock(&admission_mutex);
+    if (capacity > 0) {
+        queue = (client_t **)calloc(capacity, sizeof(client_t *));
+        if (queue == NULL) {
+            pthread_mutex_unlock(&admission_mutex);
+            logger_log(LOG_ERROR, "Failed to allocate admission queue");
+            return -1;
+        }
+    }
+    queue_capacity = capacity;
+    queue_head = 0;
+    queue_count = 0;
+    running = 1;
+    pthread_mutex_unlock(&admission_mutex);
+
+    logger_log(LOG_INFO, "Admission queue: up to %d waiting connections", capacity);
+    return 0;
+}
+
+void admission_shutdown(void) {
+    pthread_mutex_lock(&admission_mutex);
+    running = 0;
+    for (int i = 0; i < queue_count; i++) {
+        client_t *client = queue[(queue_head + i) % queue_capacity];
+        send_line(client, "SERVER_SHUTDOWN Server is shutting down");
+        drop_client(client);
+    }
+    if (queue_count > 0) {
+        logger_log(LOG_INFO, "Closed %d waiting connection(s)", queue_count);
+    }
+    queue_count = 0;
+    atomic_store(&waiting, 0);
+    free(queue);
+    queue = NULL;
+    queue_capacity = 0;
+    pthread_mutex_unlock(&admission_mutex);
+}
+
+int admission_waiting(void) {
+    return atomic_load(&waiting);
+}
+
+int admission_enqueue(client_t *client) {
+    pthread_mutex_lock(&admission_mutex);
+    if (!running || queue_count == queue_capacity) {
+        pthread_mutex_unlock(&admission_mutex);
+        return -1;
+    }
+
+    queue[(queue_head + queue_count) % queue_capacity] = client;
+    queue_count++;
+    int position = queue_count;
+    atomic_store(&waiting, queue_count);
+    send_position(client, position, queue_count);
+
+    if (!tick_scheduled &&
+        timer_schedule(ADMISSION_POSITION_INTERVAL_MS, admission_timer_fired, ADMISSION_TICK) != 0) {
+        tick_scheduled = 1;
+    }
+    pthread_mutex_unlock(&admission_mutex);
+
+    logger_log(LOG_INFO, "Client %d: Server full, waiting for a slot (position %d)", client->client_id, position);
+
+    // A slot freed just before the client was queued would otherwise wait for the tick
+    schedule_promote();
+    return 0;
+}
+
+void admission_slot_freed(void) {
+    if (atomic_load(&waiting) > 0) {
+        schedule_promote();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "client_handler.h"
+
+/**
+ * Admission module - waiting queue for connections while the server is full
+ *
+ * A connection that finds every client slot taken is parked here instead of
+ * being closed: it gets QUEUE_POSITION right away and again every
+ * ADMISSION_POSITION_INTERVAL_MS, and no handler runs for it (its HELLO waits in
+ * the socket). When a slot frees up, the oldest waiting connection is started
+ * like a fresh one. New connections join the back of the queue while anyone is
+ * waiting, so nobody is overtaken. Only a full queue closes connections.
+ * Queue work runs on the timer thread.
+ */
+
+#define ADMISSION_POSITION_INTERVAL_MS 5000  // Well below the Java client's read timeout
+#define DEFAULT_ADMISSION_QUEUE 32           // Connections that may wait for a slot
+
+/**
+ * Allocate the queue
+ * @param capacity Connections that may wait (0 = none, full server closes them)
+ * @return 0 on success, -1 on error
+ */
+int admission_init(int capacity);
+
+/**
+ * Tell waiting connections the server is going down, close and free them
+ */
+void admission_shutdown(void);
+
+/**
+ * Number of connections waiting for a slot
+ */
+int admission_waiting(void);
+
+/**
+ * Park a connection that got no client slot (sends its QUEUE_POSITION)
+ * @param client Client set up for the connection, not in the client list
+ * @return 0 if queued, -1 if the queue is full (caller closes the connection)
+ */
+int admission_enqueue(client_t *client);
+
+/**
+ * Note that a client slot was freed; starts the oldest waiting connection soon
+ */
+void admission_slot_freed(void);
+
+#endif /* ADMISSION_H */
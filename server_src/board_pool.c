@@ -0,0 +1,146 @@
+#define LOG_MODULE LOG_MODULE_GAME
+
+#include "board_pool.h"
+#include "logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define BOARD_POOL_SIZES 3  // Board sizes rooms accept: 4, 6, 8
+
+typedef struct {
+    uint8_t boards[BOARD_POOL_DEPTH][BOARD_MAX_CARDS];
+    int head;   // Oldest ready board
+    int count;  // Ready boards
+} board_ring_t;
+
+static board_ring_t rings[BOARD_POOL_SIZES];
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_wakeup = PTHREAD_COND_INITIALIZER;
+static int running = 0;
+static pthread_t producer_thread;
+
+// Ring for a board size, or -1 if the size isn't pooled
+static int ring_index(int board_size) {
+    if (board_size < MIN_BOARD_SIZE || board_size > MAX_BOARD_SIZE || board_size % 2 != 0) {
+        return -1;
+    }
+    int index = (board_size - MIN_BOARD_SIZE) / 2;
+    return index < BOARD_POOL_SIZES ? index : -1;
+}
+
+void board_shuffle(uint8_t *values, int total_cards, unsigned int *seed) {
+    for (int i = 0; i < total_cards / 2; i++) {
+        values[i * 2] = (uint8_t)(i + 1);
+        values[i * 2 + 1] = (uint8_t)(i + 1);
+    }
+
+    for (int i = total_cards - 1; i > 0; i--) {
+        int j = rand_r(seed) % (i + 1);
+        uint8_t temp = values[i];
+        values[i] = values[j];
+        values[j] = temp;
+    }
+}
+
+// Ring with the fewest ready boards that isn't full, or -1 (pool_mutex held)
+static int neediest_ring(void) {
+    int best = -1;
+    for (int i = 0; i < BOARD_POOL_SIZES; i++) {
+        if (rings[i].count < BOARD_POOL_DEPTH && (best < 0 || rings[i].count < rings[best].count)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void* board_producer_func(void *arg) {
+    unsigned int *seed = (unsigned int *)arg;
+
+    pthread_mutex_lock(&pool_mutex);
+    while (running) {
+        int index = neediest_ring();
+        if (index < 0) {
+            pthread_cond_wait(&pool_wakeup, &pool_mutex);
+            continue;
+        }
+
+        // Shuffle without the lock, the producer is the only writer of ring tails
+        pthread_mutex_unlock(&pool_mutex);
+        int board_size = MIN_BOARD_SIZE + index * 2;
+        uint8_t board[BOARD_MAX_CARDS];
+        board_shuffle(board, board_size * board_size, seed);
+        pthread_mutex_lock(&pool_mutex);
+
+        board_ring_t *ring = &rings[index];
+        int tail = (ring->head + ring->count) % BOARD_POOL_DEPTH;
+        memcpy(ring->boards[tail], board, board_size * board_size);
+        ring->count++;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+
+    return NULL;
+}
+
+int board_pool_init(void) {
+    static unsigned int producer_seed;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    producer_seed = (unsigned int)(ts.tv_nsec ^ ts.tv_sec);
+
+    pthread_mutex_lock(&pool_mutex);
+    memset(rings, 0, sizeof(rings));
+    running = 1;
+    pthread_mutex_unlock(&pool_mutex);
+
+    // The producer fills all pools before its first wait
+    int result = pthread_create(&producer_thread, NULL, board_producer_func, &producer_seed);
+    if (result != 0) {
+        pthread_mutex_lock(&pool_mutex);
+        running = 0;
+        pthread_mutex_unlock(&pool_mutex);
+        logger_log(LOG_ERROR, "Failed to create board producer thread: %d", result);
+        return -1;
+    }
+
+    logger_log(LOG_INFO, "Board pool started (%d boards per size)", BOARD_POOL_DEPTH);
+    return 0;
+}
+
+void board_pool_shutdown(void) {
+    pthread_mutex_lock(&pool_mutex);
+    int was_running = running;
+    running = 0;
+    pthread_cond_signal(&pool_wakeup);
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (was_running) {
+        pthread_join(producer_thread, NULL);
+        logger_log(LOG_INFO, "Board pool stopped");
+    }
+}
+
+int board_pool_take(int board_size, uint8_t *values) {
+    int index = ring_index(board_size);
+    if (index < 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    board_ring_t *ring = &rings[index];
+    if (!running || ring->count == 0) {
+        pthread_mutex_unlock(&pool_mutex);
+        return -1;
+    }
+
+    memcpy(values, ring->boards[ring->head], board_size * board_size);
+    ring->head = (ring->head + 1) % BOARD_POOL_DEPTH;
+    ring->count--;
+    if (ring->count < BOARD_POOL_LOW_WATER) {
+        pthread_cond_signal(&pool_wakeup);
+    }
+    pthread_mutex_unlock(&pool_mutex);
+
+    return 0;
+}
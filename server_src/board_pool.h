@@ -0,0 +1,49 @@
+#ifndef BOARD_POOL_H
+#define BOARD_POOL_H
+
+#include "game.h"
+#include <stdint.h>
+
+/**
+ * Board pool module - shuffled boards prepared ahead of game creation
+ *
+ * A producer thread keeps a ring of ready boards for each board size a room
+ * can use (4x4, 6x6, 8x8), one card value per byte. game_create() takes a board
+ * in O(1) instead of filling and shuffling on the thread handling START_GAME.
+ * Taking a board from a pool that dropped below BOARD_POOL_LOW_WATER wakes the
+ * producer, which refills every pool to BOARD_POOL_DEPTH and sleeps again, so a
+ * burst of game starts is served from the pool while it is refilled.
+ */
+
+#define BOARD_POOL_DEPTH 64         // Boards kept ready per size
+#define BOARD_POOL_LOW_WATER 32     // Refill when a pool drops below this
+#define BOARD_MAX_CARDS (MAX_BOARD_SIZE * MAX_BOARD_SIZE)
+
+/**
+ * Fill the pools and start the producer thread
+ * @return 0 on success, -1 on error (game_create() shuffles inline)
+ */
+int board_pool_init(void);
+
+/**
+ * Stop the producer thread
+ */
+void board_pool_shutdown(void);
+
+/**
+ * Take a shuffled board
+ * @param board_size Board size (cards = board_size * board_size)
+ * @param values Output, one card value per card
+ * @return 0 on success, -1 if the pool is empty, stopped or has no such size
+ */
+int board_pool_take(int board_size, uint8_t *values);
+
+/**
+ * Fill a board with pairs (1,1,2,2,...) and shuffle it (Fisher-Yates)
+ * @param values Output, one card value per card
+ * @param total_cards Number of cards
+ * @param seed rand_r() state
+ */
+void board_shuffle(uint8_t *values, int total_cards, unsigned int *seed);
+
+#endif /* BOARD_POOL_H */
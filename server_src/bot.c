@@ -0,0 +1,595 @@
+#define LOG_MODULE LOG_MODULE_ROOM
+
+#include "bot.h"
+#include "room.h"
+#include "game.h"
+#include "timer.h"
+#include "worker_pool.h"
+#include "clock.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define BOT_MAX_CARDS (MAX_BOARD_SIZE * MAX_BOARD_SIZE)
+#define BOT_REAP_GRACE_MS 1000       // Without room workers the game's thread may still touch a finished bot
+#define BOT_BENCH_ROOM_NAME "bench"
+#define BOT_BENCH_START_RETRIES 1000 // 1 ms apart, while finished rooms free their slots
+
+typedef struct bot_s {
+    client_t client;             // What rooms and games see
+    int skill;
+    int think_ms;
+    unsigned int seed;           // rand_r() state
+    int known[BOT_MAX_CARDS];    // Remembered card values (0 = unknown)
+    atomic_int room_id;          // Room of the last event (selects the worker)
+    atomic_int step_pending;     // 1 while a step is scheduled
+    atomic_int retired;          // 1 once its game or room is over
+    int bench;                   // Benchmark bot (plays on without people)
+    int bench_owner;             // Counts the finished game of its room
+    struct bot_s *prev;
+    struct bot_s *next;
+} bot_t;
+
+typedef enum {
+    BOT_TASK_STEP,               // Act on the current room and game state
+    BOT_TASK_REAP                // Free a retired bot
+} bot_task_kind_t;
+
+typedef struct {
+    worker_task_t task;
+    int room_id;
+    int bot_id;
+    bot_task_kind_t kind;
+} bot_task_t;
+
+static pthread_mutex_t bots_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bot_t *bots = NULL;
+static int bot_count = 0;
+static atomic_int next_bot_number = 1;
+
+static pthread_mutex_t bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bench_finished_cond = PTHREAD_COND_INITIALIZER;
+static int bench_finished = 0;
+static atomic_ullong bench_flips = 0;
+
+static void bot_step(bot_t *bot, room_t *room);
+static void bot_reap(int bot_id);
+
+// Find a bot by client ID (bots_mutex held)
+static bot_t* find_bot_locked(int bot_id) {
+    for (bot_t *bot = bots; bot != NULL; bot = bot->next) {
+        if (bot->client.client_id == bot_id) {
+            return bot;
+        }
+    }
+    return NULL;
+}
+
+// Unlink a bot from the registry (bots_mutex held)
+static void unlink_bot_locked(bot_t *bot) {
+    if (bot->prev != NULL) {
+        bot->prev->next = bot->next;
+    } else {
+        bots = bot->next;
+    }
+    if (bot->next != NULL) {
+        bot->next->prev = bot->prev;
+    }
+    bot_count--;
+}
+
+static void run_bot_task(worker_task_t *task) {
+    bot_task_t *bot_task = (bot_task_t *)task;
+    int room_id = bot_task->room_id;
+    int bot_id = bot_task->bot_id;
+    bot_task_kind_t kind = bot_task->kind;
+    free(bot_task);
+
+    if (kind == BOT_TASK_REAP) {
+        bot_reap(bot_id);
+        return;
+    }
+
+    // A bot seated in the room is alive; otherwise it left and the step is stale
+    room_t *room = room_get_by_id(room_id);
+    if (room == NULL) {
+        return;
+    }
+    for (int i = 0; i < MAX_PLAYERS_PER_ROOM; i++) {
+        client_t *player = room->players[i];
+        if (player != NULL && player->bot != NULL && player->client_id == bot_id) {
+            atomic_store(&player->bot->step_pending, 0);
+            bot_step(player->bot, room);
+            return;
+        }
+    }
+}
+
+static bot_task_t* new_bot_task(int room_id, int bot_id, bot_task_kind_t kind) {
+    bot_task_t *bot_task = (bot_task_t *)malloc(sizeof(bot_task_t));
+    if (bot_task == NULL) {
+        logger_log(LOG_ERROR, "Bot %d: Failed to allocate task", bot_id);
+        return NULL;
+    }
+    bot_task->task.run = run_bot_task;
+    bot_task->room_id = room_id;
+    bot_task->bot_id = bot_id;
+    bot_task->kind = kind;
+    return bot_task;
+}
+
+// Timer thread: hand the due task to the room's worker, or run it here (serialised
+// with other inline room work) without workers
+static void bot_timer_fired(int bot_id, bot_task_kind_t kind) {
+    pthread_mutex_lock(&bots_mutex);
+    bot_t *bot = find_bot_locked(bot_id);
+    int room_id = (bot != NULL) ? atomic_load(&bot->room_id) : 0;
+    pthread_mutex_unlock(&bots_mutex);
+    if (bot == NULL) {
+        return;
+    }
+
+    bot_task_t *bot_task = new_bot_task(room_id, bot_id, kind);
+    if (bot_task == NULL) {
+        return;
+    }
+    if (worker_pool_submit(room_id, &bot_task->task) != 0) {
+        worker_pool_run_inline(&bot_task->task);
+    }
+}
+
+static void step_timer_fired(int bot_id, unsigned int id) {
+    (void)id;
+    bot_timer_fired(bot_id, BOT_TASK_STEP);
+}
+
+static void reap_timer_fired(int bot_id, unsigned int id) {
+    (void)id;
+    bot_timer_fired(bot_id, BOT_TASK_REAP);
+}
+
+// Queue a task for later, never running it inline: the caller may hold the room lock
+static int bot_defer(bot_t *bot, int delay_ms, bot_task_kind_t kind) {
+    int bot_id = bot->client.client_id;
+
+    if (delay_ms == 0 && worker_pool_enabled()) {
+        bot_task_t *bot_task = new_bot_task(atomic_load(&bot->room_id), bot_id, kind);
+        if (bot_task == NULL) {
+            return -1;
+        }
+        if (worker_pool_submit(bot_task->room_id, &bot_task->task) == 0) {
+            return 0;
+        }
+        free(bot_task);
+    }
+
+    timer_callback_t callback = (kind == BOT_TASK_STEP) ? step_timer_fired : reap_timer_fired;
+    return (timer_schedule(delay_ms, callback, bot_id) != 0) ? 0 : -1;
+}
+
+// Several events before the bot gets to act end up in a single step
+static void bot_schedule_step(bot_t *bot) {
+    if (atomic_exchange(&bot->step_pending, 1) != 0) {
+        return;
+    }
+    if (bot_defer(bot, bot->think_ms, BOT_TASK_STEP) != 0) {
+        atomic_store(&bot->step_pending, 0);
+    }
+}
+
+static void bot_retire(bot_t *bot) {
+    if (atomic_exchange(&bot->retired, 1) != 0) {
+        return;
+    }
+
+    // On the room's worker the reap runs after the task that ended the game (benchmark
+    // games run entirely on the timer thread without workers); if it can't be queued,
+    // bot_shutdown() frees the bot
+    bot_defer(bot, (worker_pool_enabled() || bot->bench) ? 0 : BOT_REAP_GRACE_MS, BOT_TASK_REAP);
+}
+
+static void bot_reap(int bot_id) {
+    pthread_mutex_lock(&bots_mutex);
+    bot_t *bot = find_bot_locked(bot_id);
+    if (bot == NULL || !atomic_load(&bot->retired)) {
+        pthread_mutex_unlock(&bots_mutex);
+        return;
+    }
+    if (bot->client.room != NULL) {
+        // Retired by an event sent before the room let go of the bot - look again later
+        pthread_mutex_unlock(&bots_mutex);
+        if (timer_schedule(BOT_REAP_GRACE_MS, reap_timer_fired, bot_id) == 0) {
+            logger_log(LOG_WARNING, "Bot %d: Cannot re-arm reap, bot_shutdown() frees it", bot_id);
+        }
+        return;
+    }
+    unlink_bot_locked(bot);
+    pthread_mutex_unlock(&bots_mutex);
+
+    // The room is gone by now, so the next benchmark game can take its slot
+    if (bot->bench_owner) {
+        pthread_mutex_lock(&bench_mutex);
+        bench_finished++;
+        pthread_cond_signal(&bench_finished_cond);
+        pthread_mutex_unlock(&bench_mutex);
+    }
+
+    logger_log(LOG_DEBUG, "Bot %s freed", bot->client.nickname);
+    free(bot);
+}
+
+client_t* bot_create(int skill, int think_ms) {
+    bot_t *bot = (bot_t *)calloc(1, sizeof(bot_t));
+    if (bot == NULL) {
+        logger_log(LOG_ERROR, "Failed to allocate bot");
+        return NULL;
+    }
+
+    int number = atomic_fetch_add(&next_bot_number, 1);
+    client_t *client = &bot->client;
+
+    // Negative IDs never collide with connections
+    client->socket_fd = -1;
+    client->state = STATE_IN_LOBBY;
+    client->last_activity_ms = clock_now_ms();
+    client->client_id = -number;
+    atomic_init(&client->refs, 1);
+    client->list_slot = -1;
+    client->room = NULL;
+    atomic_init(&client->room_mailbox, 0);
+    client->room_slot = -1;
+    client->game_slot = -1;
+    atomic_init(&client->match_bucket, -1);
+    client->spectating = NULL;
+    client->last_pong_ms = client->last_activity_ms;
+    client->srtt_ms = -1;
+    coro_wait_init(&client->pending_commands);
+    atomic_init(&client->bytes_in, 0);
+    atomic_init(&client->bytes_out, 0);
+    pthread_mutex_init(&client->send_lock, NULL);
+    snprintf(client->nickname, sizeof(client->nickname), "%s%d", BOT_NICK_PREFIX, number);
+    client->bot = bot;
+
+    bot->skill = skill;
+    bot->think_ms = think_ms;
+    bot->seed = (unsigned int)client->last_activity_ms ^ ((unsigned int)number * 2654435761u);
+    atomic_init(&bot->room_id, 0);
+    atomic_init(&bot->step_pending, 0);
+    atomic_init(&bot->retired, 0);
+
+    pthread_mutex_lock(&bots_mutex);
+    bot->next = bots;
+    if (bots != NULL) {
+        bots->prev = bot;
+    }
+    bots = bot;
+    bot_count++;
+    pthread_mutex_unlock(&bots_mutex);
+
+    logger_log(LOG_DEBUG, "Bot %s created (skill %d%%, think %d ms)", client->nickname, skill, think_ms);
+    return client;
+}
+
+void bot_destroy(client_t *client) {
+    if (client == NULL || client->bot == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&bots_mutex);
+    unlink_bot_locked(client->bot);
+    pthread_mutex_unlock(&bots_mutex);
+
+    free(client->bot);
+}
+
+int bot_is_bot(const client_t *client) {
+    return client != NULL && client->bot != NULL;
+}
+
+// Match a command word at the start of a message
+static int is_command(const char *message, const char *command) {
+    size_t len = strlen(command);
+    return strncmp(message, command, len) == 0 && (message[len] == '\0' || message[len] == ' ');
+}
+
+int bot_deliver(client_t *client, const char *message) {
+    bot_t *bot = client->bot;
+    int len = (int)strlen(message);
+
+    // Room events come in the SEQ <seq> envelope
+    const char *event = message;
+    if (is_command(event, CMD_SEQ)) {
+        event = strchr(event + strlen(CMD_SEQ) + 1, ' ');
+        if (event == NULL) {
+            return len;
+        }
+        event++;
+    }
+
+    if (client->room != NULL) {
+        atomic_store(&bot->room_id, client->room->room_id);
+    }
+
+    if (is_command(event, CMD_CARD_REVEAL)) {
+        int index;
+        int value;
+        char nickname[MAX_NICK_LENGTH];
+        if (sscanf(event + strlen(CMD_CARD_REVEAL), "%d %d %31s", &index, &value, nickname) != 3 ||
+            index < 0 || index >= BOT_MAX_CARDS) {
+            return len;
+        }
+        if ((int)(rand_r(&bot->seed) % 100) < bot->skill) {
+            bot->known[index] = value;
+        }
+        if (strcmp(nickname, client->nickname) == 0) {
+            bot_schedule_step(bot);  // Second card of the turn
+        }
+    } else if (is_command(event, CMD_GAME_START)) {
+        memset(bot->known, 0, sizeof(bot->known));
+    } else if (is_command(event, CMD_YOUR_TURN) || is_command(event, CMD_GAME_CREATED) ||
+               is_command(event, CMD_PLAYER_LEFT) || is_command(event, CMD_PLAYER_DISCONNECTED) ||
+               is_command(event, CMD_ROOM_OWNER_CHANGED)) {
+        bot_schedule_step(bot);
+    } else if (is_command(event, CMD_GAME_END) || is_command(event, CMD_GAME_END_FORFEIT) ||
+               is_command(event, "ROOM_CLOSED") || is_command(event, CMD_LEFT_ROOM)) {
+        bot_retire(bot);
+    }
+
+    return len;
+}
+
+// Bots only keep people company; a disconnected player may still come back
+static int room_has_people(room_t *room) {
+    for (int i = 0; i < MAX_PLAYERS_PER_ROOM; i++) {
+        if (room->players[i] != NULL && room->players[i]->bot == NULL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Pick the next card from what the bot remembers (card states are public, values are not)
+static int bot_choose_card(bot_t *bot, game_t *game) {
+    int total = game->total_cards < BOT_MAX_CARDS ? game->total_cards : BOT_MAX_CARDS;
+
+    if (game->flips_this_turn == 1) {
+        int first = game->first_card_index;
+        int value = game->cards[first].value;  // Face up for everyone
+        for (int i = 0; i < total; i++) {
+            if (i != first && game->cards[i].state == CARD_HIDDEN && bot->known[i] == value) {
+                return i;
+            }
+        }
+    } else {
+        for (int i = 0; i < total; i++) {
+            if (game->cards[i].state != CARD_HIDDEN || bot->known[i] == 0) {
+                continue;
+            }
+            for (int j = i + 1; j < total; j++) {
+                if (game->cards[j].state == CARD_HIDDEN && bot->known[j] == bot->known[i]) {
+                    return i;
+                }
+            }
+        }
+    }
+
+    // Guess: a card it hasn't seen, or any face-down card
+    int candidates[BOT_MAX_CARDS];
+    int count = 0;
+    for (int i = 0; i < total; i++) {
+        if (game->cards[i].state == CARD_HIDDEN && bot->known[i] == 0) {
+            candidates[count++] = i;
+        }
+    }
+    if (count == 0) {
+        for (int i = 0; i < total; i++) {
+            if (game->cards[i].state == CARD_HIDDEN) {
+                candidates[count++] = i;
+            }
+        }
+    }
+    if (count == 0) {
+        return -1;
+    }
+    return candidates[rand_r(&bot->seed) % count];
+}
+
+// Act on the room like a player would (room's worker); the room may be gone afterwards
+static void bot_step(bot_t *bot, room_t *room) {
+    client_t *client = &bot->client;
+    game_t *game = (game_t *)room->game;
+
+    if (!bot->bench && !room_has_people(room)) {
+        logger_log(LOG_INFO, "Room %d: Only bots left, closing", room->room_id);
+        room_close(room, "No players left");
+        return;
+    }
+
+    if (game == NULL) {
+        // A bot that inherited the room starts the game once it is full
+        if (room->owner == client && room->player_count == room->max_players) {
+            client_execute_command(client, CMD_START_GAME);
+        }
+        return;
+    }
+
+    int seat = -1;
+    for (int i = 0; i < game->player_count; i++) {
+        if (game->players[i] == client) {
+            seat = i;
+            break;
+        }
+    }
+    if (seat < 0) {
+        return;
+    }
+
+    if (game->state == GAME_STATE_WAITING) {
+        if (!game->player_ready[seat]) {
+            client_execute_command(client, CMD_READY);
+        }
+        return;
+    }
+
+    if (game->state != GAME_STATE_PLAYING || game_get_current_player(game) != client) {
+        return;
+    }
+
+    int card = bot_choose_card(bot, game);
+    if (card < 0) {
+        return;
+    }
+
+    char command[32];
+    snprintf(command, sizeof(command), "%s %d", CMD_FLIP, card);
+    if (bot->bench) {
+        atomic_fetch_add_explicit(&bench_flips, 1, memory_order_relaxed);
+    }
+    client_execute_command(client, command);
+}
+
+typedef struct {
+    client_t **players;
+    int room_id;
+    int result;
+} bench_setup_t;
+
+// Create the game and start it (room's worker)
+static void bench_setup_game(void *arg) {
+    bench_setup_t *setup = (bench_setup_t *)arg;
+    client_t **players = setup->players;
+
+    room_t *room = room_get_by_id(setup->room_id);
+    if (room == NULL) {
+        return;
+    }
+    room_seat_players(room);
+
+    game_t *game = game_create(BOT_BENCH_BOARD_SIZE, room->players, BOT_BENCH_PLAYERS);
+    if (game == NULL) {
+        logger_log(LOG_ERROR, "Benchmark: Failed to create game for room %d", room->room_id);
+        room_close(room, "Benchmark failed");
+        return;
+    }
+    room->game = game;
+
+    for (int i = 0; i < BOT_BENCH_PLAYERS; i++) {
+        game_player_ready(game, players[i]);
+        players[i]->state = STATE_IN_GAME;
+    }
+    game_start(game);
+    room->state = ROOM_STATE_PLAYING;
+    players[0]->bot->bench_owner = 1;  // Only games that ran count as finished
+
+    char message[MAX_MESSAGE_LENGTH];
+    game_format_start_message(game, message, sizeof(message));
+    room_broadcast(room, message);
+
+    // The bots' steps are queued behind this task, so the game can't end before
+    // room_start_turn() armed the turn
+    room_start_turn(room);
+    setup->result = 0;
+}
+
+// Start one bot-only game, set up like a quick match
+static int bench_start_game(void) {
+    client_t *players[BOT_BENCH_PLAYERS];
+    for (int i = 0; i < BOT_BENCH_PLAYERS; i++) {
+        players[i] = bot_create(BOT_DEFAULT_SKILL, 0);
+        if (players[i] == NULL) {
+            for (int j = 0; j < i; j++) {
+                bot_destroy(players[j]);
+            }
+            return -1;
+        }
+        players[i]->bot->bench = 1;
+    }
+
+    room_t *room = room_create_full(BOT_BENCH_ROOM_NAME, BOT_BENCH_BOARD_SIZE, 0, players, BOT_BENCH_PLAYERS);
+    if (room == NULL) {
+        for (int i = 0; i < BOT_BENCH_PLAYERS; i++) {
+            bot_destroy(players[i]);
+        }
+        return -1;
+    }
+
+    bench_setup_t setup;
+    setup.players = players;
+    setup.room_id = room->room_id;
+    setup.result = -1;
+    worker_pool_run_sync(setup.room_id, bench_setup_game, &setup);
+    return setup.result;
+}
+
+int bot_benchmark(int games, int rooms) {
+    if (games <= 0 || rooms <= 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&bench_mutex);
+    bench_finished = 0;
+    pthread_mutex_unlock(&bench_mutex);
+    atomic_store(&bench_flips, 0);
+
+    logger_log(LOG_INFO, "Benchmark: %d bot games, up to %d at a time (board %dx%d, %d players)",
+               games, rooms, BOT_BENCH_BOARD_SIZE, BOT_BENCH_BOARD_SIZE, BOT_BENCH_PLAYERS);
+
+    int64_t start_ms = clock_now_ms();
+    int started = 0;
+    int failures = 0;
+
+    pthread_mutex_lock(&bench_mutex);
+    while (bench_finished < games) {
+        if (started < games && started - bench_finished < rooms) {
+            pthread_mutex_unlock(&bench_mutex);
+            int result = bench_start_game();
+            if (result != 0) {
+                // Every room slot is taken (by people): wait for one to free up
+                if (++failures > BOT_BENCH_START_RETRIES) {
+                    logger_log(LOG_ERROR, "Benchmark: Cannot start games (room limit?), stopping after %d", started);
+                    return -1;
+                }
+                usleep(1000);
+            } else {
+                started++;
+                failures = 0;
+            }
+            pthread_mutex_lock(&bench_mutex);
+            continue;
+        }
+        pthread_cond_wait(&bench_finished_cond, &bench_mutex);
+    }
+    pthread_mutex_unlock(&bench_mutex);
+
+    int64_t elapsed_ms = clock_now_ms() - start_ms;
+    if (elapsed_ms < 1) {
+        elapsed_ms = 1;
+    }
+    double seconds = elapsed_ms / 1000.0;
+    unsigned long long flips = atomic_load(&bench_flips);
+
+    printf("Benchmark: %d games, %llu flips in %.3f s (%.0f games/s, %.0f flips/s)\n",
+           games, flips, seconds, games / seconds, flips / seconds);
+    logger_log(LOG_INFO, "Benchmark: %d games, %llu flips in %.3f s (%.0f games/s, %.0f flips/s)",
+               games, flips, seconds, games / seconds, flips / seconds);
+    return 0;
+}
+
+void bot_shutdown(void) {
+    pthread_mutex_lock(&bots_mutex);
+    int freed = bot_count;
+    while (bots != NULL) {
+        bot_t *bot = bots;
+        bots = bot->next;
+        free(bot);
+    }
+    bot_count = 0;
+    pthread_mutex_unlock(&bots_mutex);
+
+    if (freed > 0) {
+        logger_log(LOG_INFO, "Freed %d bot(s)", freed);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "client_handler.h"
+
+/**
+ * Bot module - server-side players without a socket
+ *
+ * A bot is a client_t whose messages go to bot_deliver() instead of a socket.
+ * It remembers revealed cards (each one with probability skill %), and after
+ * its think time it acts on the room's worker through the same command
+ * handlers as a remote player (READY, FLIP, LEAVE_ROOM). Bots added with
+ * ADD_BOT leave when no person is left in the room; every bot is freed once
+ * its game is over.
+ *
+ * The self-benchmark runs bot-only games with no think time inside the
+ * process, measuring game logic, room locking and the worker pool without
+ * any socket I/O.
+ */
+
+#define BOT_NICK_PREFIX "bot~"      // Nicknames of bots (refused in HELLO)
+#define BOT_DEFAULT_SKILL 50        // Chance (%) to remember a revealed card
+#define BOT_DEFAULT_THINK_MS 800    // Delay before each action
+#define BOT_MAX_THINK_MS 10000
+#define BOT_BENCH_PLAYERS 2         // Players per benchmark game
+#define BOT_BENCH_BOARD_SIZE 6      // Board of benchmark games
+
+/**
+ * Create a bot in the lobby
+ * @param skill Chance (0-100) to remember a revealed card
+ * @param think_ms Delay before each action
+ * @return Bot client or NULL on error
+ */
+client_t* bot_create(int skill, int think_ms);
+
+/**
+ * Free a bot that never joined a room
+ * @param client Bot client
+ */
+void bot_destroy(client_t *client);
+
+/**
+ * Check if a client is a bot
+ * @param client Client
+ * @return 1 for bots, 0 otherwise
+ */
+int bot_is_bot(const client_t *client);
+
+/**
+ * Hand a message to a bot (client_send_message() for bots; may be called with
+ * the room lock held, so it only records the event and schedules the reaction)
+ * @param client Bot client
+ * @param message Message as it would be sent
+ * @return Message length
+ */
+int bot_deliver(client_t *client, const char *message);
+
+/**
+ * Play bot-only games and print throughput
+ * @param games Number of games to play
+ * @param rooms Games running at the same time
+ * @return 0 on success, -1 on error
+ */
+int bot_benchmark(int games, int rooms);
+
+/**
+ * Free all bots (after room workers and timers are stopped)
+ */
+void bot_shutdown(void);
+
+#endif /* BOT_H */
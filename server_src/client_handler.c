@@ -1,13 +1,29 @@
+#define LOG_MODULE LOG_MODULE_CLIENT
+
 #include "client_handler.h"
 #include "client_list.h"
 #include "room.h"
+#include "matchmaker.h"
+#include "spectator.h"
 #include "game.h"
 #include "logger.h"
 #include "server.h"
+#include "codec.h"
+#include "worker_pool.h"
+#include "uring.h"
+#include "coro.h"
+#include "config.h"
+#include "eventlog.h"
+#include "clock.h"
+#include "bot.h"
+#include "ratelimit.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <unistd.h>
+#include <errno.h>
 #include <sys/socket.h>
 
 // Forward declarations of command handlers
@@ -15,12 +31,25 @@ static void handle_hello(client_t *client, const char *params);
 static void handle_list_rooms(client_t *client);
 static void handle_create_room(client_t *client, const char *params);
 static void handle_join_room(client_t *client, const char *params);
+static void join_room(client_t *client, int room_id, void *arg);
+static void spectate_room(client_t *client, int room_id, void *arg);
 static void handle_leave_room(client_t *client);
 static void handle_ready(client_t *client);
 static void handle_start_game(client_t *client);
 static void handle_flip(client_t *client, const char *params);
-static void handle_pong(client_t *client);
+static void handle_pong(client_t *client, const char *params);
 static void handle_reconnect(client_t *client, const char *params);
+static void handle_quick_match(client_t *client, const char *params);
+static void handle_spectate(client_t *client, const char *params);
+static void handle_add_bot(client_t *client, const char *params);
+static void handle_leaderboard(client_t *client);
+static game_t* flip_game(client_t *client);
+static void flip_card(client_t *client, game_t *game, int card_index);
+static void pong_received(client_t *client, int has_echo, unsigned int echoed);
+
+// Request being handled on this thread - replies to its client echo the request ID
+static __thread client_t *request_client = NULL;
+static __thread unsigned int request_id = 0;
 
 // Helper function to send error and increment error counter
 static void send_error_and_count(client_t *client, const char *error_code, const char *details) {
@@ -40,36 +69,83 @@ static void send_error_and_count(client_t *client, const char *error_code, const
               client->nickname[0] ? client->nickname : "unauthenticated",
               error_code,
               client->invalid_message_count,
-              MAX_ERROR_COUNT);
+              config_get()->max_error_count);
 
-    // Disconnect after MAX_ERROR_COUNT errors
-    if (client->invalid_message_count >= MAX_ERROR_COUNT) {
+    // Disconnect after max_error_count errors
+    if (client->invalid_message_count >= config_get()->max_error_count) {
         logger_log(LOG_ERROR, "Client %d: Max error count reached, closing connection",
                   client->client_id);
         close(client->socket_fd);
     }
 }
 
+int client_encode_message(client_t *client, const char *message, unsigned char *out, size_t size) {
+    // Echo request ID on replies to a pipelined request: #<id> <message>
+    char tagged[MAX_MESSAGE_LENGTH];
+    if (client == request_client && request_id != 0) {
+        snprintf(tagged, sizeof(tagged), "%s%u %s", REQUEST_ID_PREFIX, request_id, message);
+        message = tagged;
+    }
+
+    if (client->binary_mode) {
+        // Binary connections get the same tokens as a compact frame
+        int frame_len = codec_encode_frame(message, out, size);
+        if (frame_len < 0) {
+            logger_log(LOG_ERROR, "Client %d: Cannot encode binary frame for '%s'", client->client_id, message);
+        }
+        return frame_len;
+    }
+
+    int len = snprintf((char *)out, size, "%s\n", message);
+    if (len < 0 || len >= (int)size || len > MAX_MESSAGE_LENGTH + 1) {
+        logger_log(LOG_ERROR, "Client %d: Message too long or formatting error", client->client_id);
+        return -1;
+    }
+    return len;
+}
+
+// Write a whole encoded message (send_lock held); a short write would break the framing
+static int send_all(client_t *client, const unsigned char *data, int len) {
+    int total = 0;
+    while (total < len) {
+        ssize_t sent = send(client->socket_fd, data + total, len - total, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        total += (int)sent;
+        atomic_fetch_add_explicit(&client->bytes_out, sent, memory_order_relaxed);
+    }
+    return total;
+}
+
 int client_send_message(client_t *client, const char *message) {
     if (client == NULL || message == NULL) {
         return -1;
     }
 
+    // Bots take the message text directly
+    if (client->bot != NULL) {
+        return bot_deliver(client, message);
+    }
+
     // Don't send to disconnected clients
     if (client->is_disconnected || client->socket_fd < 0) {
-        logger_log(LOG_WARNING, "Client %d: Cannot send message - client is disconnected", client->client_id);
+        logger_log_ratelimited(LOG_WARNING, 5, "Client %d: Cannot send message - client is disconnected", client->client_id);
         return -1;
     }
 
-    char buffer[MAX_MESSAGE_LENGTH + 2];
-    int len = snprintf(buffer, sizeof(buffer), "%s\n", message);
-
-    if (len < 0 || len >= (int)sizeof(buffer)) {
-        logger_log(LOG_ERROR, "Client %d: Message too long or formatting error", client->client_id);
+    unsigned char buffer[CLIENT_WIRE_BUFFER_SIZE];
+    int len = client_encode_message(client, message, buffer, sizeof(buffer));
+    if (len < 0) {
         return -1;
     }
 
-    int sent = send(client->socket_fd, buffer, len, 0);
+    pthread_mutex_lock(&client->send_lock);
+    int sent = send_all(client, buffer, len);
+    pthread_mutex_unlock(&client->send_lock);
     if (sent < 0) {
         logger_log(LOG_ERROR, "Client %d: Failed to send message", client->client_id);
         return -1;
@@ -78,8 +154,130 @@ int client_send_message(client_t *client, const char *message) {
     return sent;
 }
 
-// Parse and dispatch message to appropriate handler
-static void handle_message(client_t *client, const char *message) {
+int client_send_nowait(client_t *client, const void *data, int len, int wait_for_lock) {
+    if (wait_for_lock) {
+        pthread_mutex_lock(&client->send_lock);
+    } else if (pthread_mutex_trylock(&client->send_lock) != 0) {
+        return 0;
+    }
+
+    int fd = client->socket_fd;
+    ssize_t sent = fd >= 0 ? send(fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL) : -1;
+    pthread_mutex_unlock(&client->send_lock);
+
+    if (sent > 0) {
+        atomic_fetch_add_explicit(&client->bytes_out, sent, memory_order_relaxed);
+    }
+    return sent == len ? 1 : -1;
+}
+
+int client_send_batch(client_t **clients, const char **messages, int count) {
+    if (count <= 0) {
+        return 0;
+    }
+
+    // Without io_uring a batch is just a loop of single sends
+    if (!uring_enabled() || count == 1) {
+        int delivered = 0;
+        for (int i = 0; i < count; i++) {
+            if (client_send_message(clients[i], messages[i]) > 0) {
+                delivered++;
+            }
+        }
+        return delivered;
+    }
+
+    unsigned char *buffers = (unsigned char *)malloc((size_t)count * CLIENT_WIRE_BUFFER_SIZE);
+    uring_send_t *sends = (uring_send_t *)malloc((size_t)count * sizeof(uring_send_t));
+    client_t **targets = (client_t **)malloc((size_t)count * sizeof(client_t *));
+    if (buffers == NULL || sends == NULL || targets == NULL) {
+        free(buffers);
+        free(sends);
+        free(targets);
+        logger_log(LOG_ERROR, "Failed to allocate send batch");
+        return 0;
+    }
+
+    // Encode everything up front, skipping clients that can't receive. The batch holds the
+    // send lock of every target; clients another thread is writing to (or that appear
+    // again in the batch) are sent to one by one afterwards, in order.
+    int queued = 0;
+    int delivered = 0;
+    int deferred = 0;
+    int *deferred_index = (int *)malloc((size_t)count * sizeof(int));
+    if (deferred_index == NULL) {
+        free(buffers);
+        free(sends);
+        free(targets);
+        logger_log(LOG_ERROR, "Failed to allocate send batch");
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        client_t *client = clients[i];
+        if (client != NULL && client->bot != NULL && messages[i] != NULL) {
+            delivered++;
+            bot_deliver(client, messages[i]);
+            continue;
+        }
+        if (client == NULL || messages[i] == NULL || client->is_disconnected || client->socket_fd < 0) {
+            continue;
+        }
+
+        if (pthread_mutex_trylock(&client->send_lock) != 0) {
+            deferred_index[deferred++] = i;
+            continue;
+        }
+
+        unsigned char *buffer = buffers + (size_t)queued * CLIENT_WIRE_BUFFER_SIZE;
+        int len = client_encode_message(client, messages[i], buffer, CLIENT_WIRE_BUFFER_SIZE);
+        if (len < 0) {
+            pthread_mutex_unlock(&client->send_lock);
+            continue;
+        }
+
+        targets[queued] = client;
+        sends[queued].fd = client->socket_fd;
+        sends[queued].data = buffer;
+        sends[queued].len = (size_t)len;
+        sends[queued].result = 0;
+        queued++;
+    }
+
+    if (uring_send_batch(sends, queued) != 0) {
+        for (int i = 0; i < queued; i++) {
+            sends[i].result = send(sends[i].fd, sends[i].data, sends[i].len, 0);
+        }
+    }
+    for (int i = 0; i < queued; i++) {
+        if (sends[i].result > 0) {
+            atomic_fetch_add_explicit(&targets[i]->bytes_out, sends[i].result, memory_order_relaxed);
+        }
+        if (sends[i].result == (int)sends[i].len) {
+            delivered++;
+        } else {
+            logger_log(LOG_ERROR, "Failed to send message on fd %d", sends[i].fd);
+            if (sends[i].result > 0) {
+                shutdown(sends[i].fd, SHUT_RDWR);  // Part of a message is in the stream
+            }
+        }
+        pthread_mutex_unlock(&targets[i]->send_lock);
+    }
+
+    for (int i = 0; i < deferred; i++) {
+        if (client_send_message(clients[deferred_index[i]], messages[deferred_index[i]]) > 0) {
+            delivered++;
+        }
+    }
+
+    free(deferred_index);
+    free(buffers);
+    free(sends);
+    free(targets);
+    return delivered;
+}
+
+// Parse and dispatch command to appropriate handler
+static void dispatch_command(client_t *client, const char *message) {
     if (message == NULL || strlen(message) == 0) {
         return;
     }
@@ -110,6 +308,14 @@ static void handle_message(client_t *client, const char *message) {
             handle_join_room(client, params);
         } else if (strcmp(command, CMD_FLIP) == 0) {
             handle_flip(client, params);
+        } else if (strcmp(command, CMD_PONG) == 0) {
+            handle_pong(client, params);
+        } else if (strcmp(command, CMD_QUICK_MATCH) == 0) {
+            handle_quick_match(client, params);
+        } else if (strcmp(command, CMD_SPECTATE) == 0) {
+            handle_spectate(client, params);
+        } else if (strcmp(command, CMD_ADD_BOT) == 0) {
+            handle_add_bot(client, params);
         } else {
             send_error_and_count(client, ERR_INVALID_COMMAND, command);
         }
@@ -126,13 +332,211 @@ static void handle_message(client_t *client, const char *message) {
         } else if (strcmp(command, CMD_START_GAME) == 0) {
             handle_start_game(client);
         } else if (strcmp(command, CMD_PONG) == 0) {
-            handle_pong(client);
+            handle_pong(client, NULL);
+        } else if (strcmp(command, CMD_QUICK_MATCH) == 0) {
+            handle_quick_match(client, NULL);
+        } else if (strcmp(command, CMD_SPECTATE) == 0) {
+            handle_spectate(client, NULL);
+        } else if (strcmp(command, CMD_ADD_BOT) == 0) {
+            handle_add_bot(client, NULL);
+        } else if (strcmp(command, CMD_LEADERBOARD) == 0) {
+            handle_leaderboard(client);
         } else {
             send_error_and_count(client, ERR_INVALID_COMMAND, command);
         }
     }
 }
 
+void client_execute_command(client_t *client, const char *message) {
+    dispatch_command(client, message);
+}
+
+// FLIP <card> and PONG [ms] run straight from a binary frame's integer fields,
+// everything else is transcoded to text
+static int is_typed_frame(const codec_frame_t *frame) {
+    if (strcmp(frame->command, CMD_FLIP) == 0) {
+        return frame->field_count == 1;
+    }
+    return strcmp(frame->command, CMD_PONG) == 0 && frame->field_count <= 1;
+}
+
+// Dispatch a frame accepted by is_typed_frame() (same replies as the text command)
+static void dispatch_frame(client_t *client, const codec_frame_t *frame) {
+    if (strcmp(frame->command, CMD_FLIP) == 0) {
+        game_t *game = flip_game(client);
+        if (game != NULL) {
+            flip_card(client, game, frame->fields[0]);
+        }
+    } else {
+        pong_received(client, frame->field_count == 1, (unsigned int)frame->fields[0]);
+    }
+}
+
+// Room-scoped command queued to a room worker
+typedef struct {
+    worker_task_t task;
+    client_t *client;
+    unsigned int request_id;
+    int typed;            // Run frame instead of message
+    codec_frame_t frame;
+    char message[MAX_MESSAGE_LENGTH];
+} room_command_t;
+
+// Commands that only touch the client's current room and its game
+static int is_room_command(const char *message) {
+    static const char *room_commands[] = { CMD_READY, CMD_START_GAME, CMD_FLIP, CMD_LEAVE_ROOM, CMD_ADD_BOT };
+
+    for (size_t i = 0; i < sizeof(room_commands) / sizeof(room_commands[0]); i++) {
+        size_t len = strlen(room_commands[i]);
+        if (strncmp(message, room_commands[i], len) == 0 &&
+            (message[len] == '\0' || message[len] == ' ')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// PONG with or without the echoed timestamp
+static int is_pong(const char *message) {
+    size_t len = strlen(CMD_PONG);
+    return strncmp(message, CMD_PONG, len) == 0 && (message[len] == '\0' || message[len] == ' ');
+}
+
+// Runs on the worker owning the room
+static void run_room_command(worker_task_t *task) {
+    room_command_t *command = (room_command_t *)task;
+    client_t *client = command->client;
+
+    request_client = client;
+    request_id = command->request_id;
+    if (command->typed) {
+        dispatch_frame(client, &command->frame);
+    } else {
+        dispatch_command(client, command->message);
+    }
+    request_client = NULL;
+    request_id = 0;
+
+    free(command);
+    coro_wait_done(&client->pending_commands);
+}
+
+static void submit_room_command(client_t *client, int room_id, const char *message,
+                                const codec_frame_t *frame, unsigned int id) {
+    room_command_t *command = (room_command_t *)malloc(sizeof(room_command_t));
+    if (command == NULL) {
+        logger_log(LOG_ERROR, "Client %d: Failed to allocate room command", client->client_id);
+        return;
+    }
+
+    command->task.run = run_room_command;
+    command->client = client;
+    command->request_id = id;
+    command->typed = (frame != NULL);
+    if (frame != NULL) {
+        command->frame = *frame;
+        command->message[0] = '\0';
+    } else {
+        strncpy(command->message, message, sizeof(command->message) - 1);
+        command->message[sizeof(command->message) - 1] = '\0';
+    }
+
+    coro_wait_add(&client->pending_commands);
+    if (worker_pool_submit(room_id, &command->task) != 0) {
+        // No workers (or they stopped meanwhile) - run here, serialised with other room work
+        worker_pool_run_inline(&command->task);
+    }
+}
+
+// Wait until all queued room commands of a client were executed
+static void wait_for_room_commands(client_t *client) {
+    coro_wait_all(&client->pending_commands);
+}
+
+// Lobby command changing a room, run on the room's worker with the request ID in scope
+typedef struct {
+    client_t *client;
+    unsigned int request_id;
+    int room_id;
+    void (*handler)(client_t *client, int room_id, void *arg);
+    void *arg;
+} room_request_t;
+
+static void run_room_request(void *arg) {
+    room_request_t *request = (room_request_t *)arg;
+    client_t *saved_client = request_client;
+    unsigned int saved_id = request_id;
+
+    request_client = request->client;
+    request_id = request->request_id;
+    request->handler(request->client, request->room_id, request->arg);
+    request_client = saved_client;
+    request_id = saved_id;
+}
+
+static void run_on_room_worker(client_t *client, int room_id,
+                               void (*handler)(client_t *client, int room_id, void *arg), void *arg) {
+    room_request_t request;
+    request.client = client;
+    request.request_id = (request_client == client) ? request_id : 0;
+    request.room_id = room_id;
+    request.handler = handler;
+    request.arg = arg;
+    worker_pool_run_sync(room_id, run_room_request, &request);
+}
+
+// Run a text command (frame NULL) or a typed frame with its request ID in scope
+static void run_command(client_t *client, unsigned int id, const char *message, const codec_frame_t *frame) {
+    // In-room commands run on the room's worker, in arrival order per room. client->room
+    // can be cleared by the worker at any time (LEAVE_ROOM, game end), so the worker is
+    // picked by the last room joined; it rechecks the room when the command runs.
+    const char *command = (frame != NULL) ? frame->command : message;
+    int room_id = atomic_load(&client->room_mailbox);
+    if (room_id != 0 && is_room_command(command) && !worker_pool_on_worker()) {
+        submit_room_command(client, room_id, message, frame, id);
+        return;
+    }
+
+    // Keep per-client order: earlier room commands must finish before e.g. JOIN_ROOM.
+    // A PONG only stamps heartbeat fields and must not wait: its RTT sample would
+    // include the time the room's worker was busy.
+    if (!is_pong(command)) {
+        wait_for_room_commands(client);
+    }
+
+    request_client = client;
+    request_id = id;
+    if (frame != NULL) {
+        dispatch_frame(client, frame);
+    } else {
+        dispatch_command(client, message);
+    }
+    request_client = NULL;
+    request_id = 0;
+}
+
+// Strip optional request ID prefix (#<id> COMMAND ...) and dispatch with the ID in scope,
+// so every reply to this client while handling the command carries the same prefix
+static void handle_message(client_t *client, const char *message) {
+    if (message == NULL) {
+        return;
+    }
+
+    unsigned int id = 0;
+    if (strncmp(message, REQUEST_ID_PREFIX, strlen(REQUEST_ID_PREFIX)) == 0) {
+        char *endptr;
+        unsigned long parsed = strtoul(message + strlen(REQUEST_ID_PREFIX), &endptr, 10);
+        if (*endptr != ' ' || parsed == 0 || parsed > UINT_MAX) {
+            send_error_and_count(client, ERR_INVALID_SYNTAX, "Invalid request ID");
+            return;
+        }
+        id = (unsigned int)parsed;
+        message = endptr + 1;
+    }
+
+    run_command(client, id, message, NULL);
+}
+
 // Command handlers
 
 static void handle_hello(client_t *client, const char *params) {
@@ -146,21 +550,50 @@ static void handle_hello(client_t *client, const char *params) {
         return;
     }
 
-    // Extract nickname (first word)
+    // Extract nickname (first word) and optional capability
     char nickname[MAX_NICK_LENGTH];
-    sscanf(params, "%31s", nickname);
+    char capability[16] = {0};
+    sscanf(params, "%31s %15s", nickname, capability);
+    int use_binary = (strcmp(capability, CAP_BINARY) == 0);
+
+    if (strncmp(nickname, BOT_NICK_PREFIX, strlen(BOT_NICK_PREFIX)) == 0) {
+        client_send_message(client, "ERROR " ERR_NICK_IN_USE " Nickname reserved for bots");
+        logger_log(LOG_INFO, "Client %d: Nickname '%s' reserved for bots", client->client_id, nickname);
+        return;
+    }
 
-    // Set nickname
+    // Set nickname first: releasing the identity finds the index entry by client->nickname
     strncpy(client->nickname, nickname, MAX_NICK_LENGTH - 1);
     client->nickname[MAX_NICK_LENGTH - 1] = '\0';
+
+    // Nicknames are unique (a disconnected player keeps theirs until the reconnect window ends)
+    if (client_list_claim_nickname(client, nickname) != 0) {
+        client->nickname[0] = '\0';
+        client_send_message(client, "ERROR " ERR_NICK_IN_USE " Nickname already in use");
+        logger_log(LOG_INFO, "Client %d: Nickname '%s' already in use", client->client_id, nickname);
+        return;
+    }
+
+    // Session token for RECONNECT (the client ID is guessable, the token isn't)
+    if (client_list_open_session(client) != 0) {
+        client_list_release_identity(client);
+        client->nickname[0] = '\0';
+        client_send_message(client, "ERROR Cannot start session");
+        return;
+    }
+
     client->state = STATE_IN_LOBBY;
 
-    // Send WELCOME response
+    // Send WELCOME response (acknowledge binary capability, last text message in that case)
     char response[MAX_MESSAGE_LENGTH];
-    snprintf(response, sizeof(response), "WELCOME %d", client->client_id);
+    snprintf(response, sizeof(response), "WELCOME %d%s%s SESSION %s", client->client_id,
+             use_binary ? " " : "", use_binary ? CAP_BINARY : "", client->session_token);
     client_send_message(client, response);
+    client->binary_mode = use_binary;
 
-    logger_log(LOG_INFO, "Client %d authenticated as '%s'", client->client_id, client->nickname);
+    logger_log(LOG_INFO, "Client %d authenticated as '%s'%s", client->client_id, client->nickname,
+               use_binary ? " (binary protocol)" : "");
+    eventlog_record(EVENT_AUTH, client->client_id, -1, use_binary, 0);
 }
 
 static void handle_list_rooms(client_t *client) {
@@ -176,21 +609,72 @@ static void handle_list_rooms(client_t *client) {
     logger_log(LOG_INFO, "Client %d (%s) requested room list", client->client_id, client->nickname);
 }
 
+static void handle_leaderboard(client_t *client) {
+    if (client->state < STATE_IN_LOBBY) {
+        client_send_message(client, "ERROR NOT_AUTHENTICATED Not authenticated");
+        return;
+    }
+
+    // Served from the stats module's top-K table, never from disk
+    stats_record_t top[STATS_TOP_K];
+    int count = stats_get_top(top, STATS_TOP_K);
+
+    char buffer[MAX_MESSAGE_LENGTH];
+    int offset = snprintf(buffer, sizeof(buffer), "%s %d", CMD_LEADERBOARD, count);
+    for (int i = 0; i < count && offset < (int)sizeof(buffer); i++) {
+        // Average flips per game, two decimals
+        unsigned int hundredths = 0;
+        if (top[i].games > 0) {
+            hundredths = (unsigned int)(((uint64_t)top[i].flips * 100 + top[i].games / 2) / top[i].games);
+        }
+
+        offset += snprintf(buffer + offset, sizeof(buffer) - offset, " %s %u %u %u %u.%02u",
+                           top[i].nickname, top[i].games, top[i].wins, top[i].pairs,
+                           hundredths / 100, hundredths % 100);
+    }
+    client_send_message(client, buffer);
+
+    logger_log(LOG_INFO, "Client %d (%s) requested leaderboard", client->client_id, client->nickname);
+}
+
+// Validate room settings (CREATE_ROOM, QUICK_MATCH), replying with the error
+static int check_room_params(client_t *client, int max_players, int board_size) {
+    if (max_players < 2 || max_players > MAX_PLAYERS_PER_ROOM) {
+        char error[MAX_MESSAGE_LENGTH];
+        snprintf(error, sizeof(error), "ERROR INVALID_PARAMS Max players must be 2-%d", MAX_PLAYERS_PER_ROOM);
+        client_send_message(client, error);
+        return -1;
+    }
+
+    if (board_size < 4 || board_size > 8 || board_size % 2 != 0) {
+        client_send_message(client, "ERROR INVALID_PARAMS Board size must be 4, 6, or 8");
+        return -1;
+    }
+
+    return 0;
+}
+
 static void handle_create_room(client_t *client, const char *params) {
     if (client->state < STATE_IN_LOBBY) {
         client_send_message(client, "ERROR NOT_AUTHENTICATED Not authenticated");
         return;
     }
 
+    // Picking a room leaves the quick match queue (a match that already took the client wins)
+    // and ends spectating
+    matchmaker_cancel(client);
+    spectator_detach(client);
+
     if (client->room != NULL) {
         client_send_message(client, "ERROR ALREADY_IN_ROOM Already in a room");
         return;
     }
 
-    // Parse parameters: <name> <max_players> <board_size>
+    // Parse parameters: <name> <max_players> <board_size> [turn_seconds]
     char room_name[MAX_ROOM_NAME_LENGTH];
     int max_players = 4;  // Default
     int board_size = 4;   // Default
+    int turn_seconds = config_get()->turn_timeout;
 
     if (params == NULL) {
         client_send_message(client, "ERROR INVALID_PARAMS Room name required");
@@ -198,28 +682,26 @@ static void handle_create_room(client_t *client, const char *params) {
     }
 
     // Parse room name, max players, and board size
-    int parsed = sscanf(params, "%63s %d %d", room_name, &max_players, &board_size);
+    int parsed = sscanf(params, "%63s %d %d %d", room_name, &max_players, &board_size, &turn_seconds);
     if (parsed < 1) {
         client_send_message(client, "ERROR INVALID_PARAMS Invalid format");
         return;
     }
 
-    // Validate max_players
-    if (max_players < 2 || max_players > MAX_PLAYERS_PER_ROOM) {
-        char error[MAX_MESSAGE_LENGTH];
-        snprintf(error, sizeof(error), "ERROR INVALID_PARAMS Max players must be 2-%d", MAX_PLAYERS_PER_ROOM);
-        client_send_message(client, error);
+    if (check_room_params(client, max_players, board_size) != 0) {
         return;
     }
 
-    // Validate board_size
-    if (board_size < 4 || board_size > 8 || board_size % 2 != 0) {
-        client_send_message(client, "ERROR INVALID_PARAMS Board size must be 4, 6, or 8");
+    if (turn_seconds != 0 && (turn_seconds < TURN_TIMEOUT_MIN || turn_seconds > TURN_TIMEOUT_MAX)) {
+        char error[MAX_MESSAGE_LENGTH];
+        snprintf(error, sizeof(error), "ERROR INVALID_PARAMS Turn time must be 0 or %d-%d seconds",
+                 TURN_TIMEOUT_MIN, TURN_TIMEOUT_MAX);
+        client_send_message(client, error);
         return;
     }
 
     // Create room
-    room_t *room = room_create(room_name, max_players, board_size, client);
+    room_t *room = room_create(room_name, max_players, board_size, turn_seconds, client);
     if (room == NULL) {
         client_send_message(client, "ERROR ROOM_LIMIT Room limit reached");
         return;
@@ -231,6 +713,7 @@ static void handle_create_room(client_t *client, const char *params) {
     client_send_message(client, response);
 
     logger_log(LOG_INFO, "Client %d (%s) created room %d", client->client_id, client->nickname, room->room_id);
+    eventlog_record(EVENT_ROOM_CREATE, client->client_id, room->room_id, max_players, board_size);
 }
 
 static void handle_join_room(client_t *client, const char *params) {
@@ -239,6 +722,11 @@ static void handle_join_room(client_t *client, const char *params) {
         return;
     }
 
+    // Picking a room leaves the quick match queue (a match that already took the client wins)
+    // and ends spectating
+    matchmaker_cancel(client);
+    spectator_detach(client);
+
     if (client->room != NULL) {
         client_send_message(client, "ERROR ALREADY_IN_ROOM Already in a room");
         return;
@@ -255,7 +743,13 @@ static void handle_join_room(client_t *client, const char *params) {
         return;
     }
 
-    // Find room
+    // The room is changed only by its worker
+    run_on_room_worker(client, room_id, join_room, NULL);
+}
+
+// Seat a lobby client in a room (room's worker)
+static void join_room(client_t *client, int room_id, void *arg) {
+    (void)arg;
     room_t *room = room_get_by_id(room_id);
     if (room == NULL) {
         client_send_message(client, "ERROR ROOM_NOT_FOUND Room not found");
@@ -281,12 +775,163 @@ static void handle_join_room(client_t *client, const char *params) {
     logger_log(LOG_INFO, "Client %d (%s) joined room %d", client->client_id, client->nickname, room->room_id);
 }
 
-static void handle_leave_room(client_t *client) {
+// QUICK_MATCH [max_players] [board_size] | QUICK_MATCH CANCEL
+static void handle_quick_match(client_t *client, const char *params) {
+    if (client->state < STATE_IN_LOBBY) {
+        client_send_message(client, "ERROR NOT_AUTHENTICATED Not authenticated");
+        return;
+    }
+
+    if (params != NULL && strcmp(params, QUICK_MATCH_CANCEL) == 0) {
+        if (matchmaker_cancel(client)) {
+            client_send_message(client, CMD_QUICK_MATCH_CANCELLED);
+        } else {
+            client_send_message(client, "ERROR " ERR_NOT_QUEUED " Not waiting for a match");
+        }
+        return;
+    }
+
+    if (client->room != NULL) {
+        client_send_message(client, "ERROR ALREADY_IN_ROOM Already in a room");
+        return;
+    }
+
+    if (atomic_load(&client->match_bucket) >= 0) {
+        client_send_message(client, "ERROR " ERR_ALREADY_QUEUED " Already waiting for a match");
+        return;
+    }
+
+    int max_players = QUICK_MATCH_DEFAULT_PLAYERS;
+    int board_size = QUICK_MATCH_DEFAULT_BOARD;
+    if (params != NULL) {
+        sscanf(params, "%d %d", &max_players, &board_size);
+    }
+
+    if (check_room_params(client, max_players, board_size) != 0) {
+        return;
+    }
+
+    spectator_detach(client);
+    matchmaker_enqueue(client, max_players, board_size);
+}
+
+// SPECTATE <room_id> - watch a room read-only until LEAVE_ROOM
+static void handle_spectate(client_t *client, const char *params) {
+    if (client->state < STATE_IN_LOBBY) {
+        client_send_message(client, "ERROR NOT_AUTHENTICATED Not authenticated");
+        return;
+    }
+
+    if (client->room != NULL) {
+        client_send_message(client, "ERROR ALREADY_IN_ROOM Already in a room");
+        return;
+    }
+
+    if (spectator_is_watching(client)) {
+        client_send_message(client, "ERROR ALREADY_IN_ROOM Already watching a room");
+        return;
+    }
+
+    if (atomic_load(&client->match_bucket) >= 0) {
+        client_send_message(client, "ERROR " ERR_ALREADY_QUEUED " Already waiting for a match");
+        return;
+    }
+
+    if (params == NULL) {
+        client_send_message(client, "ERROR INVALID_PARAMS Room ID required");
+        return;
+    }
+
+    int room_id = atoi(params);
+    if (room_id <= 0) {
+        client_send_message(client, "ERROR INVALID_PARAMS Invalid room ID");
+        return;
+    }
+
+    run_on_room_worker(client, room_id, spectate_room, NULL);
+}
+
+// Replies SPECTATING (and GAME_STATE) itself (room's worker)
+static void spectate_room(client_t *client, int room_id, void *arg) {
+    (void)arg;
+    if (room_add_spectator(room_id, client) != 0) {
+        client_send_message(client, "ERROR ROOM_NOT_FOUND Room not found");
+    }
+}
+
+// ADD_BOT [skill] [think_ms] - seat a bot in the owner's room before the game
+static void handle_add_bot(client_t *client, const char *params) {
     if (client->room == NULL) {
         client_send_message(client, "ERROR NOT_IN_ROOM Not in a room");
         return;
     }
 
+    room_t *room = client->room;
+
+    if (room->owner != client) {
+        client_send_message(client, "ERROR NOT_ROOM_OWNER Only room owner can add bots");
+        return;
+    }
+
+    if (room->game != NULL) {
+        client_send_message(client, "ERROR Game already started");
+        return;
+    }
+
+    int skill = BOT_DEFAULT_SKILL;
+    int think_ms = BOT_DEFAULT_THINK_MS;
+    if (params != NULL) {
+        sscanf(params, "%d %d", &skill, &think_ms);
+    }
+
+    if (skill < 0 || skill > 100) {
+        client_send_message(client, "ERROR INVALID_PARAMS Bot skill must be 0-100");
+        return;
+    }
+
+    if (think_ms < 0 || think_ms > BOT_MAX_THINK_MS) {
+        char error[MAX_MESSAGE_LENGTH];
+        snprintf(error, sizeof(error), "ERROR INVALID_PARAMS Bot think time must be 0-%d ms", BOT_MAX_THINK_MS);
+        client_send_message(client, error);
+        return;
+    }
+
+    if (room->player_count >= room->max_players) {
+        client_send_message(client, "ERROR ROOM_FULL Room is full");
+        return;
+    }
+
+    client_t *bot = bot_create(skill, think_ms);
+    if (bot == NULL) {
+        client_send_message(client, "ERROR Cannot create bot");
+        return;
+    }
+
+    if (room_add_player(room, bot) != 0) {
+        bot_destroy(bot);
+        client_send_message(client, "ERROR ROOM_FULL Room is full");
+        return;
+    }
+
+    // Everyone, the owner included, learns the bot's nickname from the broadcast
+    char broadcast[MAX_MESSAGE_LENGTH];
+    snprintf(broadcast, sizeof(broadcast), "PLAYER_JOINED %s", bot->nickname);
+    room_broadcast(room, broadcast);
+
+    logger_log(LOG_INFO, "Client %d (%s) added bot %s to room %d (skill %d%%, think %d ms)",
+               client->client_id, client->nickname, bot->nickname, room->room_id, skill, think_ms);
+}
+
+static void handle_leave_room(client_t *client) {
+    if (client->room == NULL) {
+        if (spectator_detach(client)) {
+            client_send_message(client, "LEFT_ROOM");
+        } else {
+            client_send_message(client, "ERROR NOT_IN_ROOM Not in a room");
+        }
+        return;
+    }
+
     room_t *room = client->room;
     int room_id = room->room_id;
 
@@ -363,7 +1008,7 @@ static void handle_ready(client_t *client) {
             // Send TURN to first player
             client_t *first_player = game_get_current_player(game);
             if (first_player != NULL) {
-                client_send_message(first_player, "YOUR_TURN");
+                room_start_turn(room);
                 logger_log(LOG_INFO, "Room %d: First turn goes to %s",
                            room->room_id, first_player->nickname);
             }
@@ -425,20 +1070,26 @@ static void handle_start_game(client_t *client) {
                room->room_id, client->nickname, room->game->board_size, room->player_count);
 }
 
-static void handle_flip(client_t *client, const char *params) {
+// Game a FLIP applies to, or NULL after replying with the error (text and binary FLIP)
+static game_t* flip_game(client_t *client) {
     if (client->room == NULL) {
         send_error_and_count(client, ERR_NOT_IN_ROOM, "Not in a room");
-        return;
+        return NULL;
     }
 
-    room_t *room = client->room;
-
-    if (room->game == NULL) {
+    if (client->room->game == NULL) {
         send_error_and_count(client, ERR_GAME_NOT_STARTED, "Game not started");
-        return;
+        return NULL;
     }
 
-    game_t *game = (game_t *)room->game;
+    return (game_t *)client->room->game;
+}
+
+static void handle_flip(client_t *client, const char *params) {
+    game_t *game = flip_game(client);
+    if (game == NULL) {
+        return;
+    }
 
     // Validate params
     if (params == NULL || strlen(params) == 0) {
@@ -455,7 +1106,11 @@ static void handle_flip(client_t *client, const char *params) {
         return;
     }
 
-    int card_index = (int)card_index_long;
+    flip_card(client, game, (int)card_index_long);
+}
+
+static void flip_card(client_t *client, game_t *game, int card_index) {
+    room_t *room = client->room;
 
     // Validate card_index is within board bounds
     if (card_index < 0 || card_index >= game->total_cards) {
@@ -483,12 +1138,16 @@ static void handle_flip(client_t *client, const char *params) {
     logger_log(LOG_INFO, "Room %d: Player %s flipped card %d (value=%d)",
                room->room_id, client->nickname, card_index,
                game->cards[card_index].value);
+    eventlog_record(EVENT_FLIP, client->client_id, room->room_id, card_index, game->cards[card_index].value);
 
     // If this was the second card, check for match
     if (game->flips_this_turn == 2) {
+        int first_card = game->first_card_index;
         int is_match = game_check_match(game);
 
         if (is_match) {
+            eventlog_record(EVENT_MATCH, client->client_id, room->room_id, first_card, card_index);
+
             // MATCH!
             char match_msg[MAX_MESSAGE_LENGTH];
             snprintf(match_msg, sizeof(match_msg), "MATCH %s %d",
@@ -522,6 +1181,8 @@ static void handle_flip(client_t *client, const char *params) {
                 logger_log(LOG_INFO, "Room %d: Game finished, %d winner(s)",
                            room->room_id, winner_count);
 
+                stats_record_game(game, NULL);
+
                 // Clean up game
                 game_destroy(game);
                 room->game = NULL;
@@ -540,8 +1201,8 @@ static void handle_flip(client_t *client, const char *params) {
                 // Destroy the finished room
                 room_destroy(room);
             } else {
-                // Same player continues, send YOUR_TURN
-                client_send_message(client, "YOUR_TURN");
+                // Same player continues with a fresh turn
+                room_start_turn(room);
             }
         } else {
             // MISMATCH - include next player's name
@@ -552,7 +1213,7 @@ static void handle_flip(client_t *client, const char *params) {
                 room_broadcast(room, mismatch_msg);
 
                 // Send YOUR_TURN to next player
-                client_send_message(next_player, "YOUR_TURN");
+                room_start_turn(room);
                 logger_log(LOG_INFO, "Room %d: Turn passed to %s",
                            room->room_id, next_player->nickname);
             } else {
@@ -562,35 +1223,84 @@ static void handle_flip(client_t *client, const char *params) {
     }
 }
 
-static void handle_pong(client_t *client) {
-    // Update last activity and PONG tracking
-    client->last_activity = time(NULL);
-    client->last_pong_time = time(NULL);
-    client->waiting_for_pong = 0;  // Reset waiting flag
-    logger_log(LOG_INFO, "Client %d: PONG received", client->client_id);
+// PONG [ms] - ms echoes the PING timestamp; clients without the echo just keep the session alive
+static void handle_pong(client_t *client, const char *params) {
+    unsigned int echoed = 0;
+    int has_echo = params != NULL && sscanf(params, "%u", &echoed) == 1;
+    pong_received(client, has_echo, echoed);
 }
 
-static void handle_reconnect(client_t *new_client, const char *params) {
-    if (params == NULL) {
-        client_send_message(new_client, "ERROR INVALID_PARAMS Missing client ID");
+static void pong_received(client_t *client, int has_echo, unsigned int echoed) {
+    // Update last activity and PONG tracking
+    client->last_activity_ms = clock_now_ms();
+    client->last_pong_ms = client->last_activity_ms;
+
+    if (!has_echo || !client->waiting_for_pong || echoed != client->ping_sent_ms) {
+        client->waiting_for_pong = 0;  // Reset waiting flag
+        logger_log(LOG_DEBUG, "Client %d: PONG received", client->client_id);
         return;
     }
+    client->waiting_for_pong = 0;
+
+    // Smoothed RTT and jitter as in TCP's RTO estimator (RFC 6298, gains 1/8 and 1/4)
+    int rtt = (int)((unsigned int)clock_now_ms() - echoed);
+    int late = 0;
+    if (client->srtt_ms < 0) {
+        client->srtt_ms = rtt;
+        client->rttvar_ms = rtt / 2;
+    } else {
+        int deviation = abs(client->srtt_ms - rtt);
+        late = rtt > client->srtt_ms + 4 * client->rttvar_ms;
+        client->rttvar_ms = (3 * client->rttvar_ms + deviation) / 4;
+        client->srtt_ms = (7 * client->srtt_ms + rtt) / 8;
+    }
 
-    int old_client_id = atoi(params);
-    if (old_client_id <= 0) {
-        client_send_message(new_client, "ERROR INVALID_PARAMS Invalid client ID");
-        return;
+    // Steady connections get pinged less often, a late PONG falls back to the base interval
+    if (late) {
+        client->heartbeat_interval = config_get()->pong_wait_interval;
+    } else if (client->heartbeat_interval < config_get()->pong_wait_interval_max) {
+        client->heartbeat_interval++;
     }
 
-    // Find old client by ID
-    client_t *old_client = client_list_find_by_id(old_client_id);
-    if (old_client == NULL) {
-        logger_log(LOG_WARNING, "Client %d: RECONNECT failed - client %d not found",
-                  new_client->client_id, old_client_id);
-        client_send_message(new_client, "ERROR Client not found or session expired");
+    logger_log(LOG_DEBUG, "Client %d: PONG received (rtt %d ms, srtt %d ms, jitter %d ms, next in %ds)",
+              client->client_id, rtt, client->srtt_ms, client->rttvar_ms, client->heartbeat_interval);
+}
+
+typedef struct {
+    client_t *old_client;
+    unsigned int last_seq;
+} reattach_t;
+
+// Take over the old client's seat and catch up on the room (room's worker)
+static void reattach_to_room(client_t *new_client, int room_id, void *arg) {
+    reattach_t *reattach = (reattach_t *)arg;
+    client_t *old_client = reattach->old_client;
+    (void)room_id;
+
+    // The room may have ended or dropped the old client meanwhile
+    room_t *room = old_client->room;
+    new_client->state = old_client->state;
+    new_client->room = room;
+    if (room == NULL) {
         return;
     }
 
+    int replayed = room_reattach_player(room, old_client, new_client, reattach->last_seq);
+    if (replayed >= 0) {
+        logger_log(LOG_INFO, "Client %d: Delta resync from seq %u (%d events)",
+                  new_client->client_id, reattach->last_seq, replayed);
+    }
+
+    // Notify other players about reconnection
+    char broadcast[MAX_MESSAGE_LENGTH];
+    snprintf(broadcast, sizeof(broadcast), "PLAYER_RECONNECTED %s", new_client->nickname);
+    room_broadcast(room, broadcast);
+}
+
+// Take over a looked-up old client's session (the caller holds a reference to it)
+static void take_over_session(client_t *new_client, client_t *old_client, unsigned int last_seq, int use_binary) {
+    int old_client_id = old_client->client_id;
+
     // Reject reconnect if client is already connected
     if (!old_client->is_disconnected && old_client->socket_fd >= 0) {
         logger_log(LOG_WARNING, "Client %d: RECONNECT rejected - client %d already connected",
@@ -600,145 +1310,267 @@ static void handle_reconnect(client_t *new_client, const char *params) {
     }
 
     // Check disconnect time - use disconnect_time if player was disconnected from game
-    time_t disconnect_duration;
+    int64_t disconnect_duration_ms;
     if (old_client->is_disconnected) {
-        disconnect_duration = time(NULL) - old_client->disconnect_time;
+        disconnect_duration_ms = clock_now_ms() - old_client->disconnect_time_ms;
     } else {
-        disconnect_duration = time(NULL) - old_client->last_activity;
+        disconnect_duration_ms = clock_now_ms() - old_client->last_activity_ms;
     }
+    long disconnect_duration = (long)(disconnect_duration_ms / 1000);
 
-    if (disconnect_duration > RECONNECT_TIMEOUT) {
+    if (disconnect_duration_ms > CLOCK_MS(config_get()->reconnect_timeout)) {
         client_send_message(new_client, "ERROR Session expired (timeout > 60s)");
         logger_log(LOG_WARNING, "Client %d: RECONNECT failed - timeout too long (%ld seconds)",
                   new_client->client_id, disconnect_duration);
         return;
     }
 
+    // REPLACE old client in-place instead of adding new one (keeps client IDs unique);
+    // fails if the timeout checker expired the session meanwhile
+    if (client_list_replace(old_client, new_client) != 0) {
+        logger_log(LOG_WARNING, "Client %d: RECONNECT failed - session of client %d expired meanwhile",
+                  new_client->client_id, old_client_id);
+        client_send_message(new_client, "ERROR Client not found or session expired");
+        return;
+    }
+
     logger_log(LOG_INFO, "Client %d: Reconnecting as client %d (%s), disconnect duration: %ld seconds",
               new_client->client_id, old_client_id, old_client->nickname, disconnect_duration);
-
-    // Transfer state from old to new client
+    int room_id = atomic_load(&old_client->room_mailbox);
+    eventlog_record(EVENT_RECONNECT, old_client_id, room_id != 0 ? room_id : -1,
+                    new_client->client_id, (int)disconnect_duration);
+
+    // Transfer state from old to new client (a nickname or session this connection had is given up)
+    client_list_release_identity(new_client);
+    matchmaker_cancel(new_client);
+    spectator_detach(new_client);
     strcpy(new_client->nickname, old_client->nickname);
+    strcpy(new_client->session_token, old_client->session_token);
     new_client->state = old_client->state;
-    new_client->room = old_client->room;
+    atomic_store(&new_client->room_mailbox, room_id);
     new_client->client_id = old_client->client_id;  // Keep old ID
-    new_client->last_activity = time(NULL);
+    new_client->last_activity_ms = clock_now_ms();
     new_client->is_disconnected = 0;  // Reset disconnected flag
-    new_client->disconnect_time = 0;
+    new_client->disconnect_time_ms = 0;
     new_client->waiting_for_pong = 0;  // Reset PING-PONG tracking
-    new_client->last_pong_time = time(NULL);
-    new_client->last_ping_time = 0;
+    new_client->last_pong_ms = new_client->last_activity_ms;
+    new_client->last_ping_ms = 0;
 
     // Close old socket if still valid
     if (old_client->socket_fd >= 0) {
         close(old_client->socket_fd);
     }
 
-    // Update room player pointer if in room (update ALL occurrences to prevent use-after-free)
-    if (new_client->room != NULL) {
-        room_t *room = new_client->room;
-        int room_updates = 0;
-        for (int i = 0; i < room->player_count; i++) {
-            if (room->players[i] == old_client) {
-                room->players[i] = new_client;
-                room_updates++;
-            }
+    // Send WELCOME with same client ID (switch to binary framing right after it if requested)
+    char welcome_msg[MAX_MESSAGE_LENGTH];
+    snprintf(welcome_msg, sizeof(welcome_msg), "WELCOME %d%s%s Reconnected successfully",
+             new_client->client_id, use_binary ? " " : "", use_binary ? CAP_BINARY : "");
+    client_send_message(new_client, welcome_msg);
+    new_client->binary_mode = use_binary;
+
+    // If in room, restore room/game state where the room's commands run
+    if (room_id != 0) {
+        reattach_t reattach = { old_client, last_seq };
+        run_on_room_worker(new_client, room_id, reattach_to_room, &reattach);
+    }
+
+    // The old client is out of the list and its room seat; let its queued commands finish
+    wait_for_room_commands(old_client);
+
+    logger_log(LOG_INFO, "Client %d: Reconnection successful", new_client->client_id);
+}
+
+static void handle_reconnect(client_t *new_client, const char *params) {
+    if (params == NULL) {
+        client_send_message(new_client, "ERROR INVALID_PARAMS Missing session token");
+        return;
+    }
+
+    // Format: RECONNECT <session_token> [last_seq] [capability]
+    char token[SESSION_TOKEN_LENGTH + 1] = {0};
+    unsigned int last_seq = 0;
+    char capability[16] = {0};
+    sscanf(params, "%32s %u %15s", token, &last_seq, capability);
+    int use_binary = (strcmp(capability, CAP_BINARY) == 0);
+
+    if (strlen(token) != SESSION_TOKEN_LENGTH) {
+        client_send_message(new_client, "ERROR INVALID_PARAMS Invalid session token");
+        return;
+    }
+
+    // The token leads straight to the old client and its seat; the reference keeps it
+    // valid even if the timeout checker drops it meanwhile
+    client_t *old_client = client_list_find_by_session(token);
+    if (old_client == NULL) {
+        logger_log(LOG_WARNING, "Client %d: RECONNECT failed - unknown session token",
+                  new_client->client_id);
+        client_send_message(new_client, "ERROR Client not found or session expired");
+        return;
+    }
+
+    take_over_session(new_client, old_client, last_seq, use_binary);
+    client_list_release(old_client);
+}
+
+typedef struct {
+    client_t *client;
+    int handled;  // Set if the game path took ownership of the client
+} game_disconnect_t;
+
+// Remove a player who dropped mid-game (runs on the room's worker)
+static void handle_game_disconnect(void *arg) {
+    game_disconnect_t *request = (game_disconnect_t *)arg;
+    client_t *client = request->client;
+
+    // Queued room work may have ended the game meanwhile
+    if (client->state != STATE_IN_GAME || client->room == NULL || client->room->game == NULL) {
+        return;
+    }
+    request->handled = 1;
+
+    room_t *room = client->room;
+    game_t *game = (game_t *)room->game;
+    int room_id = room->room_id;
+
+    // Count remaining players (excluding disconnected client)
+    int remaining_player_count = 0;
+    for (int i = 0; i < room->player_count; i++) {
+        if (room->players[i] != NULL && room->players[i] != client) {
+            remaining_player_count++;
         }
-        if (room_updates > 0) {
-            logger_log(LOG_INFO, "Client %d: Updated room %d player pointer (%d occurrences)",
-                      new_client->client_id, room->room_id, room_updates);
-            if (room_updates > 1) {
-                logger_log(LOG_ERROR, "BUG: Client was in room->players[] %d times!", room_updates);
+    }
+
+    logger_log(LOG_INFO, "Room %d: Player %s disconnected, %d players remaining",
+               room_id, client->nickname, remaining_player_count);
+
+    if (remaining_player_count >= 2) {
+        // 2+ players remain → game continues, just remove disconnected player
+        logger_log(LOG_INFO, "Room %d: Game continues with %d players (player %s removed)",
+                  room_id, remaining_player_count, client->nickname);
+
+        // Notify remaining players
+        char broadcast[MAX_MESSAGE_LENGTH];
+        snprintf(broadcast, sizeof(broadcast),
+                "PLAYER_DISCONNECTED %s REMOVED Game continues", client->nickname);
+        room_broadcast_except(room, broadcast, client);
+
+        // If it was disconnected player's turn, advance to next player
+        client_t *current_player = game_get_current_player(game);
+        int was_his_turn = (current_player == client);
+
+        // Remove player from game
+        game_remove_player(game, client);
+
+        // Remove player from room
+        room_remove_player(room, client);
+
+        // If it was his turn, notify next player
+        if (was_his_turn) {
+            client_t *next_player = game_get_current_player(game);
+            if (next_player != NULL) {
+                room_start_turn(room);
+                logger_log(LOG_INFO, "Room %d: Next turn goes to %s",
+                          room_id, next_player->nickname);
             }
         }
 
-        // Update game player pointer if in game (update ALL occurrences)
-        if (room->game != NULL) {
-            game_t *game = (game_t *)room->game;
-            int game_updates = 0;
-            for (int i = 0; i < game->player_count; i++) {
-                if (game->players[i] == old_client) {
-                    game->players[i] = new_client;
-                    game_updates++;
-                }
-            }
-            if (game_updates > 0) {
-                logger_log(LOG_INFO, "Client %d: Updated game player pointer (%d occurrences)",
-                          new_client->client_id, game_updates);
-                if (game_updates > 1) {
-                    logger_log(LOG_ERROR, "BUG: Client was in game->players[] %d times!", game_updates);
-                }
-            }
+        // Clean up disconnected client
+        logger_log(LOG_INFO, "Client %d (%s) removed from game, cleaned up",
+                  client->client_id, client->nickname);
+        client_list_remove(client);
+        return;
+
+    } else {
+        // Less than 2 players remain → mark disconnected and wait for reconnect
+        // CRITICAL: Copy client_id and nickname BEFORE marking as disconnected
+        // because handle_reconnect on another thread can take this client over immediately after
+        int client_id = client->client_id;
+        char nickname_copy[MAX_NICK_LENGTH];
+        strncpy(nickname_copy, client->nickname, sizeof(nickname_copy) - 1);
+        nickname_copy[sizeof(nickname_copy) - 1] = '\0';
+
+        // Mark disconnected player for reconnect
+        client->is_disconnected = 1;
+        client->disconnect_time_ms = clock_now_ms();
+
+        // Close socket if still open
+        int fd = client->socket_fd;
+        if (fd >= 0) {
+            shutdown(fd, SHUT_RDWR);
+            client->socket_fd = -1;
         }
+
+        // Notify remaining players about disconnect (waiting for reconnect)
+        char broadcast[MAX_MESSAGE_LENGTH];
+        snprintf(broadcast, sizeof(broadcast),
+                "PLAYER_DISCONNECTED %s SHORT Waiting for reconnect (up to %d seconds)...",
+                nickname_copy, config_get()->reconnect_timeout);
+        room_broadcast_except(room, broadcast, client);
+
+        logger_log(LOG_INFO, "Client %d (%s): Waiting for reconnect (%d seconds)",
+                  client_id, nickname_copy, config_get()->reconnect_timeout);
+
+        // The list keeps the client until a reconnect or the timeout checker takes it out
+        // Don't destroy game/room - keep them alive for potential reconnect
+        return;
     }
+}
+
+// Remove a player from a room outside of a game (runs on the room's worker)
+static void handle_room_disconnect(void *arg) {
+    client_t *client = (client_t *)arg;
 
-    // REPLACE old client in-place instead of adding new one
-    // This prevents having duplicate client_ids in the list
-    client_list_replace(old_client, new_client);
+    if (client->room != NULL) {
+        room_remove_player(client->room, client);
+    }
+}
 
-    // Free old client immediately (safe now - replaced in list, no thread can access it)
-    free(old_client);
+// Returns -1 if the client's address is over its message rate (connection is closed)
+static int check_message_rate(client_t *client) {
+    if (!ratelimit_allow_message(client->peer_addr)) {
+        logger_log_ratelimited(LOG_WARNING, 5, "Client %d: Message rate limit exceeded, closing connection",
+                               client->client_id);
+        return -1;
+    }
+    return 0;
+}
 
-    // Send WELCOME with same client ID
-    char welcome_msg[MAX_MESSAGE_LENGTH];
-    snprintf(welcome_msg, sizeof(welcome_msg), "WELCOME %d Reconnected successfully",
-             new_client->client_id);
-    client_send_message(new_client, welcome_msg);
+// Log, stamp activity and dispatch one complete message
+// Returns -1 if the client's address is over its message rate (connection is closed)
+static int dispatch_line(client_t *client, const char *line) {
+    if (check_message_rate(client) != 0) {
+        return -1;
+    }
 
-    // If in room, restore room/game state
-    if (new_client->room != NULL) {
-        room_t *room = new_client->room;
+    // Log the received message (except PING/PONG which have their own logs)
+    if (logger_enabled(LOG_DEBUG) &&
+        strncmp(line, CMD_PONG, strlen(CMD_PONG)) != 0 && strncmp(line, CMD_PING, strlen(CMD_PING)) != 0) {
+        logger_log(LOG_DEBUG, "Client %d: Received message: '%s'", client->client_id, line);
+    }
 
-        // Notify other players about reconnection
-        char broadcast[MAX_MESSAGE_LENGTH];
-        snprintf(broadcast, sizeof(broadcast), "PLAYER_RECONNECTED %s", new_client->nickname);
-        room_broadcast(room, broadcast);
+    // Update last activity
+    client->last_activity_ms = clock_now_ms();
 
-        if (room->game != NULL) {
-            game_t *game = (game_t *)room->game;
+    // Handle the message
+    handle_message(client, line);
+    return 0;
+}
 
-            if (game->state == GAME_STATE_PLAYING) {
-                // Game is actively playing - send full game state
-                char state_msg[MAX_MESSAGE_LENGTH];
-                if (game_format_state_message(game, state_msg, sizeof(state_msg)) == 0) {
-                    client_send_message(new_client, state_msg);
-                    logger_log(LOG_INFO, "Client %d: Sent GAME_STATE for reconnection",
-                              new_client->client_id);
-                }
+// dispatch_line() for a binary FLIP/PONG decoded in place (see is_typed_frame())
+static int dispatch_typed_frame(client_t *client, const codec_frame_t *frame) {
+    if (check_message_rate(client) != 0) {
+        return -1;
+    }
 
-                // If it's the reconnected player's turn, send YOUR_TURN
-                client_t *current_player = game_get_current_player(game);
-                if (current_player == new_client) {
-                    client_send_message(new_client, "YOUR_TURN");
-                    logger_log(LOG_INFO, "Client %d: It's your turn after reconnection",
-                              new_client->client_id);
-                }
-            } else if (game->state == GAME_STATE_WAITING) {
-                // Game created but waiting for READY - send room info
-                char room_msg[MAX_MESSAGE_LENGTH];
-                snprintf(room_msg, sizeof(room_msg), "ROOM_JOINED %d %s", room->room_id, room->name);
-                client_send_message(new_client, room_msg);
-
-                // Send GAME_CREATED to remind about READY
-                char game_created_msg[MAX_MESSAGE_LENGTH];
-                snprintf(game_created_msg, sizeof(game_created_msg),
-                         "GAME_CREATED %d Send READY when you are prepared to play", game->board_size);
-                client_send_message(new_client, game_created_msg);
-
-                logger_log(LOG_INFO, "Client %d: Sent ROOM_JOINED and GAME_CREATED for reconnection",
-                          new_client->client_id);
-            }
-        } else {
-            // In room but no game yet - just send room info
-            char room_msg[MAX_MESSAGE_LENGTH];
-            snprintf(room_msg, sizeof(room_msg), "ROOM_JOINED %d %s", room->room_id, room->name);
-            client_send_message(new_client, room_msg);
-            logger_log(LOG_INFO, "Client %d: Sent ROOM_JOINED for reconnection",
-                      new_client->client_id);
-        }
+    if (logger_enabled(LOG_DEBUG) && strcmp(frame->command, CMD_PONG) != 0) {
+        logger_log(LOG_DEBUG, "Client %d: Received frame: %s %d", client->client_id,
+                   frame->command, frame->fields[0]);
     }
 
-    logger_log(LOG_INFO, "Client %d: Reconnection successful", new_client->client_id);
+    client->last_activity_ms = clock_now_ms();
+
+    run_command(client, frame->request_id, NULL, frame);
+    return 0;
 }
 
 void* client_handler_thread(void *arg) {
@@ -747,13 +1579,22 @@ void* client_handler_thread(void *arg) {
     char line_buffer[MAX_MESSAGE_LENGTH];
     int line_pos = 0;
 
+    // Binary framing state (used once the client negotiated CAP_BINARY)
+    unsigned char frame_buffer[CODEC_MAX_FRAME_SIZE];
+    unsigned int frame_length = 0;
+    int frame_shift = 0;
+    int frame_length_done = 0;
+    unsigned int frame_pos = 0;
+    int protocol_error = 0;
+
     // Initialize client
     client->room = NULL;
 
     logger_log(LOG_INFO, "Client %d: Handler thread started (fd=%d)", client->client_id, client->socket_fd);
 
-    while (1) {
-        int bytes_received = recv(client->socket_fd, buffer, sizeof(buffer) - 1, 0);
+    while (!protocol_error) {
+        // Yields to the scheduler instead of blocking when running as a coroutine
+        int bytes_received = (int)coro_recv(client->socket_fd, buffer, sizeof(buffer) - 1);
 
         if (bytes_received < 0) {
             logger_log(LOG_ERROR, "Client %d: recv() failed", client->client_id);
@@ -766,26 +1607,59 @@ void* client_handler_thread(void *arg) {
         }
 
         buffer[bytes_received] = '\0';
+        atomic_fetch_add_explicit(&client->bytes_in, bytes_received, memory_order_relaxed);
+
+        // Process received data byte by byte; the mode can switch mid-buffer right after HELLO
+        for (int i = 0; i < bytes_received && !protocol_error; i++) {
+            if (client->binary_mode) {
+                unsigned char byte = (unsigned char)buffer[i];
+
+                if (!frame_length_done) {
+                    int result = codec_feed_length(byte, &frame_length, &frame_shift);
+                    if (result < 0 || (result == 1 && (frame_length == 0 || frame_length > sizeof(frame_buffer)))) {
+                        // Framing lost - the stream cannot be resynchronized
+                        logger_log(LOG_WARNING, "Client %d: Invalid binary frame length, closing connection",
+                                  client->client_id);
+                        protocol_error = 1;
+                    } else if (result == 1) {
+                        frame_length_done = 1;
+                        frame_pos = 0;
+                    }
+                    continue;
+                }
+
+                frame_buffer[frame_pos++] = byte;
+                if (frame_pos == frame_length) {
+                    // FLIP and PONG skip the text round trip, the rest is transcoded
+                    codec_frame_t frame;
+                    if (codec_decode_ints(frame_buffer, frame_length, &frame) == 1 && is_typed_frame(&frame)) {
+                        if (dispatch_typed_frame(client, &frame) != 0) {
+                            protocol_error = 1;
+                        }
+                    } else {
+                        int len = codec_decode_body(frame_buffer, frame_length, line_buffer, sizeof(line_buffer));
+                        if (len < 0) {
+                            send_error_and_count(client, ERR_INVALID_SYNTAX, "Malformed binary frame");
+                        } else if (len > 0 && dispatch_line(client, line_buffer) != 0) {
+                            protocol_error = 1;
+                        }
+                    }
+
+                    frame_length = 0;
+                    frame_shift = 0;
+                    frame_length_done = 0;
+                }
+                continue;
+            }
 
-        // Process received data character by character to handle \n delimited messages
-        for (int i = 0; i < bytes_received; i++) {
             char c = buffer[i];
 
             if (c == '\n') {
                 // End of message
                 line_buffer[line_pos] = '\0';
 
-                if (line_pos > 0) {
-                    // Log the received message (except PING/PONG which have their own logs)
-                    if (strcmp(line_buffer, "PONG") != 0 && strcmp(line_buffer, "PING") != 0) {
-                        logger_log(LOG_INFO, "Client %d: Received message: '%s'", client->client_id, line_buffer);
-                    }
-
-                    // Update last activity
-                    client->last_activity = time(NULL);
-
-                    // Handle the message
-                    handle_message(client, line_buffer);
+                if (line_pos > 0 && dispatch_line(client, line_buffer) != 0) {
+                    protocol_error = 1;
                 }
 
                 // Reset line buffer
@@ -807,100 +1681,30 @@ void* client_handler_thread(void *arg) {
         }
     }
 
-    // Cleanup - handle disconnection
-    if (client->state == STATE_IN_GAME && client->room != NULL && client->room->game != NULL) {
-
-        room_t *room = client->room;
-        game_t *game = (game_t *)room->game;
-        int room_id = room->room_id;
-
-        // Count remaining players (excluding disconnected client)
-        int remaining_player_count = 0;
-        for (int i = 0; i < room->player_count; i++) {
-            if (room->players[i] != NULL && room->players[i] != client) {
-                remaining_player_count++;
-            }
-        }
-
-        logger_log(LOG_INFO, "Room %d: Player %s disconnected, %d players remaining",
-                   room_id, client->nickname, remaining_player_count);
-
-        if (remaining_player_count >= 2) {
-            // 2+ players remain → game continues, just remove disconnected player
-            logger_log(LOG_INFO, "Room %d: Game continues with %d players (player %s removed)",
-                      room_id, remaining_player_count, client->nickname);
+    // Leave the quick match queue first; a match that already took the client is cleaned up below
+    matchmaker_cancel(client);
+    spectator_detach(client);  // The fan-out thread must be done with the client before it's freed
 
-            // Notify remaining players
-            char broadcast[MAX_MESSAGE_LENGTH];
-            snprintf(broadcast, sizeof(broadcast),
-                    "PLAYER_DISCONNECTED %s REMOVED Game continues", client->nickname);
-            room_broadcast_except(room, broadcast, client);
+    eventlog_record(EVENT_DISCONNECT, client->client_id, client->room != NULL ? client->room->room_id : -1, 0, 0);
 
-            // If it was disconnected player's turn, advance to next player
-            client_t *current_player = game_get_current_player(game);
-            int was_his_turn = (current_player == client);
-
-            // Remove player from game
-            game_remove_player(game, client);
-
-            // Remove player from room
-            room_remove_player(room, client);
+    // Room commands still queued reference this client
+    wait_for_room_commands(client);
 
-            // If it was his turn, notify next player
-            if (was_his_turn) {
-                client_t *next_player = game_get_current_player(game);
-                if (next_player != NULL) {
-                    client_send_message(next_player, "YOUR_TURN");
-                    logger_log(LOG_INFO, "Room %d: Next turn goes to %s",
-                              room_id, next_player->nickname);
-                }
-            }
-
-            // Clean up disconnected client
-            logger_log(LOG_INFO, "Client %d (%s) removed from game, cleaned up",
-                      client->client_id, client->nickname);
-            client_list_remove(client);
-            free(client);
-            return NULL;
-
-        } else {
-            // Less than 2 players remain → mark disconnected and wait for reconnect
-            // CRITICAL: Copy client_id and nickname BEFORE marking as disconnected
-            // because handle_reconnect on another thread can free() this client immediately after
-            int client_id = client->client_id;
-            char nickname_copy[MAX_NICK_LENGTH];
-            strncpy(nickname_copy, client->nickname, sizeof(nickname_copy) - 1);
-            nickname_copy[sizeof(nickname_copy) - 1] = '\0';
-            time_t disconnect_time = time(NULL);
-
-            // Mark disconnected player for reconnect
-            client->is_disconnected = 1;
-            client->disconnect_time = disconnect_time;
-
-            // Close socket if still open
-            int fd = client->socket_fd;
-            if (fd >= 0) {
-                shutdown(fd, SHUT_RDWR);
-                client->socket_fd = -1;
-            }
-
-            // Notify remaining players about disconnect (waiting for reconnect)
-            char broadcast[MAX_MESSAGE_LENGTH];
-            snprintf(broadcast, sizeof(broadcast),
-                    "PLAYER_DISCONNECTED %s SHORT Waiting for reconnect (up to %d seconds)...",
-                    nickname_copy, RECONNECT_TIMEOUT);
-            room_broadcast_except(room, broadcast, client);
-
-            logger_log(LOG_INFO, "Client %d (%s): Waiting for reconnect (%d seconds)",
-                      client_id, nickname_copy, RECONNECT_TIMEOUT);
+    // Cleanup - handle disconnection. The room's worker may clear client->room at any
+    // time, so its worker is picked by room_mailbox and the handlers recheck the room.
+    int room_id = atomic_load(&client->room_mailbox);
+    game_disconnect_t game_disconnect = { client, 0 };
+    if (client->state == STATE_IN_GAME && room_id != 0) {
+        worker_pool_run_sync(room_id, handle_game_disconnect, &game_disconnect);
+    }
 
-            // Don't free client - timeout_checker will handle cleanup after 60s if no reconnect
-            // Don't destroy game/room - keep them alive for potential reconnect
-            return NULL;
-        }
+    if (game_disconnect.handled) {
+        // Client left the list or is parked there for reconnect
+        client_list_release(client);
+        return NULL;
     } else if (client->is_disconnected) {
-        // CRITICAL: Copy client data locally to prevent use-after-free
-        // because handle_reconnect on another thread can free() this client at any time
+        // CRITICAL: Copy client data locally because handle_reconnect on another
+        // thread can take this client over at any time
         int client_id = client->client_id;
         char nickname_copy[MAX_NICK_LENGTH];
         strncpy(nickname_copy, client->nickname, sizeof(nickname_copy) - 1);
@@ -916,7 +1720,8 @@ void* client_handler_thread(void *arg) {
             room_remove_player(room, client);
         }
 
-        // Don't free client - timeout_checker will handle cleanup
+        // The list keeps the client - timeout_checker will handle cleanup
+        client_list_release(client);
         return NULL;
     }
 
@@ -924,20 +1729,21 @@ void* client_handler_thread(void *arg) {
     logger_log(LOG_INFO, "Client %d: Disconnecting", client->client_id);
 
     // If client is in a room (but not in game), remove them
-    if (client->room != NULL) {
-        room_remove_player(client->room, client);
+    if (room_id != 0) {
+        worker_pool_run_sync(room_id, handle_room_disconnect, client);
     }
 
     logger_log(LOG_INFO, "Client %d: Closing connection", client->client_id);
 
     // Check if server is shutting down BEFORE any cleanup
-    // If shutting down, DON'T remove or free - client_list_shutdown() will handle everything
+    // If shutting down, DON'T remove - client_list_shutdown() will handle everything
     server_config_t *config = server_get_config();
     if (!config->running) {
         logger_log(LOG_INFO, "Client %d: Server shutting down, skipping cleanup (handled by shutdown)",
                   client->client_id);
         // Just mark socket as invalid to prevent other threads from using it
         client->socket_fd = -1;
+        client_list_release(client);
         return NULL;
     }
 
@@ -954,9 +1760,8 @@ void* client_handler_thread(void *arg) {
         close(old_fd);
     }
 
-    // Free client structure
-    // SAFETY: Client is already removed from list, socket marked invalid
-    free(client);
+    // Drop the handler's reference (a PING or timeout checker snapshot may still hold one)
+    client_list_release(client);
 
     return NULL;
 }
@@ -2,28 +2,53 @@
 #define CLIENT_HANDLER_H
 
 #include "protocol.h"
+#include "coro.h"
 #include <time.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
 
 /**
  * Client handler module - manages individual client connections
  */
 
-// Forward declaration to avoid circular dependency
+// Forward declarations to avoid circular dependency
 struct room_s;
+struct spectator_list_s;
+struct bot_s;
 
 typedef struct {
     int socket_fd;
     char nickname[MAX_NICK_LENGTH];
     client_state_t state;
-    time_t last_activity;
+    int64_t last_activity_ms;  // clock_now_ms() of the last received message
     int invalid_message_count;
     int client_id;
+    atomic_int refs;  // Handler thread, client list and looked-up pointers (see client_list_release())
+    int list_slot;  // Index in the client list (-1 if not listed, guarded by the list mutex)
     struct room_s *room;  // Current room (NULL if in lobby)
+    atomic_int room_mailbox;  // Room whose worker runs this client's room commands (0 = never joined one)
+    int room_slot;  // Seat in room->players[] (hint, checked before use)
+    int game_slot;  // Seat in game->players[] (hint, checked before use)
+    char session_token[SESSION_TOKEN_LENGTH + 1];  // Secret for RECONNECT, issued in WELCOME
+    atomic_int match_bucket;  // QUICK_MATCH bucket while waiting (-1 if not queued)
+    struct spectator_list_s *spectating;  // Room being watched (NULL if none, guarded by the spectator module)
     int is_disconnected;  // 1 if client disconnected but waiting for reconnect
-    time_t disconnect_time;  // When the client disconnected
+    int64_t disconnect_time_ms;  // When the client disconnected
     int waiting_for_pong;  // 1 if waiting for PONG response
-    time_t last_ping_time;  // When the last PING was sent
-    time_t last_pong_time;  // When the last PONG was received
+    int64_t last_ping_ms;  // When the last PING was sent
+    int64_t last_pong_ms;  // When the last PONG was received
+    unsigned int ping_sent_ms;  // Timestamp carried in the outstanding PING
+    int srtt_ms;  // Smoothed round-trip time (-1 until first sample)
+    int rttvar_ms;  // Round-trip time variation (jitter)
+    int heartbeat_interval;  // Seconds between PONG and next PING (adaptive)
+    int binary_mode;  // 1 if connection switched to binary framing (CAP_BINARY)
+    coro_wait_t pending_commands;  // Room commands queued on a room worker
+    atomic_ullong bytes_in;  // Bytes received from the socket
+    atomic_ullong bytes_out;  // Bytes sent to the socket
+    pthread_mutex_t send_lock;  // Held while writing to the socket, so lines and frames never interleave
+    struct bot_s *bot;  // Server-side bot behind this client (NULL for connections)
+    uint32_t peer_addr;  // Source IPv4 address for rate limits (network order, 0 = not limited)
 } client_t;
 
 /**
@@ -33,6 +58,19 @@ typedef struct {
  */
 void* client_handler_thread(void *arg);
 
+// Largest encoded message (binary frame or text line)
+#define CLIENT_WIRE_BUFFER_SIZE (MAX_MESSAGE_LENGTH * 2)
+
+/**
+ * Encode a message in the client's wire format (request ID tag, text line or binary frame)
+ * @param client Recipient
+ * @param message Message text
+ * @param out Output buffer (CLIENT_WIRE_BUFFER_SIZE bytes is always enough)
+ * @param size Output buffer size
+ * @return Encoded length, or -1 on error
+ */
+int client_encode_message(client_t *client, const char *message, unsigned char *out, size_t size);
+
 /**
  * Send a message to a client
  * @param client Client to send to
@@ -41,4 +79,34 @@ void* client_handler_thread(void *arg);
  */
 int client_send_message(client_t *client, const char *message);
 
+/**
+ * Send an encoded message without waiting for socket buffer space (PING thread,
+ * spectator fan-out); serialised with the client's other writes
+ * @param client Client to send to
+ * @param data Encoded message
+ * @param len Message length
+ * @param wait_for_lock 0 = give up if another thread is writing to the client
+ * @return 1 if sent, 0 if another write was in progress (nothing sent),
+ *         -1 if the message didn't fit or was sent only in part (close the connection)
+ */
+int client_send_nowait(client_t *client, const void *data, int len, int wait_for_lock);
+
+/**
+ * Send several messages at once (one io_uring submission when available)
+ * Messages for the same client must be adjacent to keep their order.
+ * @param clients Recipients
+ * @param messages Message for each recipient
+ * @param count Number of messages
+ * @return Number of messages delivered
+ */
+int client_send_batch(client_t **clients, const char **messages, int count);
+
+/**
+ * Execute a command on behalf of a client without a connection (bots), on the
+ * calling thread; room commands must be called on the room's worker
+ * @param client Client
+ * @param message Command as a client would send it
+ */
+void client_execute_command(client_t *client, const char *message);
+
 #endif /* CLIENT_HANDLER_H */
@@ -1,14 +1,143 @@
+#define LOG_MODULE LOG_MODULE_CLIENT
+
 #include "client_list.h"
+#include "admission.h"
 #include "logger.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/random.h>
 
 static client_t **client_array = NULL;
 static int max_clients = 0;
 static int client_count = 0;
 static pthread_mutex_t list_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Nickname and session token indexes: open addressing with linear probing, at most half full
+#define INDEX_KEY_SIZE (SESSION_TOKEN_LENGTH + 1)  // Fits nicknames (MAX_NICK_LENGTH) too
+
+typedef struct {
+    char key[INDEX_KEY_SIZE];
+    client_t *client;  // NULL = empty bucket
+} index_entry_t;
+
+typedef struct {
+    index_entry_t *entries;
+    unsigned int mask;  // Bucket count - 1 (power of two)
+} client_index_t;
+
+static client_index_t nick_index = { NULL, 0 };
+static client_index_t session_index = { NULL, 0 };
+static pthread_rwlock_t index_lock = PTHREAD_RWLOCK_INITIALIZER;  // Guards both indexes
+
+// FNV-1a
+static unsigned int index_hash(const char *key) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)key; *p != '\0'; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+static int index_alloc(client_index_t *index, unsigned int buckets) {
+    index->entries = (index_entry_t *)calloc(buckets, sizeof(index_entry_t));
+    index->mask = buckets - 1;
+    return index->entries != NULL ? 0 : -1;
+}
+
+static void index_free(client_index_t *index) {
+    free(index->entries);
+    index->entries = NULL;
+    index->mask = 0;
+}
+
+// Bucket holding the key, or the empty bucket ending its probe run (index_lock held)
+static unsigned int index_find_slot(client_index_t *index, const char *key) {
+    unsigned int slot = index_hash(key) & index->mask;
+    while (index->entries[slot].client != NULL && strcmp(index->entries[slot].key, key) != 0) {
+        slot = (slot + 1) & index->mask;
+    }
+    return slot;
+}
+
+// Empty a bucket and shift later entries of the probe run back (no tombstones, index_lock held)
+static void index_delete_slot(client_index_t *index, unsigned int slot) {
+    index_entry_t *entries = index->entries;
+    entries[slot].client = NULL;
+
+    unsigned int next = (slot + 1) & index->mask;
+    while (entries[next].client != NULL) {
+        unsigned int home = index_hash(entries[next].key) & index->mask;
+        // Move the entry if the hole lies cyclically between its home bucket and its position
+        if (((next - home) & index->mask) >= ((next - slot) & index->mask)) {
+            entries[slot] = entries[next];
+            entries[next].client = NULL;
+            slot = next;
+        }
+        next = (next + 1) & index->mask;
+    }
+}
+
+// Insert key -> client unless another client holds the key (index_lock held for writing)
+static int index_claim(client_index_t *index, const char *key, client_t *client) {
+    if (index->entries == NULL) {
+        return -1;
+    }
+
+    unsigned int slot = index_find_slot(index, key);
+    if (index->entries[slot].client != NULL && index->entries[slot].client != client) {
+        return -1;
+    }
+
+    snprintf(index->entries[slot].key, sizeof(index->entries[slot].key), "%s", key);
+    index->entries[slot].client = client;
+    return 0;
+}
+
+// Point the key's entry at another client if it belongs to from (index_lock held for writing)
+static void index_repoint(client_index_t *index, const char *key, client_t *from, client_t *to) {
+    if (index->entries == NULL || key[0] == '\0') {
+        return;
+    }
+
+    unsigned int slot = index_find_slot(index, key);
+    if (index->entries[slot].client == from) {
+        if (to != NULL) {
+            index->entries[slot].client = to;
+        } else {
+            index_delete_slot(index, slot);
+        }
+    }
+}
+
+static client_t *index_lookup(client_index_t *index, const char *key) {
+    if (key == NULL || key[0] == '\0') {
+        return NULL;
+    }
+
+    pthread_rwlock_rdlock(&index_lock);
+    client_t *client = NULL;
+    if (index->entries != NULL) {
+        client = index->entries[index_find_slot(index, key)].client;
+    }
+    if (client != NULL) {
+        // Indexed clients are in the list, whose reference keeps them alive while the lock is held
+        atomic_fetch_add(&client->refs, 1);
+    }
+    pthread_rwlock_unlock(&index_lock);
+    return client;
+}
+
+// Drop the client's nickname and session entries if it still owns them
+static void index_release(client_t *client) {
+    pthread_rwlock_wrlock(&index_lock);
+    index_repoint(&nick_index, client->nickname, client, NULL);
+    index_repoint(&session_index, client->session_token, client, NULL);
+    pthread_rwlock_unlock(&index_lock);
+}
+
 int client_list_init(int max) {
     pthread_mutex_lock(&list_mutex);
 
@@ -21,6 +150,26 @@ int client_list_init(int max) {
         return -1;
     }
 
+    // Keep the indexes at most half full
+    unsigned int buckets = 16;
+    while (buckets < (unsigned int)max_clients * 2) {
+        buckets <<= 1;
+    }
+
+    pthread_rwlock_wrlock(&index_lock);
+    int index_failed = index_alloc(&nick_index, buckets) != 0 || index_alloc(&session_index, buckets) != 0;
+    pthread_rwlock_unlock(&index_lock);
+
+    if (index_failed) {
+        logger_log(LOG_ERROR, "Failed to allocate client indexes");
+        index_free(&nick_index);
+        index_free(&session_index);
+        free(client_array);
+        client_array = NULL;
+        pthread_mutex_unlock(&list_mutex);
+        return -1;
+    }
+
     client_count = 0;
     logger_log(LOG_INFO, "Client list initialized (max: %d)", max_clients);
 
@@ -40,7 +189,7 @@ void client_list_shutdown(void) {
             if (client_array[i] != NULL) {
                 client_t *client = client_array[i];
 
-                logger_log(LOG_INFO, "Freeing client %d at index %d (socket_fd=%d, nickname='%s')",
+                logger_log(LOG_DEBUG, "Freeing client %d at index %d (socket_fd=%d, nickname='%s')",
                           client->client_id, i, client->socket_fd,
                           client->nickname[0] != '\0' ? client->nickname : "(no name)");
 
@@ -64,11 +213,12 @@ void client_list_shutdown(void) {
                     }
                 }
 
-                // Free the client structure
-                free(client);
+                // Drop the list's reference (a handler thread still running frees it on exit)
+                client->list_slot = -1;
+                client_list_release(client);
                 freed_count++;
 
-                logger_log(LOG_INFO, "Client freed successfully (%d/%d)", freed_count, client_count + freed_count);
+                logger_log(LOG_DEBUG, "Client freed successfully (%d/%d)", freed_count, client_count + freed_count);
             }
         }
 
@@ -79,6 +229,11 @@ void client_list_shutdown(void) {
         client_array = NULL;
     }
 
+    pthread_rwlock_wrlock(&index_lock);
+    index_free(&nick_index);
+    index_free(&session_index);
+    pthread_rwlock_unlock(&index_lock);
+
     max_clients = 0;
     client_count = 0;
 
@@ -107,8 +262,10 @@ int client_list_add(client_t *client) {
         if (client_array[i] == NULL) {
             // Found empty slot
             client_array[i] = client;
+            client->list_slot = i;
+            atomic_fetch_add(&client->refs, 1);
             client_count++;
-            logger_log(LOG_INFO, "Client %d added to list at index %d (total: %d)",
+            logger_log(LOG_DEBUG, "Client %d added to list at index %d (total: %d)",
                       client->client_id, i, client_count);
             pthread_mutex_unlock(&list_mutex);
             return 0;
@@ -130,11 +287,15 @@ int client_list_add(client_t *client) {
         client_array[zombie_slot] = NULL;
         // Note: client_count stays same (removing and adding = no change)
 
-        // Free the zombie memory
-        free(zombie);
+        // Drop the zombie (its nickname becomes available again, its session ends)
+        index_release(zombie);
+        zombie->list_slot = -1;
+        client_list_release(zombie);
 
         // Now add new client to the slot
         client_array[zombie_slot] = client;
+        client->list_slot = zombie_slot;
+        atomic_fetch_add(&client->refs, 1);
         logger_log(LOG_INFO, "Client %d added to list at index %d (replaced zombie, total: %d)",
                   client->client_id, zombie_slot, client_count);
         pthread_mutex_unlock(&list_mutex);
@@ -146,8 +307,8 @@ int client_list_add(client_t *client) {
     return -1;
 }
 
-void client_list_remove(client_t *client) {
-    if (client == NULL) return;
+int client_list_remove(client_t *client) {
+    if (client == NULL) return -1;
 
     pthread_mutex_lock(&list_mutex);
 
@@ -157,11 +318,14 @@ void client_list_remove(client_t *client) {
             client_array[i] = NULL;
             client_count--;
             removed_count++;
-            logger_log(LOG_INFO, "Client %d removed from list at index %d (total: %d)",
+            client->list_slot = -1;
+            logger_log(LOG_DEBUG, "Client %d removed from list at index %d (total: %d)",
                       client->client_id, i, client_count);
         }
     }
 
+    index_release(client);
+
     if (removed_count == 0) {
         logger_log(LOG_WARNING, "Client %d not found in list during removal", client->client_id);
     } else if (removed_count > 1) {
@@ -169,47 +333,58 @@ void client_list_remove(client_t *client) {
     }
 
     pthread_mutex_unlock(&list_mutex);
+
+    if (removed_count == 0) {
+        return -1;
+    }
+    admission_slot_freed();
+    for (int i = 0; i < removed_count; i++) {
+        client_list_release(client);
+    }
+    return 0;
 }
 
-void client_list_replace(client_t *old_client, client_t *new_client) {
-    if (old_client == NULL || new_client == NULL) return;
+int client_list_replace(client_t *old_client, client_t *new_client) {
+    if (old_client == NULL || new_client == NULL) return -1;
 
     pthread_mutex_lock(&list_mutex);
 
-    int old_client_index = -1;
-    int new_client_index = -1;
-
-    // Find both old and new client positions
-    for (int i = 0; i < max_clients; i++) {
-        if (client_array[i] == old_client) {
-            old_client_index = i;
-        }
-        if (client_array[i] == new_client) {
-            new_client_index = i;
-        }
-    }
-
-    if (old_client_index == -1) {
+    // Both positions come from the slot hints, no scan
+    int old_client_index = old_client->list_slot;
+    if (old_client_index < 0 || client_array[old_client_index] != old_client) {
         logger_log(LOG_WARNING, "Client %d (old) not found for replacement",
                   old_client->client_id);
         pthread_mutex_unlock(&list_mutex);
-        return;
+        return -1;
     }
 
-    // If new_client is already in list (was added before RECONNECT), remove it first
-    if (new_client_index != -1) {
+    // If new_client is already in list (was added before RECONNECT), its reference moves to the old slot
+    int new_client_index = new_client->list_slot;
+    if (new_client_index >= 0 && client_array[new_client_index] == new_client) {
         logger_log(LOG_INFO, "Client %d (new) already in list at index %d, removing before replace",
                   new_client->client_id, new_client_index);
         client_array[new_client_index] = NULL;
         client_count--;
+    } else {
+        atomic_fetch_add(&new_client->refs, 1);
     }
 
-    // Replace old client with new client
+    // Replace old client with new client (nickname and session entries follow the seat)
     client_array[old_client_index] = new_client;
+    new_client->list_slot = old_client_index;
+    old_client->list_slot = -1;
+
+    pthread_rwlock_wrlock(&index_lock);
+    index_repoint(&nick_index, old_client->nickname, old_client, new_client);
+    index_repoint(&session_index, old_client->session_token, old_client, new_client);
+    pthread_rwlock_unlock(&index_lock);
     logger_log(LOG_INFO, "Client %d replaced in list at index %d (reconnect, same ID)",
               new_client->client_id, old_client_index);
 
     pthread_mutex_unlock(&list_mutex);
+
+    client_list_release(old_client);
+    return 0;
 }
 
 int client_list_get_all(client_t **clients, int max_count) {
@@ -220,6 +395,7 @@ int client_list_get_all(client_t **clients, int max_count) {
     int count = 0;
     for (int i = 0; i < max_clients && count < max_count; i++) {
         if (client_array[i] != NULL) {
+            atomic_fetch_add(&client_array[i]->refs, 1);
             clients[count++] = client_array[i];
         }
     }
@@ -235,6 +411,7 @@ client_t* client_list_find_by_id(int client_id) {
         if (client_array[i] != NULL &&
             client_array[i]->client_id == client_id) {
             client_t *client = client_array[i];
+            atomic_fetch_add(&client->refs, 1);
             pthread_mutex_unlock(&list_mutex);
             return client;
         }
@@ -243,3 +420,65 @@ client_t* client_list_find_by_id(int client_id) {
     pthread_mutex_unlock(&list_mutex);
     return NULL;
 }
+
+int client_list_claim_nickname(client_t *client, const char *nickname) {
+    if (client == NULL || nickname == NULL || nickname[0] == '\0') return -1;
+
+    pthread_rwlock_wrlock(&index_lock);
+    int result = index_claim(&nick_index, nickname, client);
+    pthread_rwlock_unlock(&index_lock);
+    return result;
+}
+
+void client_list_release_identity(client_t *client) {
+    if (client == NULL) return;
+    index_release(client);
+}
+
+client_t* client_list_find_by_nickname(const char *nickname) {
+    return index_lookup(&nick_index, nickname);
+}
+
+int client_list_open_session(client_t *client) {
+    if (client == NULL) return -1;
+
+    static const char hex[] = "0123456789abcdef";
+    unsigned char random_bytes[SESSION_TOKEN_LENGTH / 2];
+
+    // A collision of 128 random bits is practically impossible, retry anyway
+    for (int attempt = 0; attempt < 4; attempt++) {
+        if (getrandom(random_bytes, sizeof(random_bytes), 0) != (ssize_t)sizeof(random_bytes)) {
+            logger_log(LOG_ERROR, "Client %d: Cannot read random bytes for session token: %s",
+                      client->client_id, strerror(errno));
+            return -1;
+        }
+
+        char token[SESSION_TOKEN_LENGTH + 1];
+        for (size_t i = 0; i < sizeof(random_bytes); i++) {
+            token[2 * i] = hex[random_bytes[i] >> 4];
+            token[2 * i + 1] = hex[random_bytes[i] & 0x0f];
+        }
+        token[SESSION_TOKEN_LENGTH] = '\0';
+
+        pthread_rwlock_wrlock(&index_lock);
+        int result = index_claim(&session_index, token, client);
+        pthread_rwlock_unlock(&index_lock);
+
+        if (result == 0) {
+            memcpy(client->session_token, token, sizeof(token));
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+client_t* client_list_find_by_session(const char *token) {
+    return index_lookup(&session_index, token);
+}
+
+void client_list_release(client_t *client) {
+    if (client != NULL && atomic_fetch_sub(&client->refs, 1) == 1) {
+        free(client);
+    }
+}
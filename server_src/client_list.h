@@ -6,6 +6,17 @@
 
 /**
  * Client list module - tracks all connected clients for PING/timeout management
+ *
+ * Also keeps nickname and session token indexes (hash tables under their own
+ * rwlock) so uniqueness checks and RECONNECT lookups don't scan the list. An
+ * entry lives from HELLO until the client leaves the list, follows the seat on
+ * reconnect, and keeps the nickname reserved while a disconnected player can
+ * still come back.
+ *
+ * Clients are reference counted: the handler thread, the list while the client
+ * is in it, and every pointer handed out by client_list_get_all() and the find
+ * functions each hold one, so a client looked up on one thread stays valid while
+ * another takes it out of the list. Drop them with client_list_release().
  */
 
 /**
@@ -30,18 +41,28 @@ int client_list_add(client_t *client);
 /**
  * Remove a client from the list
  * @param client Client to remove
+ * @return 0 on success, -1 if the client wasn't in the list
  */
-void client_list_remove(client_t *client);
+int client_list_remove(client_t *client);
 
 /**
  * Replace old client with new client in-place (for reconnection)
+ * Exactly one of this and client_list_remove() succeeds for a client, so a
+ * reconnect and a session expiry can't both take the seat.
  * @param old_client Client to replace
  * @param new_client Client to put in place of old one
+ * @return 0 on success, -1 if the old client is no longer in the list
  */
-void client_list_replace(client_t *old_client, client_t *new_client);
+int client_list_replace(client_t *old_client, client_t *new_client);
 
 /**
- * Get all active clients
+ * Drop a reference to a client, the last one frees it
+ * @param client Client (NULL is ignored)
+ */
+void client_list_release(client_t *client);
+
+/**
+ * Get all active clients (each one referenced, release them when done)
  * @param clients Output array (must be allocated by caller)
  * @param max_count Size of output array
  * @return Number of clients copied
@@ -51,8 +72,43 @@ int client_list_get_all(client_t **clients, int max_count);
 /**
  * Find client by ID
  * @param client_id Client ID to search for
- * @return Client pointer or NULL if not found
+ * @return Referenced client pointer (release it), or NULL if not found
  */
 client_t* client_list_find_by_id(int client_id);
 
+/**
+ * Register the client's nickname in the index
+ * @param client Client claiming the nickname
+ * @param nickname Nickname to claim
+ * @return 0 on success, -1 if another client holds it
+ */
+int client_list_claim_nickname(client_t *client, const char *nickname);
+
+/**
+ * Drop the client's nickname and session token from the indexes (no-op if it holds none)
+ * @param client Client giving up its identity
+ */
+void client_list_release_identity(client_t *client);
+
+/**
+ * Find client by nickname
+ * @param nickname Nickname to look up
+ * @return Referenced client pointer (release it), or NULL if not found
+ */
+client_t* client_list_find_by_nickname(const char *nickname);
+
+/**
+ * Issue a random session token (client->session_token) and index it
+ * @param client Client starting its session
+ * @return 0 on success, -1 on error
+ */
+int client_list_open_session(client_t *client);
+
+/**
+ * Find client by session token
+ * @param token Token issued in WELCOME
+ * @return Referenced client pointer (release it), or NULL if not found
+ */
+client_t* client_list_find_by_session(const char *token);
+
 #endif /* CLIENT_LIST_H */
@@ -0,0 +1,92 @@
+#include "clock.h"
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+static atomic_int virtual_mode = 0;
+static _Atomic int64_t virtual_now_ms = 0;
+static pthread_mutex_t virtual_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t virtual_advanced = PTHREAD_COND_INITIALIZER;
+static int64_t sleeper_deadlines[CLOCK_MAX_SLEEPERS];  // 0 = free slot (guarded by virtual_mutex)
+
+int64_t clock_now_ms(void) {
+    if (atomic_load_explicit(&virtual_mode, memory_order_relaxed)) {
+        return atomic_load_explicit(&virtual_now_ms, memory_order_acquire);
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void clock_set_virtual(int64_t start_ms) {
+    atomic_store(&virtual_now_ms, start_ms);
+    atomic_store(&virtual_mode, 1);
+}
+
+int clock_is_virtual(void) {
+    return atomic_load(&virtual_mode);
+}
+
+void clock_advance_ms(int64_t delta_ms) {
+    if (!clock_is_virtual()) {
+        return;
+    }
+
+    pthread_mutex_lock(&virtual_mutex);
+    atomic_fetch_add_explicit(&virtual_now_ms, delta_ms, memory_order_release);
+    pthread_cond_broadcast(&virtual_advanced);
+    pthread_mutex_unlock(&virtual_mutex);
+}
+
+void clock_sleep_ms(int64_t duration_ms) {
+    if (!clock_is_virtual()) {
+        struct timespec ts = { duration_ms / 1000, (duration_ms % 1000) * 1000000 };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+            // Resume after signals (SIGHUP reload) with the remaining time
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&virtual_mutex);
+    int64_t deadline = clock_now_ms() + duration_ms;
+
+    // Register the deadline so clock_wait_sleepers() can tell when this thread is idle
+    int slot = -1;
+    for (int i = 0; i < CLOCK_MAX_SLEEPERS && slot < 0; i++) {
+        if (sleeper_deadlines[i] == 0) {
+            slot = i;
+            sleeper_deadlines[i] = deadline;
+        }
+    }
+
+    while (clock_now_ms() < deadline) {
+        pthread_cond_wait(&virtual_advanced, &virtual_mutex);
+    }
+
+    if (slot >= 0) {
+        sleeper_deadlines[slot] = 0;
+    }
+    pthread_mutex_unlock(&virtual_mutex);
+}
+
+int clock_wait_sleepers(int threads, int timeout_ms) {
+    for (int waited_us = 0; waited_us < timeout_ms * 1000; waited_us += 100) {
+        pthread_mutex_lock(&virtual_mutex);
+        int64_t now = clock_now_ms();
+        int sleeping = 0;
+        for (int i = 0; i < CLOCK_MAX_SLEEPERS; i++) {
+            sleeping += sleeper_deadlines[i] > now;
+        }
+        pthread_mutex_unlock(&virtual_mutex);
+
+        if (sleeping >= threads) {
+            return 0;
+        }
+
+        struct timespec ts = { 0, 100000 };
+        nanosleep(&ts, NULL);
+    }
+    return -1;
+}
@@ -0,0 +1,57 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+/**
+ * Clock module - monotonic millisecond time for timeouts and deadlines
+ *
+ * Real mode reads CLOCK_MONOTONIC_COARSE (the kernel's per-tick cached time,
+ * read through the vDSO without a syscall), so NTP steps of the wall clock
+ * cannot fire PONG or reconnect timeouts. Virtual mode freezes time until
+ * clock_advance_ms() moves it, for tests and simulation.
+ */
+
+#define CLOCK_MS(seconds) ((int64_t)(seconds) * 1000)
+#define CLOCK_MAX_SLEEPERS 16   // Threads that can sleep on virtual time at once
+
+/**
+ * Current monotonic time
+ * @return Milliseconds (only differences are meaningful)
+ */
+int64_t clock_now_ms(void);
+
+/**
+ * Switch to virtual time (call before any thread uses the clock)
+ * @param start_ms Initial virtual time
+ */
+void clock_set_virtual(int64_t start_ms);
+
+/**
+ * Check if virtual time is active
+ * @return 1 in virtual mode, 0 otherwise
+ */
+int clock_is_virtual(void);
+
+/**
+ * Move virtual time forward and wake threads whose sleep has elapsed
+ * @param delta_ms Milliseconds to advance (ignored in real mode)
+ */
+void clock_advance_ms(int64_t delta_ms);
+
+/**
+ * Sleep on the active clock (virtual sleeps end when time is advanced past them)
+ * @param duration_ms Milliseconds to sleep
+ */
+void clock_sleep_ms(int64_t duration_ms);
+
+/**
+ * Wait until the given number of threads sleep on virtual time with a deadline
+ * still ahead, i.e. every thread woken by the last advance has finished its work
+ * @param threads Number of sleeping threads to wait for
+ * @param timeout_ms Real-time limit
+ * @return 0 when settled, -1 on timeout
+ */
+int clock_wait_sleepers(int threads, int timeout_ms);
+
+#endif /* CLOCK_H */
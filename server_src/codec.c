@@ -0,0 +1,294 @@
+#include "codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define FIELD_INT 0
+#define FIELD_STRING 1
+#define FIELD_COMMAND 2
+
+#define OPCODE_REQUEST_ID 0  // Body prefix: 0x00 <varint id> before the real opcode
+
+// Opcode table - opcode is index + 1 (0 is never a valid opcode).
+// Append only: reordering breaks compatibility with deployed clients.
+static const char *opcodes[] = {
+    CMD_HELLO, CMD_LIST_ROOMS, CMD_CREATE_ROOM, CMD_JOIN_ROOM, CMD_LEAVE_ROOM,
+    CMD_READY, CMD_START_GAME, CMD_FLIP, CMD_PONG, CMD_RECONNECT,
+    CMD_WELCOME, CMD_ROOM_LIST, CMD_ROOM_CREATED, CMD_ROOM_JOINED, CMD_PLAYER_JOINED,
+    CMD_PLAYER_LEFT, CMD_PLAYER_READY, CMD_PLAYER_RECONNECTED, CMD_PLAYER_DISCONNECTED,
+    CMD_ROOM_OWNER_CHANGED, CMD_GAME_CREATED, CMD_GAME_START, CMD_GAME_STATE, CMD_GAME_END,
+    CMD_GAME_END_FORFEIT, CMD_YOUR_TURN, CMD_CARD_REVEAL, CMD_MATCH, CMD_MISMATCH,
+    CMD_LEFT_ROOM, CMD_PING, CMD_SERVER_SHUTDOWN, CMD_ERROR, CMD_SEQ,
+    "READY_OK", "ROOM_CLOSED", CMD_QUICK_MATCH, CMD_QUICK_MATCH_WAITING, CMD_QUICK_MATCH_CANCELLED,
+    CMD_SPECTATE, CMD_SPECTATING, CMD_TURN_TIMEOUT, CMD_ADD_BOT,
+    CMD_LEADERBOARD, CMD_QUEUE_POSITION
+};
+
+#define OPCODE_COUNT ((int)(sizeof(opcodes) / sizeof(opcodes[0])))
+
+static int find_opcode(const char *token, int len) {
+    for (int i = 0; i < OPCODE_COUNT; i++) {
+        if ((int)strlen(opcodes[i]) == len && strncmp(opcodes[i], token, len) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Integer token in canonical form only (so decode reproduces the exact text)
+static int parse_int_token(const char *token, int len, int *value) {
+    int pos = 0;
+    int negative = 0;
+
+    if (len > 0 && token[0] == '-') {
+        negative = 1;
+        pos = 1;
+    }
+    if (pos >= len || len - pos > 10) {
+        return 0;
+    }
+    if (token[pos] == '0' && (len - pos > 1 || negative)) {
+        return 0;  // Leading zero or "-0"
+    }
+
+    long long v = 0;
+    for (int i = pos; i < len; i++) {
+        if (token[i] < '0' || token[i] > '9') {
+            return 0;
+        }
+        v = v * 10 + (token[i] - '0');
+    }
+    if (negative) {
+        v = -v;
+    }
+    if (v < INT_MIN || v > INT_MAX) {
+        return 0;
+    }
+
+    *value = (int)v;
+    return 1;
+}
+
+static int put_varint(unsigned char *out, int out_size, int pos, unsigned int value) {
+    do {
+        if (pos >= out_size) {
+            return -1;
+        }
+        unsigned char byte = value & 0x7F;
+        value >>= 7;
+        out[pos++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return pos;
+}
+
+static int get_varint(const unsigned char *in, int in_len, int pos, unsigned int *value) {
+    unsigned int result = 0;
+    int shift = 0;
+
+    while (pos < in_len && shift < 7 * CODEC_MAX_VARINT_BYTES) {
+        unsigned char byte = in[pos++];
+        result |= (unsigned int)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return pos;
+        }
+        shift += 7;
+    }
+    return -1;
+}
+
+int codec_encode_frame(const char *message, unsigned char *out, int out_size) {
+    if (message == NULL || out == NULL) {
+        return -1;
+    }
+
+    unsigned char body[CODEC_MAX_FRAME_SIZE];
+    int pos = 0;
+
+    const char *token = message;
+    const char *end = strchr(token, ' ');
+    int len = end ? (int)(end - token) : (int)strlen(token);
+
+    // Optional request ID prefix (#<id>)
+    int prefix_len = (int)strlen(REQUEST_ID_PREFIX);
+    if (end != NULL && len > prefix_len && strncmp(token, REQUEST_ID_PREFIX, prefix_len) == 0) {
+        int id;
+        if (!parse_int_token(token + prefix_len, len - prefix_len, &id) || id <= 0) {
+            return -1;
+        }
+        body[pos++] = OPCODE_REQUEST_ID;
+        pos = put_varint(body, sizeof(body), pos, (unsigned int)id);
+
+        token = end + 1;
+        end = strchr(token, ' ');
+        len = end ? (int)(end - token) : (int)strlen(token);
+    }
+
+    // First token is the command
+    int opcode = find_opcode(token, len);
+
+    if (opcode == 0) {
+        return -1;  // Unknown command cannot be framed
+    }
+    body[pos++] = (unsigned char)opcode;
+
+    // Remaining tokens become typed fields
+    while (end != NULL) {
+        token = end + 1;
+        end = strchr(token, ' ');
+        len = end ? (int)(end - token) : (int)strlen(token);
+
+        int int_value;
+        int command = 0;
+        unsigned int zigzag = 0;
+        int is_int = parse_int_token(token, len, &int_value);
+
+        if (is_int) {
+            zigzag = ((unsigned int)int_value << 1) ^ (unsigned int)(int_value >> 31);
+            is_int = (zigzag <= (UINT_MAX >> 2));  // Must fit next to the tag
+        }
+        if (!is_int) {
+            command = find_opcode(token, len);
+        }
+
+        if (is_int) {
+            pos = put_varint(body, sizeof(body), pos, (zigzag << 2) | FIELD_INT);
+        } else if (command != 0) {
+            pos = put_varint(body, sizeof(body), pos, ((unsigned int)command << 2) | FIELD_COMMAND);
+        } else {
+            pos = put_varint(body, sizeof(body), pos, ((unsigned int)len << 2) | FIELD_STRING);
+            if (pos < 0 || pos + len > (int)sizeof(body)) {
+                return -1;
+            }
+            memcpy(body + pos, token, len);
+            pos += len;
+        }
+
+        if (pos < 0) {
+            return -1;
+        }
+    }
+
+    // Length prefix + body
+    int frame_len = put_varint(out, out_size, 0, (unsigned int)pos);
+    if (frame_len < 0 || frame_len + pos > out_size) {
+        return -1;
+    }
+    memcpy(out + frame_len, body, pos);
+    return frame_len + pos;
+}
+
+int codec_decode_body(const unsigned char *body, int body_len, char *out, int out_size) {
+    if (body == NULL || out == NULL || body_len < 1 || out_size < 1) {
+        return -1;
+    }
+
+    int offset = 0;
+    int pos = 0;
+
+    // Optional request ID prefix
+    if (body[pos] == OPCODE_REQUEST_ID) {
+        unsigned int id;
+        pos = get_varint(body, body_len, pos + 1, &id);
+        if (pos < 0 || pos >= body_len) {
+            return -1;
+        }
+        offset = snprintf(out, out_size, "%s%u ", REQUEST_ID_PREFIX, id);
+    }
+
+    int opcode = body[pos++];
+    if (opcode < 1 || opcode > OPCODE_COUNT) {
+        return -1;
+    }
+
+    offset += snprintf(out + offset, out_size - offset, "%s", opcodes[opcode - 1]);
+
+    while (pos < body_len) {
+        unsigned int field;
+        pos = get_varint(body, body_len, pos, &field);
+        if (pos < 0) {
+            return -1;
+        }
+
+        unsigned int tag = field & 0x3;
+        unsigned int value = field >> 2;
+
+        if (tag == FIELD_INT) {
+            int v = (int)((value >> 1) ^ -(int)(value & 1));
+            offset += snprintf(out + offset, out_size - offset, " %d", v);
+        } else if (tag == FIELD_STRING) {
+            if (value > (unsigned int)(body_len - pos)) {
+                return -1;
+            }
+            offset += snprintf(out + offset, out_size - offset, " %.*s", (int)value, body + pos);
+            pos += value;
+        } else if (tag == FIELD_COMMAND) {
+            if (value < 1 || value > (unsigned int)OPCODE_COUNT) {
+                return -1;
+            }
+            offset += snprintf(out + offset, out_size - offset, " %s", opcodes[value - 1]);
+        } else {
+            return -1;
+        }
+
+        if (offset >= out_size) {
+            return -1;  // Decoded message too long
+        }
+    }
+
+    return offset;
+}
+
+int codec_decode_ints(const unsigned char *body, int body_len, codec_frame_t *frame) {
+    if (body == NULL || frame == NULL || body_len < 1) {
+        return -1;
+    }
+
+    int pos = 0;
+    frame->request_id = 0;
+    frame->field_count = 0;
+
+    if (body[pos] == OPCODE_REQUEST_ID) {
+        pos = get_varint(body, body_len, pos + 1, &frame->request_id);
+        if (pos < 0 || pos >= body_len) {
+            return -1;
+        }
+        if (frame->request_id == 0) {
+            return 0;  // The text path rejects it like "#0"
+        }
+    }
+
+    int opcode = body[pos++];
+    if (opcode < 1 || opcode > OPCODE_COUNT) {
+        return -1;
+    }
+    frame->command = opcodes[opcode - 1];
+
+    while (pos < body_len) {
+        unsigned int field;
+        pos = get_varint(body, body_len, pos, &field);
+        if (pos < 0) {
+            return -1;
+        }
+        if ((field & 0x3) != FIELD_INT || frame->field_count == CODEC_MAX_INT_FIELDS) {
+            return 0;
+        }
+
+        unsigned int value = field >> 2;
+        frame->fields[frame->field_count++] = (int)((value >> 1) ^ -(int)(value & 1));
+    }
+
+    return 1;
+}
+
+int codec_feed_length(unsigned char byte, unsigned int *length, int *shift) {
+    if (*shift >= 7 * CODEC_MAX_VARINT_BYTES) {
+        return -1;
+    }
+
+    *length |= (unsigned int)(byte & 0x7F) << *shift;
+    *shift += 7;
+
+    return (byte & 0x80) ? 0 : 1;
+}
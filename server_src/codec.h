@@ -0,0 +1,74 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include "protocol.h"
+
+/**
+ * Codec module - compact binary framing negotiated via HELLO/RECONNECT capability
+ *
+ * Frame:  <varint body_length> <body>
+ * Body:   [0x00 <varint request_id>] <opcode:1 byte> <field>*
+ * Field:  varint (value << 2 | tag)
+ *           tag 0 = integer (zigzag encoded value)
+ *           tag 1 = string  (value = byte length, followed by the bytes)
+ *           tag 2 = command (value = opcode of a protocol.h command, e.g. inside SEQ)
+ *
+ * A binary frame carries exactly the tokens of the equivalent text message.
+ * Frames with integer fields only can be decoded in place into a codec_frame_t
+ * (used for the hot FLIP and PONG); the rest are transcoded to text at the
+ * socket edge, so their handlers stay unchanged.
+ */
+
+#define CODEC_MAX_VARINT_BYTES 5
+#define CODEC_MAX_FRAME_SIZE (MAX_MESSAGE_LENGTH * 2)
+#define CODEC_MAX_INT_FIELDS 4
+
+/**
+ * Frame decoded without a text round trip: command and integer fields by position
+ */
+typedef struct {
+    unsigned int request_id;  // 0 = no request ID
+    const char *command;      // protocol.h command of the opcode
+    int field_count;
+    int fields[CODEC_MAX_INT_FIELDS];
+} codec_frame_t;
+
+/**
+ * Encode a text protocol message as a binary frame
+ * @param message Text message (without trailing newline)
+ * @param out Output buffer
+ * @param out_size Output buffer size
+ * @return Frame length in bytes, or -1 if the buffer is too small
+ */
+int codec_encode_frame(const char *message, unsigned char *out, int out_size);
+
+/**
+ * Decode a binary frame body (without the length prefix) to a text message
+ * @param body Frame body
+ * @param body_len Body length
+ * @param out Output buffer for text message
+ * @param out_size Output buffer size
+ * @return Text length, or -1 on malformed frame
+ */
+int codec_decode_body(const unsigned char *body, int body_len, char *out, int out_size);
+
+/**
+ * Decode a frame body (without the length prefix) whose fields are all integers
+ * @param body Frame body
+ * @param body_len Body length
+ * @param frame Output
+ * @return 1 if decoded, 0 if the frame has other fields or more than
+ *         CODEC_MAX_INT_FIELDS (decode it with codec_decode_body), -1 on malformed frame
+ */
+int codec_decode_ints(const unsigned char *body, int body_len, codec_frame_t *frame);
+
+/**
+ * Feed one byte of a frame length prefix
+ * @param byte Received byte
+ * @param length In/out accumulated length
+ * @param shift In/out accumulated bit shift (start with 0)
+ * @return 1 when the length is complete, 0 if more bytes are needed, -1 on overflow
+ */
+int codec_feed_length(unsigned char byte, unsigned int *length, int *shift);
+
+#endif /* CODEC_H */
@@ -0,0 +1,353 @@
+#include "config.h"
+#include "protocol.h"
+#include "worker_pool.h"
+#include "coro.h"
+#include "eventlog.h"
+#include "stats.h"
+#include "admission.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <signal.h>
+
+#define CONFIG_MAX_LINE 256
+
+typedef struct {
+    const char *name;       // Key in the config file, --name on the command line
+    size_t offset;          // Field in runtime_config_t
+    int min_value;
+    int max_value;
+    int reloadable;
+    const char *description;
+    int is_string;          // char array field, max_value is its size
+} config_option_t;
+
+#define OPTION(field, min, max, reload, text) \
+    { #field, offsetof(runtime_config_t, field), min, max, reload, text, 0 }
+#define OPTION_STRING(field, reload, text) \
+    { #field, offsetof(runtime_config_t, field), 0, sizeof(((runtime_config_t *)0)->field), reload, text, 1 }
+
+static const config_option_t options[] = {
+    OPTION(pong_timeout, 1, 3600, 1, "Seconds to wait for PONG"),
+    OPTION(pong_wait_interval, 1, 3600, 1, "Seconds between PONG and next PING"),
+    OPTION(pong_wait_interval_max, 1, 3600, 1, "Longest adaptive heartbeat interval"),
+    OPTION(reconnect_timeout, 1, 86400, 1, "Seconds a dropped player's seat is kept"),
+    OPTION(inactivity_timeout, 1, 86400, 1, "Seconds of silence before disconnect"),
+    OPTION(max_error_count, 1, 1000, 1, "Invalid messages before disconnect"),
+    OPTION(turn_timeout, 0, TURN_TIMEOUT_MAX, 1, "Default seconds per turn (0 = unlimited)"),
+    OPTION(conn_rate, 0, 100000, 1, "New connections per second per IP (0 = unlimited)"),
+    OPTION(conn_burst, 1, 100000, 1, "Connections an IP may open at once"),
+    OPTION(msg_rate, 0, 100000, 1, "Messages per second per IP (0 = unlimited)"),
+    OPTION(msg_burst, 1, 100000, 1, "Messages an IP may send at once"),
+    OPTION_STRING(log_level, 1, "Log levels, e.g. info or warning,room=debug"),
+    OPTION(listen_backlog, 1, 65535, 0, "listen() backlog"),
+    OPTION_STRING(unix_socket, 0, "Unix socket path for local clients (empty = disabled)"),
+    OPTION(admission_queue, 0, 100000, 0, "Connections waiting for a slot when full (0 = close them)"),
+    OPTION(thread_stack_kb, 0, 65536, 0, "Handler thread stack in KB (0 = default)"),
+    OPTION(worker_threads, 0, 256, 0, "Room worker threads (0 = inline)"),
+    OPTION(coroutines, 0, 1, 0, "Run client handlers as coroutines"),
+    OPTION(coro_schedulers, 1, 256, 0, "Coroutine scheduler threads"),
+    OPTION(coro_stack_kb, 16, 8192, 0, "Coroutine stack in KB"),
+    OPTION_STRING(admin_socket, 0, "Admin socket path (empty = disabled)"),
+    OPTION_STRING(event_log, 0, "Binary event log segment prefix (empty = disabled)"),
+    OPTION(event_log_segment_kb, 64, 1048576, 0, "Event log segment size in KB"),
+    OPTION_STRING(stats_file, 0, "Player statistics file (empty = memory only)"),
+    OPTION(bench_games, 0, 100000000, 0, "Play N bot-only games, print throughput and exit"),
+};
+
+#define OPTION_COUNT (int)(sizeof(options) / sizeof(options[0]))
+
+static runtime_config_t current_config;
+static const char *config_path = NULL;
+static int saved_argc = 0;
+static char **saved_argv = NULL;
+static volatile sig_atomic_t reload_requested = 0;
+
+static void set_defaults(runtime_config_t *config) {
+    config->pong_timeout = PONG_TIMEOUT;
+    config->pong_wait_interval = PONG_WAIT_INTERVAL;
+    config->pong_wait_interval_max = PONG_WAIT_INTERVAL_MAX;
+    config->reconnect_timeout = RECONNECT_TIMEOUT;
+    config->inactivity_timeout = DEFAULT_INACTIVITY_TIMEOUT;
+    config->max_error_count = MAX_ERROR_COUNT;
+    config->turn_timeout = DEFAULT_TURN_TIMEOUT;
+    config->conn_rate = DEFAULT_CONN_RATE;
+    config->conn_burst = DEFAULT_CONN_BURST;
+    config->msg_rate = DEFAULT_MSG_RATE;
+    config->msg_burst = DEFAULT_MSG_BURST;
+    snprintf(config->log_level, sizeof(config->log_level), "%s", DEFAULT_LOG_LEVEL);
+    config->listen_backlog = DEFAULT_LISTEN_BACKLOG;
+    config->unix_socket[0] = '\0';
+    config->admission_queue = DEFAULT_ADMISSION_QUEUE;
+    config->thread_stack_kb = DEFAULT_THREAD_STACK_KB;
+    config->worker_threads = WORKER_THREADS;
+    config->coroutines = USE_COROUTINES;
+    config->coro_schedulers = CORO_SCHEDULER_THREADS;
+    config->coro_stack_kb = CORO_STACK_SIZE / 1024;
+    snprintf(config->admin_socket, sizeof(config->admin_socket), "%s", DEFAULT_ADMIN_SOCKET);
+    config->event_log[0] = '\0';
+    config->event_log_segment_kb = DEFAULT_EVENT_LOG_SEGMENT_KB;
+    snprintf(config->stats_file, sizeof(config->stats_file), "%s", DEFAULT_STATS_FILE);
+    config->bench_games = 0;
+}
+
+static const config_option_t* find_option(const char *name) {
+    for (int i = 0; i < OPTION_COUNT; i++) {
+        if (strcmp(options[i].name, name) == 0) {
+            return &options[i];
+        }
+    }
+    return NULL;
+}
+
+// Parse and range-check one value
+static int set_option(runtime_config_t *config, const char *name, const char *value) {
+    const config_option_t *option = find_option(name);
+    if (option == NULL) {
+        fprintf(stderr, "Error: Unknown option '%s'\n", name);
+        return -1;
+    }
+
+    if (option->is_string) {
+        if (strlen(value) >= (size_t)option->max_value) {
+            fprintf(stderr, "Error: Value for %s too long (max %d characters)\n", name, option->max_value - 1);
+            return -1;
+        }
+        strcpy((char *)config + option->offset, value);
+        return 0;
+    }
+
+    char *endptr;
+    long parsed = strtol(value, &endptr, 10);
+    if (*value == '\0' || *endptr != '\0' || parsed < option->min_value || parsed > option->max_value) {
+        fprintf(stderr, "Error: Invalid value '%s' for %s (allowed %d-%d)\n",
+                value, name, option->min_value, option->max_value);
+        return -1;
+    }
+
+    *(int *)((char *)config + option->offset) = (int)parsed;
+    return 0;
+}
+
+static char* trim(char *text) {
+    while (isspace((unsigned char)*text)) {
+        text++;
+    }
+    char *end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+// Read key = value lines; # starts a comment
+static int load_file(runtime_config_t *config, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open config file '%s'\n", path);
+        return -1;
+    }
+
+    char line[CONFIG_MAX_LINE];
+    int line_number = 0;
+    int result = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+
+        char *key = trim(line);
+        if (*key == '\0') {
+            continue;
+        }
+
+        char *equals = strchr(key, '=');
+        if (equals == NULL) {
+            fprintf(stderr, "Error: %s:%d: expected key = value\n", path, line_number);
+            result = -1;
+            continue;
+        }
+        *equals = '\0';
+
+        if (set_option(config, trim(key), trim(equals + 1)) != 0) {
+            fprintf(stderr, "       (%s:%d)\n", path, line_number);
+            result = -1;
+        }
+    }
+
+    fclose(file);
+    return result;
+}
+
+// Apply --name value flags (--name=value also accepted); --config is handled by the caller
+static int apply_flags(runtime_config_t *config, int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            continue;
+        }
+
+        char name[64];
+        const char *value;
+        const char *equals = strchr(argv[i], '=');
+        if (equals != NULL) {
+            snprintf(name, sizeof(name), "%.*s", (int)(equals - argv[i] - 2), argv[i] + 2);
+            value = equals + 1;
+        } else {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Missing value for %s\n", argv[i]);
+                return -1;
+            }
+            snprintf(name, sizeof(name), "%s", argv[i] + 2);
+            value = argv[++i];
+        }
+
+        // Accept dashes on the command line (--pong-timeout)
+        for (char *c = name; *c != '\0'; c++) {
+            if (*c == '-') {
+                *c = '_';
+            }
+        }
+
+        if (strcmp(name, "config") == 0) {
+            continue;
+        }
+        if (set_option(config, name, value) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Defaults, then file, then flags
+static int build_config(runtime_config_t *config) {
+    set_defaults(config);
+
+    if (config_path != NULL && load_file(config, config_path) != 0) {
+        return -1;
+    }
+    if (apply_flags(config, saved_argc, saved_argv) != 0) {
+        return -1;
+    }
+
+    if (config->pong_wait_interval_max < config->pong_wait_interval) {
+        config->pong_wait_interval_max = config->pong_wait_interval;
+    }
+    return 0;
+}
+
+int config_load(int argc, char *argv[], char *positional[], int max_positional) {
+    int positional_count = 0;
+
+    // Split positionals from flags and find the config file first
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--help") == 0) {
+            return -1;
+        }
+        if (strncmp(argv[i], "--", 2) == 0) {
+            if (strncmp(argv[i], "--config=", 9) == 0) {
+                config_path = argv[i] + 9;
+            } else if (strchr(argv[i], '=') == NULL && i + 1 < argc) {
+                if (strcmp(argv[i], "--config") == 0) {
+                    config_path = argv[i + 1];
+                }
+                i++;
+            }
+            continue;
+        }
+
+        if (positional_count >= max_positional) {
+            return -1;
+        }
+        positional[positional_count++] = argv[i];
+    }
+
+    saved_argc = argc;
+    saved_argv = argv;
+
+    if (build_config(&current_config) != 0) {
+        return -1;
+    }
+    return positional_count;
+}
+
+runtime_config_t* config_get(void) {
+    return &current_config;
+}
+
+void config_request_reload(void) {
+    reload_requested = 1;
+}
+
+void config_reload_if_requested(void) {
+    if (!reload_requested) {
+        return;
+    }
+    reload_requested = 0;
+
+    runtime_config_t fresh;
+    if (build_config(&fresh) != 0) {
+        logger_log(LOG_ERROR, "Config reload failed, keeping current values");
+        return;
+    }
+
+    // Only reloadable values change at runtime
+    for (int i = 0; i < OPTION_COUNT; i++) {
+        const config_option_t *option = &options[i];
+
+        if (option->is_string) {
+            char *current_text = (char *)&current_config + option->offset;
+            const char *fresh_text = (const char *)&fresh + option->offset;
+            if (strcmp(current_text, fresh_text) == 0) {
+                continue;
+            }
+            if (option->offset == offsetof(runtime_config_t, log_level) && logger_configure(fresh_text) != 0) {
+                logger_log(LOG_ERROR, "Config reload: invalid log_level '%s' (keeping '%s')", fresh_text, current_text);
+            } else if (option->reloadable) {
+                logger_log(LOG_INFO, "Config reload: %s '%s' -> '%s'", option->name, current_text, fresh_text);
+                strcpy(current_text, fresh_text);
+            } else {
+                logger_log(LOG_WARNING, "Config reload: %s needs a restart (keeping '%s')",
+                          option->name, current_text);
+            }
+            continue;
+        }
+
+        int *current_value = (int *)((char *)&current_config + option->offset);
+        int fresh_value = *(int *)((char *)&fresh + option->offset);
+
+        if (*current_value == fresh_value) {
+            continue;
+        }
+        if (option->reloadable) {
+            logger_log(LOG_INFO, "Config reload: %s %d -> %d", option->name, *current_value, fresh_value);
+            *current_value = fresh_value;
+        } else {
+            logger_log(LOG_WARNING, "Config reload: %s needs a restart (keeping %d)",
+                      option->name, *current_value);
+        }
+    }
+
+    logger_log(LOG_INFO, "Config reloaded%s%s", config_path ? " from " : "", config_path ? config_path : "");
+}
+
+void config_print_usage(void) {
+    printf("Options (also valid as 'name = value' lines in a --config file):\n");
+    printf("  --config FILE                 Read options from FILE (re-read on SIGHUP)\n");
+    for (int i = 0; i < OPTION_COUNT; i++) {
+        char flag[64];
+        snprintf(flag, sizeof(flag), "--%s %s", options[i].name, options[i].is_string ? "TEXT" : "N");
+        for (char *c = flag + 2; *c != '\0'; c++) {
+            if (*c == '_') {
+                *c = '-';
+            }
+        }
+        printf("  %-30s%s%s\n", flag, options[i].description, options[i].reloadable ? " (reloadable)" : "");
+    }
+}
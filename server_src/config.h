@@ -0,0 +1,89 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/**
+ * Config module - runtime limits and timeouts
+ *
+ * Values come from the compile-time defaults, then an optional config file
+ * (key = value lines), then --key value flags. On SIGHUP the file is read
+ * again and reloadable values (timeouts, limits) take effect immediately;
+ * the rest only apply at startup.
+ */
+
+#define DEFAULT_INACTIVITY_TIMEOUT 120  // Close connections silent for 2 minutes
+#define DEFAULT_TURN_TIMEOUT 0          // Turn limit of rooms that don't set one (0 = none)
+#define DEFAULT_CONN_RATE 5             // New connections per second per IP
+#define DEFAULT_CONN_BURST 20           // Connections an IP may open at once
+#define DEFAULT_MSG_RATE 50             // Messages per second per IP
+#define DEFAULT_MSG_BURST 200           // Messages an IP may send at once
+#define DEFAULT_LISTEN_BACKLOG 10       // Pending connections queued by listen()
+#define DEFAULT_THREAD_STACK_KB 0       // Handler thread stack size (0 = system default)
+#define DEFAULT_ADMIN_SOCKET "pexeso-admin.sock"  // Admin control socket path (empty = disabled)
+#define CONFIG_MAX_PATH 108             // Fits sockaddr_un.sun_path
+#define DEFAULT_LOG_LEVEL "info"        // Level spec applied at startup
+#define CONFIG_MAX_SPEC 128             // Longest log level spec
+
+typedef struct {
+    // Reloadable
+    int pong_timeout;            // Seconds to wait for PONG
+    int pong_wait_interval;      // Seconds between PONG and next PING
+    int pong_wait_interval_max;  // Upper bound of the adaptive heartbeat interval
+    int reconnect_timeout;       // Seconds a dropped player's seat is kept
+    int inactivity_timeout;      // Seconds without any message before disconnect
+    int max_error_count;         // Invalid messages tolerated before disconnect
+    int turn_timeout;            // Default seconds per turn for new rooms (0 = unlimited)
+    int conn_rate;               // New connections per second per IP (0 = unlimited)
+    int conn_burst;              // Connections an IP may open at once
+    int msg_rate;                // Messages per second per IP (0 = unlimited)
+    int msg_burst;               // Messages an IP may send at once
+    char log_level[CONFIG_MAX_SPEC];     // Level spec, e.g. "info,room=debug"
+
+    // Startup only
+    int listen_backlog;          // listen() backlog
+    char unix_socket[CONFIG_MAX_PATH];   // Extra client listener for local proxies and bots ("" = disabled)
+    int admission_queue;         // Connections that may wait for a client slot (0 = close them)
+    int thread_stack_kb;         // Client handler thread stack (0 = default)
+    int worker_threads;          // Room workers (0 = inline)
+    int coroutines;              // 1 = run handlers as coroutines
+    int coro_schedulers;         // Coroutine scheduler threads
+    int coro_stack_kb;           // Coroutine stack size
+    char admin_socket[CONFIG_MAX_PATH];  // Admin socket path ("" = disabled)
+    char event_log[CONFIG_MAX_PATH];     // Event log segment prefix ("" = disabled)
+    int event_log_segment_kb;    // Event log segment size
+    char stats_file[CONFIG_MAX_PATH];    // Player statistics file ("" = memory only)
+    int bench_games;             // Bot-only games to play instead of serving (0 = serve)
+} runtime_config_t;
+
+/**
+ * Load configuration from defaults, config file and command-line flags.
+ * Positional arguments are left in argv order and returned via positional.
+ * @param argc Argument count
+ * @param argv Arguments
+ * @param positional Output array for non-flag arguments
+ * @param max_positional Size of positional array
+ * @return Number of positional arguments, or -1 on invalid flag/file or --help
+ */
+int config_load(int argc, char *argv[], char *positional[], int max_positional);
+
+/**
+ * Get the active configuration
+ * @return Pointer to the configuration (values may change on reload)
+ */
+runtime_config_t* config_get(void);
+
+/**
+ * Request reload (async-signal-safe, for the SIGHUP handler)
+ */
+void config_request_reload(void);
+
+/**
+ * Perform a pending reload, if any (called periodically from a server thread)
+ */
+void config_reload_if_requested(void);
+
+/**
+ * Print the list of supported flags
+ */
+void config_print_usage(void);
+
+#endif /* CONFIG_H */
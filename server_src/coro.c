@@ -0,0 +1,369 @@
+#define LOG_MODULE LOG_MODULE_IO
+
+#include "coro.h"
+#include "logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <ucontext.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#define CORO_MAX_EVENTS 64
+#define CORO_WAIT_TIMEOUT_MS 200  // Scheduler wakes at least this often to check for shutdown
+
+struct scheduler_s;
+
+typedef struct coro_s {
+    ucontext_t context;
+    void *stack;       // Mapping including guard page
+    size_t stack_size;
+    void *(*fn)(void *arg);
+    void *arg;
+    struct scheduler_s *scheduler;
+    int done;
+    int wait_fd;       // Socket registered in the scheduler's epoll set (-1 if none)
+    struct coro_s *next;  // Ready queue link
+} coro_t;
+
+typedef struct scheduler_s {
+    pthread_t thread;
+    int index;
+    int epoll_fd;
+    int wake_fd;       // eventfd signalled when another thread queues a coroutine
+    pthread_mutex_t ready_mutex;
+    coro_t *ready_head;
+    coro_t *ready_tail;
+    ucontext_t context;  // Scheduler loop context
+    int live_count;
+} scheduler_t;
+
+static scheduler_t *schedulers = NULL;
+static int scheduler_count = 0;
+static atomic_int running = 0;
+static size_t coro_stack_size = CORO_STACK_SIZE;
+static atomic_uint next_scheduler = 0;
+static __thread coro_t *current = NULL;
+
+static void coro_free(coro_t *coro) {
+    if (coro->stack != NULL) {
+        munmap(coro->stack, coro->stack_size);
+    }
+    free(coro);
+}
+
+static void ready_push(scheduler_t *scheduler, coro_t *coro) {
+    pthread_mutex_lock(&scheduler->ready_mutex);
+    coro->next = NULL;
+    if (scheduler->ready_tail != NULL) {
+        scheduler->ready_tail->next = coro;
+    } else {
+        scheduler->ready_head = coro;
+    }
+    scheduler->ready_tail = coro;
+    pthread_mutex_unlock(&scheduler->ready_mutex);
+}
+
+static coro_t* ready_take_all(scheduler_t *scheduler) {
+    pthread_mutex_lock(&scheduler->ready_mutex);
+    coro_t *list = scheduler->ready_head;
+    scheduler->ready_head = NULL;
+    scheduler->ready_tail = NULL;
+    pthread_mutex_unlock(&scheduler->ready_mutex);
+    return list;
+}
+
+static void coro_trampoline(void) {
+    coro_t *coro = current;
+    coro->fn(coro->arg);
+    coro->done = 1;
+    // Returning resumes uc_link (the scheduler loop)
+}
+
+static void resume(scheduler_t *scheduler, coro_t *coro) {
+    current = coro;
+    swapcontext(&scheduler->context, &coro->context);
+    current = NULL;
+
+    if (coro->done) {
+        if (coro->wait_fd >= 0) {
+            epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_DEL, coro->wait_fd, NULL);
+        }
+        pthread_mutex_lock(&scheduler->ready_mutex);
+        scheduler->live_count--;
+        pthread_mutex_unlock(&scheduler->ready_mutex);
+        coro_free(coro);
+    }
+}
+
+static void* scheduler_thread_func(void *arg) {
+    scheduler_t *scheduler = (scheduler_t *)arg;
+    struct epoll_event events[CORO_MAX_EVENTS];
+
+    logger_log(LOG_INFO, "Coroutine scheduler %d running", scheduler->index);
+
+    while (atomic_load(&running)) {
+        int count = epoll_wait(scheduler->epoll_fd, events, CORO_MAX_EVENTS, CORO_WAIT_TIMEOUT_MS);
+        if (count < 0 && errno != EINTR) {
+            logger_log(LOG_ERROR, "Coroutine scheduler %d: epoll_wait failed: %s",
+                      scheduler->index, strerror(errno));
+            break;
+        }
+
+        // Sockets became readable - their coroutines are ready again
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.ptr == NULL) {
+                uint64_t value;
+                if (read(scheduler->wake_fd, &value, sizeof(value)) < 0) {
+                    // Counter already drained
+                }
+                continue;
+            }
+            ready_push(scheduler, (coro_t *)events[i].data.ptr);
+        }
+
+        coro_t *coro = ready_take_all(scheduler);
+        while (coro != NULL) {
+            coro_t *next = coro->next;
+            resume(scheduler, coro);
+            coro = next;
+        }
+    }
+
+    logger_log(LOG_INFO, "Coroutine scheduler %d terminated (%d coroutines left)",
+              scheduler->index, scheduler->live_count);
+    return NULL;
+}
+
+int coro_init(int count, size_t stack_size) {
+    if (count <= 0) {
+        return -1;
+    }
+
+    coro_stack_size = stack_size;
+    schedulers = (scheduler_t *)calloc(count, sizeof(scheduler_t));
+    if (schedulers == NULL) {
+        logger_log(LOG_ERROR, "Failed to allocate coroutine schedulers");
+        return -1;
+    }
+
+    atomic_store(&running, 1);
+
+    for (int i = 0; i < count; i++) {
+        scheduler_t *scheduler = &schedulers[i];
+        scheduler->index = i;
+        pthread_mutex_init(&scheduler->ready_mutex, NULL);
+        scheduler->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        scheduler->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+
+        if (scheduler->epoll_fd < 0 || scheduler->wake_fd < 0 ||
+            epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_ADD, scheduler->wake_fd, &event) != 0) {
+            logger_log(LOG_ERROR, "Failed to set up coroutine scheduler %d: %s", i, strerror(errno));
+            scheduler_count = i;
+            coro_shutdown();
+            return -1;
+        }
+
+        int result = pthread_create(&scheduler->thread, NULL, scheduler_thread_func, scheduler);
+        if (result != 0) {
+            logger_log(LOG_ERROR, "Failed to create coroutine scheduler %d: %s", i, strerror(result));
+            close(scheduler->epoll_fd);
+            close(scheduler->wake_fd);
+            scheduler_count = i;
+            coro_shutdown();
+            return -1;
+        }
+    }
+
+    scheduler_count = count;
+    logger_log(LOG_INFO, "Coroutine mode enabled (%d schedulers, %d KB stacks)",
+              scheduler_count, (int)(coro_stack_size / 1024));
+    return 0;
+}
+
+void coro_shutdown(void) {
+    if (schedulers == NULL) {
+        return;
+    }
+
+    atomic_store(&running, 0);
+
+    for (int i = 0; i < scheduler_count; i++) {
+        uint64_t one = 1;
+        if (write(schedulers[i].wake_fd, &one, sizeof(one)) < 0) {
+            // Scheduler notices the flag on its next timeout anyway
+        }
+    }
+    for (int i = 0; i < scheduler_count; i++) {
+        pthread_join(schedulers[i].thread, NULL);
+        close(schedulers[i].epoll_fd);
+        close(schedulers[i].wake_fd);
+        pthread_mutex_destroy(&schedulers[i].ready_mutex);
+    }
+
+    free(schedulers);
+    schedulers = NULL;
+    scheduler_count = 0;
+
+    logger_log(LOG_INFO, "Coroutine schedulers stopped");
+}
+
+int coro_enabled(void) {
+    return scheduler_count > 0 && atomic_load(&running);
+}
+
+int coro_spawn(void *(*fn)(void *arg), void *arg) {
+    if (!coro_enabled()) {
+        return -1;
+    }
+
+    coro_t *coro = (coro_t *)calloc(1, sizeof(coro_t));
+    if (coro == NULL) {
+        return -1;
+    }
+
+    // Stack grows down - the lowest page stays unmapped to catch overflows
+    long page_size = sysconf(_SC_PAGESIZE);
+    coro->stack_size = coro_stack_size + (size_t)page_size;
+    coro->stack = mmap(NULL, coro->stack_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (coro->stack == MAP_FAILED) {
+        coro->stack = NULL;
+        coro_free(coro);
+        return -1;
+    }
+    mprotect(coro->stack, (size_t)page_size, PROT_NONE);
+
+    unsigned int index = atomic_fetch_add(&next_scheduler, 1) % (unsigned int)scheduler_count;
+    scheduler_t *scheduler = &schedulers[index];
+
+    coro->fn = fn;
+    coro->arg = arg;
+    coro->scheduler = scheduler;
+    coro->wait_fd = -1;
+
+    getcontext(&coro->context);
+    coro->context.uc_stack.ss_sp = (char *)coro->stack + page_size;
+    coro->context.uc_stack.ss_size = coro_stack_size;
+    coro->context.uc_link = &scheduler->context;
+    makecontext(&coro->context, coro_trampoline, 0);
+
+    pthread_mutex_lock(&scheduler->ready_mutex);
+    scheduler->live_count++;
+    pthread_mutex_unlock(&scheduler->ready_mutex);
+
+    ready_push(scheduler, coro);
+
+    uint64_t one = 1;
+    if (write(scheduler->wake_fd, &one, sizeof(one)) < 0) {
+        logger_log(LOG_WARNING, "Failed to wake coroutine scheduler %d", scheduler->index);
+    }
+    return 0;
+}
+
+// Park the current coroutine until fd is readable
+static void wait_readable(coro_t *coro, int fd) {
+    scheduler_t *scheduler = coro->scheduler;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = coro;
+
+    // One-shot registration is re-armed with MOD on every wait
+    int op = (coro->wait_fd == fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(scheduler->epoll_fd, op, fd, &event) != 0) {
+        if (op == EPOLL_CTL_MOD || errno != EEXIST ||
+            epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+            return;  // Caller retries recv and gets the real error
+        }
+    }
+    coro->wait_fd = fd;
+
+    swapcontext(&coro->context, &scheduler->context);
+}
+
+ssize_t coro_recv(int fd, void *buffer, size_t length) {
+    coro_t *coro = current;
+    if (coro == NULL) {
+        return recv(fd, buffer, length, 0);
+    }
+
+    while (1) {
+        ssize_t received = recv(fd, buffer, length, MSG_DONTWAIT);
+        if (received >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            return received;
+        }
+        wait_readable(coro, fd);
+    }
+}
+
+void coro_wait_init(coro_wait_t *wait) {
+    pthread_mutex_init(&wait->mutex, NULL);
+    pthread_cond_init(&wait->drained, NULL);
+    wait->count = 0;
+    wait->waiter = NULL;
+}
+
+void coro_wait_add(coro_wait_t *wait) {
+    pthread_mutex_lock(&wait->mutex);
+    wait->count++;
+    pthread_mutex_unlock(&wait->mutex);
+}
+
+void coro_wait_done(coro_wait_t *wait) {
+    // Wake under the lock: the waiter can't return (and free the counter) before we're done
+    pthread_mutex_lock(&wait->mutex);
+    if (--wait->count == 0) {
+        pthread_cond_broadcast(&wait->drained);
+
+        coro_t *coro = (coro_t *)wait->waiter;
+        if (coro != NULL) {
+            wait->waiter = NULL;
+            ready_push(coro->scheduler, coro);
+
+            uint64_t one = 1;
+            if (write(coro->scheduler->wake_fd, &one, sizeof(one)) < 0) {
+                // Scheduler runs the ready queue on its next timeout anyway
+            }
+        }
+    }
+    pthread_mutex_unlock(&wait->mutex);
+}
+
+void coro_wait_all(coro_wait_t *wait) {
+    coro_t *coro = current;
+
+    pthread_mutex_lock(&wait->mutex);
+    while (wait->count > 0) {
+        if (coro == NULL) {
+            pthread_cond_wait(&wait->drained, &wait->mutex);
+            continue;
+        }
+
+        // Only our own scheduler resumes us, and it's busy running us until the switch,
+        // so a wake-up between unlock and swapcontext isn't lost
+        wait->waiter = coro;
+        pthread_mutex_unlock(&wait->mutex);
+        swapcontext(&coro->context, &coro->scheduler->context);
+        pthread_mutex_lock(&wait->mutex);
+    }
+    pthread_mutex_unlock(&wait->mutex);
+}
+
+int coro_wait_pending(coro_wait_t *wait) {
+    pthread_mutex_lock(&wait->mutex);
+    int count = wait->count;
+    pthread_mutex_unlock(&wait->mutex);
+    return count;
+}
@@ -0,0 +1,100 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+/**
+ * Coroutine module - stackful client handlers on a few scheduler threads
+ *
+ * Each connection handler runs as a ucontext coroutine with its own small stack.
+ * A recv() that would block parks the coroutine in its scheduler's epoll set and
+ * switches to the next ready one, so handler code stays straight-line.
+ */
+
+#define USE_COROUTINES 0              // 1 = run client handlers as coroutines instead of threads
+#define CORO_SCHEDULER_THREADS 2      // Scheduler threads (coroutines never migrate between them)
+#define CORO_STACK_SIZE (64 * 1024)   // Default stack per coroutine (plus one guard page)
+
+/**
+ * Count of outstanding jobs another thread finishes; waiting for it parks a
+ * coroutine on its scheduler and blocks an ordinary thread on the condition
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t drained;
+    int count;
+    void *waiter;  // Coroutine parked in coro_wait_all() (NULL if none)
+} coro_wait_t;
+
+/**
+ * Start scheduler threads
+ * @param scheduler_count Number of schedulers
+ * @param stack_size Stack size of each coroutine in bytes
+ * @return 0 on success, -1 on error
+ */
+int coro_init(int scheduler_count, size_t stack_size);
+
+/**
+ * Stop scheduler threads (coroutines still parked are abandoned)
+ */
+void coro_shutdown(void);
+
+/**
+ * Check if coroutine mode is running
+ * @return 1 if schedulers are running, 0 otherwise
+ */
+int coro_enabled(void);
+
+/**
+ * Start a coroutine on the next scheduler (round robin)
+ * @param fn Coroutine body (same signature as a thread function)
+ * @param arg Argument for fn
+ * @return 0 on success, -1 on error
+ */
+int coro_spawn(void *(*fn)(void *arg), void *arg);
+
+/**
+ * recv() that yields to the scheduler instead of blocking when called from a
+ * coroutine; behaves like a plain blocking recv() on ordinary threads
+ * @param fd Socket
+ * @param buffer Receive buffer
+ * @param length Buffer size
+ * @return Bytes received, 0 on EOF, -1 on error
+ */
+ssize_t coro_recv(int fd, void *buffer, size_t length);
+
+/**
+ * Initialize a wait counter at zero
+ * @param wait Counter to initialize
+ */
+void coro_wait_init(coro_wait_t *wait);
+
+/**
+ * Register one outstanding job
+ * @param wait Counter
+ */
+void coro_wait_add(coro_wait_t *wait);
+
+/**
+ * Finish one job; the last one wakes the waiter. The waiter may free the counter
+ * as soon as this returns.
+ * @param wait Counter
+ */
+void coro_wait_done(coro_wait_t *wait);
+
+/**
+ * Wait until every registered job finished (yields to the scheduler in a coroutine)
+ * @param wait Counter
+ */
+void coro_wait_all(coro_wait_t *wait);
+
+/**
+ * Get number of outstanding jobs
+ * @param wait Counter
+ * @return Job count
+ */
+int coro_wait_pending(coro_wait_t *wait);
+
+#endif /* CORO_H */
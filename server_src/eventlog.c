@@ -0,0 +1,157 @@
+#include "eventlog.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+
+static pthread_mutex_t eventlog_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile int enabled = 0;
+static char segment_prefix[256];
+static size_t segment_bytes = 0;
+static int segment_fd = -1;
+static unsigned char *segment_map = NULL;
+static uint32_t segment_number = 0;
+static size_t records_used = 0;
+static size_t records_capacity = 0;
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void segment_path(uint32_t number, char *path, size_t size) {
+    snprintf(path, size, "%s-%06u.evlog", segment_prefix, number);
+}
+
+// Unmap the current segment and cut the file to the records actually written
+static void close_segment(void) {
+    if (segment_map == NULL) {
+        return;
+    }
+
+    munmap(segment_map, segment_bytes);
+    if (ftruncate(segment_fd, sizeof(event_segment_header_t) + records_used * sizeof(event_record_t)) != 0) {
+        logger_log(LOG_WARNING, "Event log: Cannot trim segment %u: %s", segment_number, strerror(errno));
+    }
+    close(segment_fd);
+    segment_map = NULL;
+    segment_fd = -1;
+}
+
+static int open_segment(uint32_t number) {
+    char path[300];
+    segment_path(number, path, sizeof(path));
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        logger_log(LOG_ERROR, "Event log: Cannot create %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    if (ftruncate(fd, segment_bytes) != 0) {
+        logger_log(LOG_ERROR, "Event log: Cannot size %s: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        logger_log(LOG_ERROR, "Event log: Cannot map %s: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    event_segment_header_t *header = (event_segment_header_t *)map;
+    memcpy(header->magic, EVENTLOG_MAGIC, sizeof(EVENTLOG_MAGIC));
+    header->version = EVENTLOG_VERSION;
+    header->record_size = sizeof(event_record_t);
+    header->wall_ns = clock_ns(CLOCK_REALTIME);
+    header->mono_ns = clock_ns(CLOCK_MONOTONIC);
+    header->segment = number;
+
+    segment_fd = fd;
+    segment_map = (unsigned char *)map;
+    segment_number = number;
+    records_used = 0;
+
+    // Drop the oldest segment beyond the retention window
+    if (number >= EVENTLOG_KEEP_SEGMENTS) {
+        segment_path(number - EVENTLOG_KEEP_SEGMENTS, path, sizeof(path));
+        unlink(path);
+    }
+
+    return 0;
+}
+
+int eventlog_init(const char *prefix, size_t segment_size) {
+    if (prefix == NULL || prefix[0] == '\0') {
+        return 0;
+    }
+
+    pthread_mutex_lock(&eventlog_mutex);
+
+    snprintf(segment_prefix, sizeof(segment_prefix), "%s", prefix);
+    segment_bytes = segment_size;
+    records_capacity = (segment_size - sizeof(event_segment_header_t)) / sizeof(event_record_t);
+
+    if (open_segment(0) != 0) {
+        pthread_mutex_unlock(&eventlog_mutex);
+        return -1;
+    }
+
+    enabled = 1;
+    pthread_mutex_unlock(&eventlog_mutex);
+
+    logger_log(LOG_INFO, "Event log: Writing %s-*.evlog (%zu records per segment)", prefix, records_capacity);
+    return 0;
+}
+
+void eventlog_record(event_type_t type, int client_id, int room_id, int arg0, int arg1) {
+    if (!enabled) {
+        return;
+    }
+
+    event_record_t record;
+    record.timestamp_ns = clock_ns(CLOCK_MONOTONIC);
+    record.type = (uint16_t)type;
+    record.reserved = 0;
+    record.client_id = client_id;
+    record.room_id = room_id;
+    record.arg0 = arg0;
+    record.arg1 = arg1;
+    record.padding = 0;
+
+    pthread_mutex_lock(&eventlog_mutex);
+
+    if (segment_map != NULL && records_used == records_capacity) {
+        close_segment();
+        if (open_segment(segment_number + 1) != 0) {
+            logger_log(LOG_ERROR, "Event log: Rotation failed, disabling");
+            enabled = 0;
+        }
+    }
+
+    if (segment_map != NULL) {
+        memcpy(segment_map + sizeof(event_segment_header_t) + records_used * sizeof(event_record_t),
+               &record, sizeof(record));
+        records_used++;
+    }
+
+    pthread_mutex_unlock(&eventlog_mutex);
+}
+
+void eventlog_shutdown(void) {
+    pthread_mutex_lock(&eventlog_mutex);
+    if (enabled) {
+        logger_log(LOG_INFO, "Event log: Closing segment %u (%zu records)", segment_number, records_used);
+    }
+    enabled = 0;
+    close_segment();
+    pthread_mutex_unlock(&eventlog_mutex);
+}
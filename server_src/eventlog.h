@@ -0,0 +1,84 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Structured event log - fixed-size binary records in mmap'd segment files
+ *
+ * Each event is one event_record_t with a CLOCK_MONOTONIC timestamp, written
+ * by copying it into the current segment (no formatting, no syscall). When a
+ * segment is full the next one (<prefix>-<n>.evlog) is started and the oldest
+ * beyond EVENTLOG_KEEP_SEGMENTS is deleted. The logfmt tool renders segments
+ * as text or JSON.
+ */
+
+#define EVENTLOG_MAGIC "PXEVLOG"        // First bytes of every segment
+#define EVENTLOG_VERSION 1
+#define EVENTLOG_KEEP_SEGMENTS 8        // Segments kept on disk
+#define DEFAULT_EVENT_LOG_SEGMENT_KB 1024
+
+// X(name, text, arg0 name, arg1 name)
+#define EVENT_TYPES(X) \
+    X(EVENT_CONNECT,     "connect",     "ip",          "port") \
+    X(EVENT_AUTH,        "auth",        "binary",      "-") \
+    X(EVENT_ROOM_CREATE, "room_create", "max_players", "board_size") \
+    X(EVENT_FLIP,        "flip",        "card",        "value") \
+    X(EVENT_MATCH,       "match",       "first",       "second") \
+    X(EVENT_DISCONNECT,  "disconnect",  "-",           "-") \
+    X(EVENT_RECONNECT,   "reconnect",   "temp_id",     "downtime")
+
+typedef enum {
+    EVENT_NONE,  // Unused (zero-filled) slot, ends a segment
+#define EVENT_ENUM(name, text, arg0, arg1) name,
+    EVENT_TYPES(EVENT_ENUM)
+#undef EVENT_ENUM
+    EVENT_TYPE_COUNT
+} event_type_t;
+
+typedef struct {
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC
+    uint16_t type;          // event_type_t
+    uint16_t reserved;
+    int32_t client_id;      // -1 if not applicable
+    int32_t room_id;        // -1 if not applicable
+    int32_t arg0;           // Meaning depends on type (see EVENT_TYPES)
+    int32_t arg1;
+    uint32_t padding;
+} event_record_t;
+
+typedef struct {
+    char magic[8];          // EVENTLOG_MAGIC
+    uint32_t version;       // EVENTLOG_VERSION
+    uint32_t record_size;   // sizeof(event_record_t)
+    uint64_t wall_ns;       // CLOCK_REALTIME when the segment was started
+    uint64_t mono_ns;       // CLOCK_MONOTONIC at the same moment
+    uint32_t segment;       // Segment number
+    uint32_t reserved[7];
+} event_segment_header_t;
+
+/**
+ * Start writing segments (empty prefix leaves the event log disabled)
+ * @param prefix Segment path prefix
+ * @param segment_size Segment file size in bytes
+ * @return 0 on success, -1 on error
+ */
+int eventlog_init(const char *prefix, size_t segment_size);
+
+/**
+ * Append one event (no-op when disabled)
+ * @param type Event type
+ * @param client_id Client ID or -1
+ * @param room_id Room ID or -1
+ * @param arg0 First type-specific value
+ * @param arg1 Second type-specific value
+ */
+void eventlog_record(event_type_t type, int client_id, int room_id, int arg0, int arg1);
+
+/**
+ * Trim the current segment to its used size and stop writing
+ */
+void eventlog_shutdown(void);
+
+#endif /* EVENTLOG_H */
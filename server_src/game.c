@@ -1,19 +1,31 @@
+#define LOG_MODULE LOG_MODULE_GAME
+
 #include "game.h"
+#include "board_pool.h"
 #include "logger.h"
 #include "protocol.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <stdint.h>
+
+static unsigned int fixed_seed = 0;  // 0 = new random seed per game
+
+// Per-game shuffle seed; a fixed seed mixes in the player IDs so a game's board
+// does not depend on the order games happen to start in
+static unsigned int board_seed(client_t **players, int player_count) {
+    if (fixed_seed == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (unsigned int)(ts.tv_nsec ^ ts.tv_sec ^ (long)(uintptr_t)players);
+    }
 
-// Shuffle array using Fisher-Yates algorithm
-static void shuffle_array(int *array, int size) {
-    for (int i = size - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        int temp = array[i];
-        array[i] = array[j];
-        array[j] = temp;
+    unsigned int seed = fixed_seed;
+    for (int i = 0; i < player_count; i++) {
+        seed = seed * 31 + (unsigned int)players[i]->client_id;
     }
+    return seed;
 }
 
 game_t* game_create(int board_size, client_t **players, int player_count) {
@@ -49,8 +61,12 @@ game_t* game_create(int board_size, client_t **players, int player_count) {
     // Copy players
     for (int i = 0; i < player_count; i++) {
         game->players[i] = players[i];
+        if (players[i] != NULL) {
+            players[i]->game_slot = i;
+        }
         game->player_scores[i] = 0;
         game->player_ready[i] = 0;
+        game->player_flips[i] = 0;
     }
 
     // Allocate cards
@@ -61,39 +77,28 @@ game_t* game_create(int board_size, client_t **players, int player_count) {
         return NULL;
     }
 
-    // Create array of card values (pairs)
-    int *values = (int *)malloc(game->total_cards * sizeof(int));
-    if (values == NULL) {
-        logger_log(LOG_ERROR, "Failed to allocate memory for card values");
-        free(game->cards);
-        free(game);
-        return NULL;
-    }
-
-    // Fill with pairs (1,1,2,2,3,3,...)
-    for (int i = 0; i < game->total_pairs; i++) {
-        values[i * 2] = i + 1;
-        values[i * 2 + 1] = i + 1;
+    // Take a prepared board; fixed seeds (reproducible boards) and an empty pool shuffle here
+    uint8_t values[BOARD_MAX_CARDS];
+    if (fixed_seed != 0 || board_pool_take(board_size, values) != 0) {
+        unsigned int seed = board_seed(players, player_count);
+        board_shuffle(values, game->total_cards, &seed);
     }
 
-    // Shuffle
-    srand(time(NULL));
-    shuffle_array(values, game->total_cards);
-
-    // Assign shuffled values to cards
     for (int i = 0; i < game->total_cards; i++) {
         game->cards[i].value = values[i];
         game->cards[i].state = CARD_HIDDEN;
     }
 
-    free(values);
-
     logger_log(LOG_INFO, "Game created: board_size=%d, total_cards=%d, pairs=%d, players=%d",
                board_size, game->total_cards, game->total_pairs, player_count);
 
     return game;
 }
 
+void game_set_seed(unsigned int seed) {
+    fixed_seed = seed;
+}
+
 void game_destroy(game_t *game) {
     if (game == NULL) {
         return;
@@ -134,14 +139,19 @@ int game_remove_player(game_t *game, client_t *client) {
     // Shift remaining players down
     for (int i = player_index; i < game->player_count - 1; i++) {
         game->players[i] = game->players[i + 1];
+        if (game->players[i] != NULL) {
+            game->players[i]->game_slot = i;
+        }
         game->player_scores[i] = game->player_scores[i + 1];
         game->player_ready[i] = game->player_ready[i + 1];
+        game->player_flips[i] = game->player_flips[i + 1];
     }
 
     // Clear last slot
     game->players[game->player_count - 1] = NULL;
     game->player_scores[game->player_count - 1] = 0;
     game->player_ready[game->player_count - 1] = 0;
+    game->player_flips[game->player_count - 1] = 0;
 
     // Decrease count
     game->player_count--;
@@ -258,6 +268,7 @@ int game_flip_card(game_t *game, client_t *client, int card_index) {
     // Reveal the card
     game->cards[card_index].state = CARD_REVEALED;
     game->flips_this_turn++;
+    game->player_flips[game->current_player_index]++;
 
     logger_log(LOG_INFO, "Player %s flipped card %d (value=%d), flip %d/2",
                client->nickname, card_index, game->cards[card_index].value,
@@ -330,6 +341,26 @@ int game_check_match(game_t *game) {
     }
 }
 
+int game_skip_turn(game_t *game) {
+    if (game == NULL || game->state != GAME_STATE_PLAYING) {
+        return -1;
+    }
+
+    if (game->first_card_index >= 0 && game->cards[game->first_card_index].state == CARD_REVEALED) {
+        game->cards[game->first_card_index].state = CARD_HIDDEN;
+    }
+
+    logger_log(LOG_INFO, "Turn of player %s timed out",
+               game->players[game->current_player_index]->nickname);
+
+    game->current_player_index = (game->current_player_index + 1) % game->player_count;
+    game->first_card_index = -1;
+    game->second_card_index = -1;
+    game->flips_this_turn = 0;
+
+    return 0;
+}
+
 client_t* game_get_current_player(game_t *game) {
     if (game == NULL || game->state != GAME_STATE_PLAYING) {
         return NULL;
@@ -38,6 +38,7 @@ typedef struct game_s {
     int player_count;
     int player_scores[MAX_PLAYERS_PER_ROOM];  // Score for each player
     int player_ready[MAX_PLAYERS_PER_ROOM];   // Ready status
+    int player_flips[MAX_PLAYERS_PER_ROOM];   // Cards flipped by each player (statistics)
 
     int current_player_index;    // Index of player whose turn it is
     int first_card_index;        // First flipped card (-1 if none)
@@ -57,6 +58,12 @@ typedef struct game_s {
  */
 game_t* game_create(int board_size, client_t **players, int player_count);
 
+/**
+ * Use a fixed shuffle seed so boards are reproducible (simulation)
+ * @param seed Seed, 0 = random board per game
+ */
+void game_set_seed(unsigned int seed);
+
 /**
  * Destroy a game
  * @param game Game to destroy
@@ -109,6 +116,14 @@ int game_flip_card(game_t *game, client_t *client, int card_index);
  */
 int game_check_match(game_t *game);
 
+/**
+ * End the current turn without a match (turn time ran out): turns a card
+ * revealed this turn face down again and passes the turn to the next player
+ * @param game Game
+ * @return 0 on success, -1 if the game is not running
+ */
+int game_skip_turn(game_t *game);
+
 /**
  * Get the player whose turn it is
  * @param game Game
@@ -0,0 +1,134 @@
+/**
+ * logfmt - render event log segments written by the server
+ *
+ * Usage: logfmt [--json] SEGMENT...
+ */
+
+#include "eventlog.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+typedef struct {
+    const char *name;
+    const char *arg0;
+    const char *arg1;
+} event_info_t;
+
+static const event_info_t event_info[EVENT_TYPE_COUNT] = {
+    { "none", "-", "-" },
+#define EVENT_INFO(name, text, arg0, arg1) { text, arg0, arg1 },
+    EVENT_TYPES(EVENT_INFO)
+#undef EVENT_INFO
+};
+
+static void format_time(uint64_t wall_ns, char *buffer, size_t size) {
+    time_t seconds = (time_t)(wall_ns / 1000000000ULL);
+    struct tm tm_info;
+    localtime_r(&seconds, &tm_info);
+    size_t length = strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &tm_info);
+    snprintf(buffer + length, size - length, ".%06llu",
+             (unsigned long long)(wall_ns % 1000000000ULL) / 1000);
+}
+
+// Connect events carry the IPv4 address, everything else plain numbers
+static void format_arg(const event_record_t *record, int index, char *buffer, size_t size) {
+    int32_t value = index == 0 ? record->arg0 : record->arg1;
+    if (record->type == EVENT_CONNECT && index == 0) {
+        struct in_addr address;
+        address.s_addr = (uint32_t)value;
+        inet_ntop(AF_INET, &address, buffer, size);
+    } else {
+        snprintf(buffer, size, "%d", value);
+    }
+}
+
+static void print_record(const event_segment_header_t *header, const event_record_t *record, int json) {
+    const event_info_t *info = &event_info[record->type];
+    char time_text[64];
+    char args[2][64];
+
+    format_time(header->wall_ns + (record->timestamp_ns - header->mono_ns), time_text, sizeof(time_text));
+    format_arg(record, 0, args[0], sizeof(args[0]));
+    format_arg(record, 1, args[1], sizeof(args[1]));
+
+    if (json) {
+        printf("{\"time\":\"%s\",\"mono_ns\":%llu,\"event\":\"%s\",\"client\":%d,\"room\":%d",
+               time_text, (unsigned long long)record->timestamp_ns, info->name,
+               record->client_id, record->room_id);
+        for (int i = 0; i < 2; i++) {
+            const char *name = i == 0 ? info->arg0 : info->arg1;
+            if (strcmp(name, "-") != 0) {
+                int numeric = !(record->type == EVENT_CONNECT && i == 0);
+                printf(numeric ? ",\"%s\":%s" : ",\"%s\":\"%s\"", name, args[i]);
+            }
+        }
+        printf("}\n");
+        return;
+    }
+
+    printf("%s %-12s client=%d room=%d", time_text, info->name, record->client_id, record->room_id);
+    for (int i = 0; i < 2; i++) {
+        const char *name = i == 0 ? info->arg0 : info->arg1;
+        if (strcmp(name, "-") != 0) {
+            printf(" %s=%s", name, args[i]);
+        }
+    }
+    printf("\n");
+}
+
+static int dump_segment(const char *path, int json) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    event_segment_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, EVENTLOG_MAGIC, sizeof(EVENTLOG_MAGIC)) != 0) {
+        fprintf(stderr, "%s: not an event log segment\n", path);
+        fclose(file);
+        return -1;
+    }
+    if (header.version != EVENTLOG_VERSION || header.record_size != sizeof(event_record_t)) {
+        fprintf(stderr, "%s: unsupported version %u (record size %u)\n", path, header.version, header.record_size);
+        fclose(file);
+        return -1;
+    }
+
+    // A zero-filled record marks the end of a segment that was not trimmed (crash)
+    event_record_t record;
+    while (fread(&record, sizeof(record), 1, file) == 1 && record.type != EVENT_NONE) {
+        if (record.type < EVENT_TYPE_COUNT) {
+            print_record(&header, &record, json);
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int json = 0;
+    int first = 1;
+
+    if (argc > 1 && strcmp(argv[1], "--json") == 0) {
+        json = 1;
+        first = 2;
+    }
+
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [--json] SEGMENT...\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = first; i < argc; i++) {
+        if (dump_segment(argv[i], json) != 0) {
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -5,9 +5,20 @@
 #include <time.h>
 #include <pthread.h>
 #include <string.h>
+#include <strings.h>
 
 static FILE *log_file = NULL;
 static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+volatile log_level_t logger_levels[LOG_MODULE_COUNT] = {
+    LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO
+};
+
+static char time_buf[64];        // Cached timestamp text (guarded by log_mutex)
+static time_t time_buf_second = -1;
+
+static const char *module_names[LOG_MODULE_COUNT] = {
+    "core", "server", "client", "room", "game", "io"
+};
 
 int logger_init(const char *filename) {
     pthread_mutex_lock(&log_mutex);
@@ -28,18 +39,23 @@ int logger_init(const char *filename) {
     return 0;
 }
 
-void logger_log(log_level_t level, const char *format, ...) {
+void logger_write(log_module_t module, log_level_t level, const char *format, ...) {
+    (void)module;
     pthread_mutex_lock(&log_mutex);
 
-    // Get current time
+    // Format the timestamp only when the second changes (localtime is not cheap)
     time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
-    char time_buf[64];
-    strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", tm_info);
+    if (now != time_buf_second) {
+        struct tm tm_info;
+        localtime_r(&now, &tm_info);
+        strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &tm_info);
+        time_buf_second = now;
+    }
 
     // Determine level string
     const char *level_str;
     switch (level) {
+        case LOG_DEBUG:   level_str = "DEBUG"; break;
         case LOG_INFO:    level_str = "INFO"; break;
         case LOG_WARNING: level_str = "WARN"; break;
         case LOG_ERROR:   level_str = "ERROR"; break;
@@ -68,6 +84,126 @@ void logger_log(log_level_t level, const char *format, ...) {
     pthread_mutex_unlock(&log_mutex);
 }
 
+int logger_ratelimit(log_ratelimit_t *state, unsigned int max_per_second, unsigned int *suppressed) {
+    long now = (long)time(NULL);
+    long window = __atomic_load_n(&state->window, __ATOMIC_RELAXED);
+    *suppressed = 0;
+
+    // First caller in a new second resets the window and reports what was dropped
+    if (window != now && __atomic_compare_exchange_n(&state->window, &window, now, 0,
+                                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&state->count, 0, __ATOMIC_RELAXED);
+        *suppressed = __atomic_exchange_n(&state->suppressed, 0, __ATOMIC_RELAXED);
+    }
+
+    if (__atomic_fetch_add(&state->count, 1, __ATOMIC_RELAXED) < max_per_second) {
+        return 1;
+    }
+
+    __atomic_fetch_add(&state->suppressed, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+void logger_set_level(log_level_t level) {
+    for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+        logger_levels[i] = level;
+    }
+}
+
+void logger_set_module_level(log_module_t module, log_level_t level) {
+    if (module >= 0 && module < LOG_MODULE_COUNT) {
+        logger_levels[module] = level;
+    }
+}
+
+log_level_t logger_get_level(log_module_t module) {
+    if (module < 0 || module >= LOG_MODULE_COUNT) {
+        return LOG_INFO;
+    }
+    return logger_levels[module];
+}
+
+int logger_configure(const char *spec) {
+    log_level_t levels[LOG_MODULE_COUNT];
+    for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+        levels[i] = logger_levels[i];
+    }
+
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", spec);
+
+    // Validate the whole spec before applying any of it
+    char *saveptr = NULL;
+    for (char *item = strtok_r(copy, ", ", &saveptr); item != NULL; item = strtok_r(NULL, ", ", &saveptr)) {
+        log_level_t level;
+        char *equals = strchr(item, '=');
+
+        if (equals == NULL) {
+            if (logger_parse_level(item, &level) != 0) {
+                return -1;
+            }
+            for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+                levels[i] = level;
+            }
+            continue;
+        }
+
+        *equals = '\0';
+        log_module_t module;
+        if (logger_parse_module(item, &module) != 0 || logger_parse_level(equals + 1, &level) != 0) {
+            return -1;
+        }
+        levels[module] = level;
+    }
+
+    for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+        logger_levels[i] = levels[i];
+    }
+    return 0;
+}
+
+int logger_parse_level(const char *name, log_level_t *level) {
+    if (strcasecmp(name, "debug") == 0) {
+        *level = LOG_DEBUG;
+    } else if (strcasecmp(name, "info") == 0) {
+        *level = LOG_INFO;
+    } else if (strcasecmp(name, "warning") == 0 || strcasecmp(name, "warn") == 0) {
+        *level = LOG_WARNING;
+    } else if (strcasecmp(name, "error") == 0) {
+        *level = LOG_ERROR;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int logger_parse_module(const char *name, log_module_t *module) {
+    for (int i = 0; i < LOG_MODULE_COUNT; i++) {
+        if (strcasecmp(name, module_names[i]) == 0) {
+            *module = (log_module_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* logger_level_name(log_level_t level) {
+    switch (level) {
+        case LOG_DEBUG:   return "debug";
+        case LOG_INFO:    return "info";
+        case LOG_WARNING: return "warning";
+        case LOG_ERROR:   return "error";
+        default:          return "unknown";
+    }
+}
+
+const char* logger_module_name(log_module_t module) {
+    if (module < 0 || module >= LOG_MODULE_COUNT) {
+        return "unknown";
+    }
+    return module_names[module];
+}
+
 void logger_shutdown(void) {
     pthread_mutex_lock(&log_mutex);
 
@@ -3,14 +3,85 @@
 
 /**
  * Logger module - thread-safe logging with timestamps
+ *
+ * logger_log() is a macro: the level check runs before any argument is
+ * evaluated or formatted. Each source file may set LOG_MODULE before its
+ * includes to get its own runtime level. Release builds (-DNDEBUG) compile
+ * LOG_DEBUG calls out entirely.
  */
 
 typedef enum {
+    LOG_DEBUG,
     LOG_INFO,
     LOG_WARNING,
     LOG_ERROR
 } log_level_t;
 
+typedef enum {
+    LOG_MODULE_CORE,    // main, config, logger, admin
+    LOG_MODULE_SERVER,  // accept loop, PING and timeout threads
+    LOG_MODULE_CLIENT,  // client handlers and client list
+    LOG_MODULE_ROOM,    // rooms and room workers
+    LOG_MODULE_GAME,    // game logic
+    LOG_MODULE_IO,      // codec, io_uring, coroutines
+    LOG_MODULE_COUNT
+} log_module_t;
+
+#ifndef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_CORE
+#endif
+
+#ifdef NDEBUG
+#define LOG_COMPILED_LEVEL LOG_INFO
+#else
+#define LOG_COMPILED_LEVEL LOG_DEBUG
+#endif
+
+// Per-module minimum levels (read without locking on every call)
+extern volatile log_level_t logger_levels[LOG_MODULE_COUNT];
+
+#define logger_enabled(level) \
+    ((level) >= LOG_COMPILED_LEVEL && (level) >= logger_levels[LOG_MODULE])
+
+/**
+ * Log a message (arguments are not evaluated if the level is disabled)
+ * @param level Log level
+ * @param ... Printf-style format string and arguments
+ */
+#define logger_log(level, ...) \
+    do { \
+        if (logger_enabled(level)) { \
+            logger_write(LOG_MODULE, (level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+// Per-call-site rate limit state (one static instance per macro use)
+typedef struct {
+    long window;                // Second the counters belong to
+    unsigned int count;         // Messages logged in this window
+    unsigned int suppressed;    // Messages dropped in this window
+} log_ratelimit_t;
+
+/**
+ * Log at most max_per_second messages per second from this call site;
+ * the number of dropped messages is reported with the next logged one
+ * @param level Log level
+ * @param max_per_second Messages allowed per second
+ * @param ... Printf-style format string and arguments
+ */
+#define logger_log_ratelimited(level, max_per_second, ...) \
+    do { \
+        static log_ratelimit_t log_ratelimit_state; \
+        unsigned int log_suppressed; \
+        if (logger_enabled(level) && \
+            logger_ratelimit(&log_ratelimit_state, (max_per_second), &log_suppressed)) { \
+            if (log_suppressed > 0) { \
+                logger_write(LOG_MODULE, (level), "(%u similar messages suppressed)", log_suppressed); \
+            } \
+            logger_write(LOG_MODULE, (level), __VA_ARGS__); \
+        } \
+    } while (0)
+
 /**
  * Initialize logger
  * @param filename Log file path (NULL for stdout only)
@@ -19,11 +90,80 @@ typedef enum {
 int logger_init(const char *filename);
 
 /**
- * Log a message
+ * Write a log line unconditionally (use logger_log instead)
+ * @param module Source module
  * @param level Log level
  * @param format Printf-style format string
  */
-void logger_log(log_level_t level, const char *format, ...);
+void logger_write(log_module_t module, log_level_t level, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * Rate limit check for logger_log_ratelimited
+ * @param state Call site state
+ * @param max_per_second Messages allowed per second
+ * @param suppressed Output: messages dropped in the previous window (reported once)
+ * @return 1 if the message may be logged, 0 if it is dropped
+ */
+int logger_ratelimit(log_ratelimit_t *state, unsigned int max_per_second, unsigned int *suppressed);
+
+/**
+ * Set the lowest level that gets written, for all modules
+ * @param level Minimum level
+ */
+void logger_set_level(log_level_t level);
+
+/**
+ * Set the lowest level that gets written for one module
+ * @param module Module
+ * @param level Minimum level
+ */
+void logger_set_module_level(log_module_t module, log_level_t level);
+
+/**
+ * Get the lowest level that gets written for a module
+ * @param module Module
+ * @return Minimum level
+ */
+log_level_t logger_get_level(log_module_t module);
+
+/**
+ * Apply a level spec: "info" sets all modules, "info,room=debug,client=warning"
+ * sets a default and per-module overrides
+ * @param spec Level spec
+ * @return 0 on success, -1 if the spec is invalid (nothing is changed)
+ */
+int logger_configure(const char *spec);
+
+/**
+ * Parse a level name (debug, info, warning, error)
+ * @param name Level name
+ * @param level Output level
+ * @return 0 on success, -1 if the name is unknown
+ */
+int logger_parse_level(const char *name, log_level_t *level);
+
+/**
+ * Parse a module name (core, server, client, room, game, io)
+ * @param name Module name
+ * @param module Output module
+ * @return 0 on success, -1 if the name is unknown
+ */
+int logger_parse_module(const char *name, log_module_t *module);
+
+/**
+ * Get the name of a level
+ * @param level Level
+ * @return Lowercase level name
+ */
+const char* logger_level_name(log_level_t level);
+
+/**
+ * Get the name of a module
+ * @param module Module
+ * @return Lowercase module name
+ */
+const char* logger_module_name(log_module_t module);
 
 /**
  * Shutdown logger and close file
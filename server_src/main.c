@@ -1,5 +1,7 @@
 #include "server.h"
 #include "logger.h"
+#include "config.h"
+#include "bot.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
@@ -7,7 +9,7 @@
 #include <sys/socket.h>
 
 void print_usage(const char *program_name) {
-    printf("Usage: %s <IP> <PORT> <MAX_ROOMS> <MAX_CLIENTS>\n", program_name);
+    printf("Usage: %s [OPTIONS] <IP> <PORT> <MAX_ROOMS> <MAX_CLIENTS>\n", program_name);
     printf("\n");
     printf("Arguments:\n");
     printf("  IP           - IP address to bind to (e.g., 127.0.0.1 or 0.0.0.0)\n");
@@ -15,8 +17,12 @@ void print_usage(const char *program_name) {
     printf("  MAX_ROOMS    - Maximum number of game rooms (e.g., 10)\n");
     printf("  MAX_CLIENTS  - Maximum number of connected clients (e.g., 50)\n");
     printf("\n");
+    config_print_usage();
+    printf("\n");
     printf("Example:\n");
     printf("  %s 127.0.0.1 10000 10 50\n", program_name);
+    printf("  %s --config server.conf --pong-timeout 10 0.0.0.0 10000 10 50\n", program_name);
+    printf("  %s --bench-games 10000 --log-level warning 127.0.0.1 10000 64 10\n", program_name);
 }
 
 void signal_handler(int signum) {
@@ -35,19 +41,34 @@ void signal_handler(int signum) {
     }
 }
 
+void reload_signal_handler(int signum) {
+    (void)signum;
+    // Applied by the PING thread within a second
+    config_request_reload();
+}
+
 int main(int argc, char *argv[]) {
+    // Load options (config file + flags) and collect positional arguments
+    char *args[4];
+    int arg_count = config_load(argc, argv, args, 4);
+    if (arg_count < 0) {
+        fprintf(stderr, "\n");
+        print_usage(argv[0]);
+        return 1;
+    }
+
     // Check arguments
-    if (argc != 5) {
+    if (arg_count != 4) {
         fprintf(stderr, "Error: Invalid number of arguments\n\n");
         print_usage(argv[0]);
         return 1;
     }
 
     // Parse arguments
-    const char *ip = argv[1];
-    int port = atoi(argv[2]);
-    int max_rooms = atoi(argv[3]);
-    int max_clients = atoi(argv[4]);
+    const char *ip = args[0];
+    int port = atoi(args[1]);
+    int max_rooms = atoi(args[2]);
+    int max_clients = atoi(args[3]);
 
     // Validate arguments
     if (port <= 0 || port > 65535) {
@@ -65,6 +86,13 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // Apply log levels before anything is logged
+    if (logger_configure(config_get()->log_level) != 0) {
+        fprintf(stderr, "Error: Invalid log_level '%s' (e.g. info or warning,room=debug)\n",
+                config_get()->log_level);
+        return 1;
+    }
+
     // Initialize logger
     if (logger_init("server.log") != 0) {
         fprintf(stderr, "Warning: Failed to initialize logger file, using stdout only\n");
@@ -74,9 +102,17 @@ int main(int argc, char *argv[]) {
     logger_log(LOG_INFO, "Configuration: IP=%s, Port=%d, MaxRooms=%d, MaxClients=%d",
                ip, port, max_rooms, max_clients);
 
+    runtime_config_t *config = config_get();
+    logger_log(LOG_INFO, "Timeouts: pong=%ds, ping_interval=%d-%ds, reconnect=%ds, inactivity=%ds, turn=%ds, max_errors=%d",
+               config->pong_timeout, config->pong_wait_interval, config->pong_wait_interval_max,
+               config->reconnect_timeout, config->inactivity_timeout, config->turn_timeout,
+               config->max_error_count);
+
     // Setup signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGHUP, reload_signal_handler);
+    signal(SIGPIPE, SIG_IGN);  // Writes to a closed peer fail with EPIPE instead
 
     // Initialize server
     if (server_init(ip, port, max_rooms, max_clients) != 0) {
@@ -85,8 +121,15 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // Run server
-    server_run();
+    // Run server, or play bot games in-process (MAX_ROOMS at a time) and quit
+    int exit_code = 0;
+    if (config->bench_games > 0) {
+        if (bot_benchmark(config->bench_games, max_rooms) != 0) {
+            exit_code = 1;
+        }
+    } else {
+        server_run();
+    }
 
     // Cleanup
     server_shutdown();
@@ -94,7 +137,7 @@ int main(int argc, char *argv[]) {
 
     printf("Server terminated\n");
 
-    // Use exit(0) instead of return 0 to terminate immediately
+    // Use exit() instead of return to terminate immediately
     // This prevents waiting for detached threads to finish sleeping
-    exit(0);
+    exit(exit_code);
 }
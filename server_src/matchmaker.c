@@ -0,0 +1,207 @@
+#define LOG_MODULE LOG_MODULE_ROOM
+
+#include "matchmaker.h"
+#include "room.h"
+#include "game.h"
+#include "logger.h"
+#include "eventlog.h"
+#include "config.h"
+#include "worker_pool.h"
+#include <stdio.h>
+#include <pthread.h>
+
+#define BOARD_SIZE_COUNT 3  // 4, 6, 8
+#define BUCKET_COUNT ((MAX_PLAYERS_PER_ROOM - 1) * BOARD_SIZE_COUNT)
+
+typedef struct {
+    pthread_mutex_t mutex;
+    client_t *waiting[MAX_PLAYERS_PER_ROOM];  // Never more than max_players - 1
+    int count;
+} bucket_t;
+
+static bucket_t buckets[BUCKET_COUNT];
+
+static int bucket_index(int max_players, int board_size) {
+    return (max_players - 2) * BOARD_SIZE_COUNT + (board_size - 4) / 2;
+}
+
+int matchmaker_init(void) {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (pthread_mutex_init(&buckets[i].mutex, NULL) != 0) {
+            logger_log(LOG_ERROR, "Failed to initialize matchmaker bucket %d", i);
+            return -1;
+        }
+        buckets[i].count = 0;
+    }
+
+    logger_log(LOG_INFO, "Matchmaker initialized (%d buckets)", BUCKET_COUNT);
+    return 0;
+}
+
+typedef struct {
+    client_t **players;
+    int count;
+    int board_size;
+    int room_id;
+    int result;
+} match_setup_t;
+
+// Seat the players, create the game and start it right away (room's worker)
+static void setup_match(void *arg) {
+    match_setup_t *setup = (match_setup_t *)arg;
+    client_t **players = setup->players;
+    int count = setup->count;
+
+    // Only an admin close can have removed the room meanwhile
+    room_t *room = room_get_by_id(setup->room_id);
+    if (room == NULL) {
+        return;
+    }
+    room_seat_players(room);
+
+    game_t *game = game_create(setup->board_size, room->players, count);
+    if (game == NULL) {
+        logger_log(LOG_ERROR, "Quick match: Failed to create game for room %d", room->room_id);
+        room_destroy(room);
+        return;
+    }
+    room->game = game;
+
+    // Everyone asked to play, so nobody has to send READY
+    for (int i = 0; i < count; i++) {
+        game_player_ready(game, players[i]);
+    }
+    game_start(game);
+    room->state = ROOM_STATE_PLAYING;
+
+    char message[MAX_MESSAGE_LENGTH];
+    snprintf(message, sizeof(message), "%s %d %s", CMD_ROOM_JOINED, room->room_id, room->name);
+    for (int i = 0; i < count; i++) {
+        players[i]->state = STATE_IN_GAME;
+        client_send_message(players[i], message);
+    }
+
+    game_format_start_message(game, message, sizeof(message));
+    room_broadcast(room, message);
+
+    room_start_turn(room);
+
+    logger_log(LOG_INFO, "Quick match: Room %d started with %d players (board %dx%d)",
+               room->room_id, count, setup->board_size, setup->board_size);
+    eventlog_record(EVENT_ROOM_CREATE, players[0]->client_id, room->room_id, count, setup->board_size);
+    setup->result = 0;
+}
+
+// Create a full room for the matched players and set it up on its worker
+static int start_match(client_t **players, int count, int board_size) {
+    room_t *room = room_create_full(QUICK_MATCH_ROOM_NAME, board_size, config_get()->turn_timeout, players, count);
+    if (room == NULL) {
+        return -1;
+    }
+
+    match_setup_t setup;
+    setup.players = players;
+    setup.count = count;
+    setup.board_size = board_size;
+    setup.room_id = room->room_id;
+    setup.result = -1;
+    worker_pool_run_sync(setup.room_id, setup_match, &setup);
+    return setup.result;
+}
+
+int matchmaker_enqueue(client_t *client, int max_players, int board_size) {
+    if (client == NULL || atomic_load(&client->match_bucket) >= 0) {
+        return -1;
+    }
+
+    int index = bucket_index(max_players, board_size);
+    bucket_t *bucket = &buckets[index];
+
+    pthread_mutex_lock(&bucket->mutex);
+
+    if (bucket->count + 1 < max_players) {
+        bucket->waiting[bucket->count++] = client;
+        atomic_store(&client->match_bucket, index);
+
+        // Reply under the lock, so the match that takes this client can't overtake it
+        char reply[MAX_MESSAGE_LENGTH];
+        snprintf(reply, sizeof(reply), "%s %d %d %d", CMD_QUICK_MATCH_WAITING,
+                 bucket->count, max_players, board_size);
+        client_send_message(client, reply);
+        int waiting = bucket->count;
+
+        pthread_mutex_unlock(&bucket->mutex);
+        logger_log(LOG_INFO, "Client %d (%s) waiting for quick match (%d/%d, board %d)",
+                   client->client_id, client->nickname, waiting, max_players, board_size);
+        return 0;
+    }
+
+    // This client fills the bucket
+    client_t *players[MAX_PLAYERS_PER_ROOM];
+    int count = 0;
+    for (int i = 0; i < bucket->count; i++) {
+        players[count++] = bucket->waiting[i];
+    }
+    players[count++] = client;
+    bucket->count = 0;
+
+    // Until the match is set up the players' next commands (and matchmaker_cancel())
+    // wait for it like for a queued room command
+    for (int i = 0; i < count; i++) {
+        coro_wait_add(&players[i]->pending_commands);
+    }
+
+    pthread_mutex_unlock(&bucket->mutex);
+
+    int result = start_match(players, count, board_size);
+
+    for (int i = 0; i < count; i++) {
+        atomic_store(&players[i]->match_bucket, -1);
+        coro_wait_done(&players[i]->pending_commands);
+    }
+
+    if (result != 0) {
+        logger_log(LOG_WARNING, "Quick match: Cannot create room for %d players", count);
+        for (int i = 0; i < count; i++) {
+            client_send_message(players[i], "ERROR ROOM_LIMIT Room limit reached");
+        }
+    }
+    return result;
+}
+
+int matchmaker_cancel(client_t *client) {
+    if (client == NULL) {
+        return 0;
+    }
+
+    int index = atomic_load(&client->match_bucket);
+    if (index < 0) {
+        return 0;
+    }
+
+    bucket_t *bucket = &buckets[index];
+    int removed = 0;
+
+    pthread_mutex_lock(&bucket->mutex);
+    for (int i = 0; i < bucket->count; i++) {
+        if (bucket->waiting[i] == client) {
+            // Keep arrival order (the first waiting player takes the first turn)
+            for (int j = i; j < bucket->count - 1; j++) {
+                bucket->waiting[j] = bucket->waiting[j + 1];
+            }
+            bucket->count--;
+            atomic_store(&client->match_bucket, -1);
+            removed = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&bucket->mutex);
+
+    if (removed) {
+        logger_log(LOG_INFO, "Client %d (%s) left the quick match queue", client->client_id, client->nickname);
+    } else {
+        // A match already took the client; it wins once it is set up
+        coro_wait_all(&client->pending_commands);
+    }
+    return removed;
+}
@@ -0,0 +1,46 @@
+#ifndef MATCHMAKER_H
+#define MATCHMAKER_H
+
+#include "client_handler.h"
+
+/**
+ * Matchmaker module - QUICK_MATCH queue
+ *
+ * Waiting players sit in one bucket per (max_players, board_size). The player
+ * who fills a bucket takes the others out of it and creates a full room; the
+ * room's worker then seats them, creates the game and starts it in one step,
+ * without LIST_ROOMS / JOIN_ROOM / START_GAME / READY round trips. Each bucket
+ * holds at most max_players - 1 clients, so queue operations and cancellation
+ * are constant time under a short per-bucket lock, never held during the setup.
+ */
+
+#define QUICK_MATCH_ROOM_NAME "quick_match"
+#define QUICK_MATCH_DEFAULT_PLAYERS 2
+#define QUICK_MATCH_DEFAULT_BOARD 4
+
+/**
+ * Initialize the buckets
+ * @return 0 on success, -1 on error
+ */
+int matchmaker_init(void);
+
+/**
+ * Queue a client, or assemble and start the match if it fills the bucket.
+ * Sends QUICK_MATCH_WAITING, or ROOM_JOINED + GAME_START + YOUR_TURN to the players.
+ * @param client Authenticated client in the lobby
+ * @param max_players Players per match (2 to MAX_PLAYERS_PER_ROOM)
+ * @param board_size Board size (4, 6 or 8)
+ * @return 0 if queued or matched, -1 if already queued or the match couldn't be created
+ */
+int matchmaker_enqueue(client_t *client, int max_players, int board_size);
+
+/**
+ * Take a client out of its bucket (call before any other room change and on disconnect,
+ * from the client's own handler). Once this returns, a match that already included
+ * the client is fully set up.
+ * @param client Client to remove
+ * @return 1 if the client was waiting, 0 otherwise
+ */
+int matchmaker_cancel(client_t *client);
+
+#endif /* MATCHMAKER_H */
@@ -8,12 +8,19 @@
 // Buffer sizes
 #define MAX_MESSAGE_LENGTH 1024
 #define MAX_NICK_LENGTH 32
+#define SESSION_TOKEN_LENGTH 32  // Hex characters (128 random bits)
 #define MAX_ROOM_NAME_LENGTH 64
 
 // Timeout constants (in seconds)
 #define PONG_TIMEOUT 5             // Expect PONG within 5 seconds
 #define PONG_WAIT_INTERVAL 5       // Wait 5 seconds after PONG before sending next PING
+#define PONG_WAIT_INTERVAL_MAX 10  // Heartbeat interval for steady connections (client read timeout is 15s)
 #define RECONNECT_TIMEOUT 90       // Reconnect timeout: server waits 90s for client
+#define TURN_TIMEOUT_MIN 5         // Shortest turn limit a room can ask for
+#define TURN_TIMEOUT_MAX 300       // Longest turn limit (0 = no limit)
+
+// Room event history (delta resync on RECONNECT)
+#define ROOM_EVENT_HISTORY 32      // Broadcasts kept per room for replay to reconnecting clients
 
 // Protocol commands (client to server)
 #define CMD_HELLO "HELLO"
@@ -26,6 +33,11 @@
 #define CMD_FLIP "FLIP"
 #define CMD_PONG "PONG"
 #define CMD_RECONNECT "RECONNECT"
+#define CMD_QUICK_MATCH "QUICK_MATCH"        // QUICK_MATCH [max_players] [board_size] | QUICK_MATCH CANCEL
+#define QUICK_MATCH_CANCEL "CANCEL"
+#define CMD_SPECTATE "SPECTATE"              // SPECTATE <room_id> (LEAVE_ROOM stops watching)
+#define CMD_ADD_BOT "ADD_BOT"                // ADD_BOT [skill] [think_ms] (room owner, before the game)
+#define CMD_LEADERBOARD "LEADERBOARD"        // LEADERBOARD (reply: LEADERBOARD <count> [<nick> <games> <wins> <pairs> <flips_per_game>]...)
 
 // Protocol commands (server to client)
 #define CMD_WELCOME "WELCOME"
@@ -51,6 +63,18 @@
 #define CMD_PING "PING"
 #define CMD_SERVER_SHUTDOWN "SERVER_SHUTDOWN"
 #define CMD_ERROR "ERROR"
+#define CMD_SEQ "SEQ"              // Envelope: SEQ <seq> <room event>
+#define CMD_QUICK_MATCH_WAITING "QUICK_MATCH_WAITING"      // <waiting> <max_players> <board_size>
+#define CMD_QUICK_MATCH_CANCELLED "QUICK_MATCH_CANCELLED"
+#define CMD_SPECTATING "SPECTATING"        // <room_id> <room_name>
+#define CMD_TURN_TIMEOUT "TURN_TIMEOUT"    // <nick> <next_nick> (turn time ran out)
+#define CMD_QUEUE_POSITION "QUEUE_POSITION"  // <position> <waiting> (server full, connection queued)
+
+// Pipelining: optional request ID prefix "#<id> " on commands, echoed on the replies
+#define REQUEST_ID_PREFIX "#"
+
+// Capabilities (optional last token of HELLO / RECONNECT)
+#define CAP_BINARY "BIN"           // Switch to length-prefixed binary framing after WELCOME (see codec.h)
 
 // Error codes
 #define ERR_INVALID_COMMAND "INVALID_COMMAND"
@@ -65,6 +89,9 @@
 #define ERR_NOT_ROOM_OWNER "NOT_ROOM_OWNER"
 #define ERR_GAME_NOT_STARTED "GAME_NOT_STARTED"
 #define ERR_INVALID_CARD "INVALID_CARD"
+#define ERR_NICK_IN_USE "NICK_IN_USE"
+#define ERR_ALREADY_QUEUED "ALREADY_QUEUED"
+#define ERR_NOT_QUEUED "NOT_QUEUED"
 
 // Error handling
 #define MAX_ERROR_COUNT 3  // Disconnect after 3 errors
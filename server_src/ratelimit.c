@@ -0,0 +1,104 @@
+#define LOG_MODULE LOG_MODULE_SERVER
+
+#include "ratelimit.h"
+#include "config.h"
+#include "clock.h"
+#include "logger.h"
+#include <pthread.h>
+
+// Tokens are kept in thousandths so a rate of N per second refills N per millisecond
+#define TOKEN_SCALE 1000
+
+typedef struct {
+    uint32_t addr;          // 0 = free slot
+    int32_t conn_tokens;
+    int32_t msg_tokens;
+    int64_t last_ms;        // Last refill
+} rate_slot_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    rate_slot_t slots[RATELIMIT_SHARD_SLOTS];
+} rate_shard_t;
+
+static rate_shard_t shards[RATELIMIT_SHARDS];
+
+static uint32_t addr_hash(uint32_t addr) {
+    addr ^= addr >> 16;
+    addr *= 0x45d9f3bu;
+    addr ^= addr >> 16;
+    return addr;
+}
+
+static int32_t refill(int32_t tokens, int64_t elapsed_ms, int rate, int burst) {
+    int64_t full = (int64_t)burst * TOKEN_SCALE;
+    int64_t value = tokens + elapsed_ms * rate;
+    return (int32_t)(value < full ? value : full);
+}
+
+// Slot of an address, taking a free or the longest idle one if it isn't there (shard locked)
+static rate_slot_t* find_slot(rate_shard_t *shard, uint32_t addr, uint32_t hash, const runtime_config_t *config) {
+    rate_slot_t *victim = NULL;
+    for (int i = 0; i < RATELIMIT_PROBES; i++) {
+        rate_slot_t *slot = &shard->slots[(hash + i) % RATELIMIT_SHARD_SLOTS];
+        if (slot->addr == addr) {
+            return slot;
+        }
+        if (victim == NULL || (victim->addr != 0 && (slot->addr == 0 || slot->last_ms < victim->last_ms))) {
+            victim = slot;
+        }
+    }
+
+    victim->addr = addr;
+    victim->conn_tokens = config->conn_burst * TOKEN_SCALE;
+    victim->msg_tokens = config->msg_burst * TOKEN_SCALE;
+    victim->last_ms = clock_now_ms();
+    return victim;
+}
+
+static int take_token(uint32_t addr, int is_message) {
+    const runtime_config_t *config = config_get();
+    int rate = is_message ? config->msg_rate : config->conn_rate;
+    if (addr == 0 || rate == 0) {
+        return 1;
+    }
+
+    uint32_t hash = addr_hash(addr);
+    rate_shard_t *shard = &shards[hash % RATELIMIT_SHARDS];
+    hash /= RATELIMIT_SHARDS;
+
+    pthread_mutex_lock(&shard->lock);
+    rate_slot_t *slot = find_slot(shard, addr, hash, config);
+
+    // Both buckets refill together, the slot keeps one timestamp
+    int64_t now = clock_now_ms();
+    int64_t elapsed = now - slot->last_ms;
+    if (elapsed > 0) {
+        slot->conn_tokens = refill(slot->conn_tokens, elapsed, config->conn_rate, config->conn_burst);
+        slot->msg_tokens = refill(slot->msg_tokens, elapsed, config->msg_rate, config->msg_burst);
+        slot->last_ms = now;
+    }
+
+    int32_t *tokens = is_message ? &slot->msg_tokens : &slot->conn_tokens;
+    int allowed = *tokens >= TOKEN_SCALE;
+    if (allowed) {
+        *tokens -= TOKEN_SCALE;
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    return allowed;
+}
+
+void ratelimit_init(void) {
+    for (int i = 0; i < RATELIMIT_SHARDS; i++) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+    }
+}
+
+int ratelimit_allow_connection(uint32_t addr) {
+    return take_token(addr, 0);
+}
+
+int ratelimit_allow_message(uint32_t addr) {
+    return take_token(addr, 1);
+}
@@ -0,0 +1,41 @@
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+#include <stdint.h>
+
+/**
+ * Rate limit module - per source IP token buckets
+ *
+ * Each IPv4 address has two token buckets, one for new connections and one
+ * for received messages (shared by all of its connections), refilled at the
+ * configured rates up to the configured bursts. Buckets live in a fixed table
+ * split into shards with their own locks; an address that isn't in its shard
+ * takes a free slot or the one idle the longest (an idle bucket is full, so
+ * nothing is lost). Checks never allocate, so a connection over the limit is
+ * refused before the server spends anything on it.
+ */
+
+#define RATELIMIT_SHARDS 64         // Independently locked parts of the table
+#define RATELIMIT_SHARD_SLOTS 64    // Addresses per shard
+#define RATELIMIT_PROBES 8          // Slots searched for an address
+
+/**
+ * Set up the shard locks (the table starts empty)
+ */
+void ratelimit_init(void);
+
+/**
+ * Take a token from an address's connection bucket
+ * @param addr IPv4 address in network byte order (0 = not limited)
+ * @return 1 if the connection may proceed, 0 if the address is over its limit
+ */
+int ratelimit_allow_connection(uint32_t addr);
+
+/**
+ * Take a token from an address's message bucket
+ * @param addr IPv4 address in network byte order (0 = not limited)
+ * @return 1 if the message may be handled, 0 if the address is over its limit
+ */
+int ratelimit_allow_message(uint32_t addr);
+
+#endif /* RATELIMIT_H */
@@ -1,33 +1,82 @@
+#define LOG_MODULE LOG_MODULE_ROOM
+
 #include "room.h"
 #include "logger.h"
 #include "protocol.h"
 #include "game.h"
+#include "timer.h"
+#include "clock.h"
+#include "worker_pool.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <pthread.h>
 #include <unistd.h>
 
 static room_t **rooms = NULL;
 static int max_rooms = 0;
-static int next_room_id = 1;
 static pthread_mutex_t rooms_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Room IDs encode their slot: id = generation * max_rooms + slot + 1. The slot's
+// generation grows on every reuse, so an old ID never resolves to a newer room.
+static unsigned int *slot_generations = NULL;
+static int *free_slots = NULL;  // Stack of unused slots
+static int free_slot_count = 0;
+
+static int room_id_for_slot(int slot) {
+    return (int)slot_generations[slot] * max_rooms + slot + 1;
+}
+
+// Slot a room ID refers to, or -1 if it's out of range (rooms_mutex held)
+static int room_slot_for_id(int room_id) {
+    if (room_id <= 0) {
+        return -1;
+    }
+    return (room_id - 1) % max_rooms;
+}
+
+// Sends decided under rooms_mutex and made once it's released, so a slow socket
+// never stalls the threads waiting for the lock
+typedef struct {
+    client_t *recipients[2 * MAX_PLAYERS_PER_ROOM];
+    const char *messages[2 * MAX_PLAYERS_PER_ROOM];
+    int count;
+    char event[MAX_MESSAGE_LENGTH];  // Copy of the stamped broadcast (the room may be freed first)
+} room_outbox_t;
+
 // Forward declaration for internal broadcast function
-static void room_broadcast_except_locked(room_t *room, const char *message, client_t *exclude_client);
+static void room_broadcast_except_locked(room_t *room, const char *message, client_t *exclude_client,
+                                         room_outbox_t *outbox);
+static void room_outbox_flush(room_outbox_t *outbox);
 
 int room_system_init(int max_rooms_count) {
     pthread_mutex_lock(&rooms_mutex);
 
     max_rooms = max_rooms_count;
     rooms = (room_t **)calloc(max_rooms, sizeof(room_t *));
+    slot_generations = (unsigned int *)calloc(max_rooms, sizeof(unsigned int));
+    free_slots = (int *)malloc(max_rooms * sizeof(int));
 
-    if (rooms == NULL) {
+    if (rooms == NULL || slot_generations == NULL || free_slots == NULL) {
         logger_log(LOG_ERROR, "Failed to allocate memory for rooms");
+        free(rooms);
+        free(slot_generations);
+        free(free_slots);
+        rooms = NULL;
+        slot_generations = NULL;
+        free_slots = NULL;
         pthread_mutex_unlock(&rooms_mutex);
         return -1;
     }
 
+    // Lowest slot on top, so the first rooms get IDs 1, 2, 3...
+    for (int i = 0; i < max_rooms; i++) {
+        free_slots[i] = max_rooms - 1 - i;
+    }
+    free_slot_count = max_rooms;
+
     logger_log(LOG_INFO, "Room system initialized (max_rooms=%d)", max_rooms);
     pthread_mutex_unlock(&rooms_mutex);
     return 0;
@@ -54,6 +103,8 @@ void room_system_shutdown(void) {
                     room->game = NULL;
                 }
 
+                spectator_close(room->spectators);
+
                 logger_log(LOG_INFO, "Room %d destroyed during shutdown", room->room_id);
                 free(room);
                 rooms[i] = NULL;
@@ -62,56 +113,39 @@ void room_system_shutdown(void) {
         free(rooms);
         rooms = NULL;
     }
+    free(slot_generations);
+    free(free_slots);
+    slot_generations = NULL;
+    free_slots = NULL;
+    free_slot_count = 0;
 
     logger_log(LOG_INFO, "Room system shutdown complete");
 }
 
-room_t* room_create(const char *name, int max_players, int board_size, client_t *owner) {
-    if (name == NULL || owner == NULL) {
-        return NULL;
-    }
-
-    if (max_players < 2 || max_players > MAX_PLAYERS_PER_ROOM) {
-        logger_log(LOG_WARNING, "Invalid max_players: %d (must be 2-4)", max_players);
-        return NULL;
-    }
-
-    if (board_size < 4 || board_size > 8 || board_size % 2 != 0) {
-        logger_log(LOG_WARNING, "Invalid board_size: %d (must be 4, 6, or 8)", board_size);
-        return NULL;
-    }
-
-    pthread_mutex_lock(&rooms_mutex);
-
-    // Find free slot
-    int free_slot = -1;
-    for (int i = 0; i < max_rooms; i++) {
-        if (rooms[i] == NULL) {
-            free_slot = i;
-            break;
-        }
-    }
-
-    if (free_slot == -1) {
+// Take a free slot and publish a room with the owner in seat 0 (rooms_mutex held)
+static room_t* room_alloc_locked(const char *name, int max_players, int board_size, int turn_seconds,
+                                 client_t *owner) {
+    if (free_slot_count == 0) {
         logger_log(LOG_WARNING, "No free room slots available");
-        pthread_mutex_unlock(&rooms_mutex);
         return NULL;
     }
+    int free_slot = free_slots[free_slot_count - 1];
 
     // Allocate room
     room_t *room = (room_t *)calloc(1, sizeof(room_t));
     if (room == NULL) {
         logger_log(LOG_ERROR, "Failed to allocate memory for room");
-        pthread_mutex_unlock(&rooms_mutex);
         return NULL;
     }
 
     // Initialize room
-    room->room_id = next_room_id++;
+    free_slot_count--;
+    room->room_id = room_id_for_slot(free_slot);
     strncpy(room->name, name, MAX_ROOM_NAME_LENGTH - 1);
     room->name[MAX_ROOM_NAME_LENGTH - 1] = '\0';
     room->max_players = max_players;
     room->board_size = board_size;
+    room->turn_seconds = turn_seconds;
     room->player_count = 0;
     room->state = ROOM_STATE_WAITING;
     room->owner = owner;
@@ -124,30 +158,90 @@ room_t* room_create(const char *name, int max_players, int board_size, client_t
     // Add creator to room
     room->players[0] = owner;
     room->player_count = 1;
-    owner->room = room;
-    owner->state = STATE_IN_ROOM;
 
     rooms[free_slot] = room;
 
     logger_log(LOG_INFO, "Room created: id=%d, name='%s', max_players=%d, owner=%s",
                room->room_id, room->name, room->max_players, owner->nickname);
+    return room;
+}
+
+static int room_check_params(int max_players, int board_size) {
+    if (max_players < 2 || max_players > MAX_PLAYERS_PER_ROOM) {
+        logger_log(LOG_WARNING, "Invalid max_players: %d (must be 2-4)", max_players);
+        return -1;
+    }
+
+    if (board_size < 4 || board_size > 8 || board_size % 2 != 0) {
+        logger_log(LOG_WARNING, "Invalid board_size: %d (must be 4, 6, or 8)", board_size);
+        return -1;
+    }
+    return 0;
+}
+
+room_t* room_create(const char *name, int max_players, int board_size, int turn_seconds, client_t *owner) {
+    if (name == NULL || owner == NULL || room_check_params(max_players, board_size) != 0) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&rooms_mutex);
+
+    room_t *room = room_alloc_locked(name, max_players, board_size, turn_seconds, owner);
+    if (room != NULL) {
+        owner->room = room;
+        atomic_store(&owner->room_mailbox, room->room_id);
+        owner->room_slot = 0;
+        owner->state = STATE_IN_ROOM;
+    }
 
     pthread_mutex_unlock(&rooms_mutex);
     return room;
 }
 
-room_t* room_get_by_id(int room_id) {
+room_t* room_create_full(const char *name, int board_size, int turn_seconds, client_t **players, int count) {
+    if (name == NULL || players == NULL || room_check_params(count, board_size) != 0) {
+        return NULL;
+    }
+
     pthread_mutex_lock(&rooms_mutex);
 
-    for (int i = 0; i < max_rooms; i++) {
-        if (rooms[i] != NULL && rooms[i]->room_id == room_id) {
-            pthread_mutex_unlock(&rooms_mutex);
-            return rooms[i];
+    room_t *room = room_alloc_locked(name, count, board_size, turn_seconds, players[0]);
+    if (room != NULL) {
+        for (int i = 0; i < count; i++) {
+            room->players[i] = players[i];
+            atomic_store(&players[i]->room_mailbox, room->room_id);
         }
+        room->player_count = count;
     }
 
     pthread_mutex_unlock(&rooms_mutex);
-    return NULL;
+    return room;
+}
+
+void room_seat_players(room_t *room) {
+    pthread_mutex_lock(&rooms_mutex);
+    for (int i = 0; i < MAX_PLAYERS_PER_ROOM; i++) {
+        client_t *player = room->players[i];
+        if (player != NULL) {
+            player->room = room;
+            player->room_slot = i;
+            player->state = STATE_IN_ROOM;
+        }
+    }
+    pthread_mutex_unlock(&rooms_mutex);
+}
+
+room_t* room_get_by_id(int room_id) {
+    pthread_mutex_lock(&rooms_mutex);
+
+    room_t *room = NULL;
+    int slot = room_slot_for_id(room_id);
+    if (slot >= 0 && rooms[slot] != NULL && rooms[slot]->room_id == room_id) {
+        room = rooms[slot];
+    }
+
+    pthread_mutex_unlock(&rooms_mutex);
+    return room;
 }
 
 int room_add_player(room_t *room, client_t *client) {
@@ -179,6 +273,8 @@ int room_add_player(room_t *room, client_t *client) {
             room->players[i] = client;
             room->player_count++;
             client->room = room;
+            atomic_store(&client->room_mailbox, room->room_id);
+            client->room_slot = i;
             client->state = STATE_IN_ROOM;
 
             logger_log(LOG_INFO, "Client %d (%s) joined room %d",
@@ -198,6 +294,7 @@ int room_remove_player(room_t *room, client_t *client) {
         return -1;
     }
 
+    room_outbox_t outbox = { .count = 0 };
     pthread_mutex_lock(&rooms_mutex);
 
     // Check if this client is the owner
@@ -221,6 +318,7 @@ int room_remove_player(room_t *room, client_t *client) {
                           room->room_id, room->player_count);
 
                 game_t *game = (game_t *)room->game;
+                stats_record_game(game, client);
 
                 // Give forfeit win to player(s) with highest score
                 int remaining_pairs = game->total_pairs - game->matched_pairs;
@@ -272,7 +370,7 @@ int room_remove_player(room_t *room, client_t *client) {
                 }
 
                 // Notify remaining players (use _locked version - mutex already held)
-                room_broadcast_except_locked(room, game_cancel_msg, NULL);
+                room_broadcast_except_locked(room, game_cancel_msg, NULL, &outbox);
 
                 logger_log(LOG_INFO, "Room %d: Game ended by forfeit - sent final scores to remaining players", room->room_id);
 
@@ -306,6 +404,7 @@ int room_remove_player(room_t *room, client_t *client) {
 
                 // Unlock mutex and destroy room
                 pthread_mutex_unlock(&rooms_mutex);
+                room_outbox_flush(&outbox);
                 room_destroy(room);
 
                 logger_log(LOG_INFO, "Room %d destroyed after forfeit", forfeit_room_id);
@@ -325,7 +424,7 @@ int room_remove_player(room_t *room, client_t *client) {
                         char ownership_msg[MAX_MESSAGE_LENGTH];
                         snprintf(ownership_msg, sizeof(ownership_msg),
                                 "ROOM_OWNER_CHANGED %s", room->owner->nickname);
-                        room_broadcast_except_locked(room, ownership_msg, NULL);
+                        room_broadcast_except_locked(room, ownership_msg, NULL, &outbox);
                         break;
                     }
                 }
@@ -342,7 +441,7 @@ int room_remove_player(room_t *room, client_t *client) {
                     char room_closed_msg[MAX_MESSAGE_LENGTH];
                     snprintf(room_closed_msg, sizeof(room_closed_msg),
                             "ROOM_CLOSED Owner left");
-                    room_broadcast_except_locked(room, room_closed_msg, NULL);
+                    room_broadcast_except_locked(room, room_closed_msg, NULL, &outbox);
 
                     // Remove all players from room
                     for (int j = 0; j < MAX_PLAYERS_PER_ROOM; j++) {
@@ -353,6 +452,7 @@ int room_remove_player(room_t *room, client_t *client) {
                     }
 
                     pthread_mutex_unlock(&rooms_mutex);
+                    room_outbox_flush(&outbox);
                     room_destroy(room);
                     logger_log(LOG_INFO, "Room %d destroyed after owner left", room_id);
                     return 0;
@@ -365,6 +465,7 @@ int room_remove_player(room_t *room, client_t *client) {
 
                 // Unlock mutex before calling room_destroy (it will lock again)
                 pthread_mutex_unlock(&rooms_mutex);
+                room_outbox_flush(&outbox);
                 room_destroy(room);
 
                 logger_log(LOG_INFO, "Room %d destroyed (empty)", room_id);
@@ -372,6 +473,7 @@ int room_remove_player(room_t *room, client_t *client) {
             }
 
             pthread_mutex_unlock(&rooms_mutex);
+            room_outbox_flush(&outbox);
             return 0;
         }
     }
@@ -381,6 +483,125 @@ int room_remove_player(room_t *room, client_t *client) {
     return -1;
 }
 
+int room_add_spectator(int room_id, client_t *client) {
+    if (client == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&rooms_mutex);
+
+    int slot = room_slot_for_id(room_id);
+    room_t *room = NULL;
+    if (slot >= 0 && rooms[slot] != NULL && rooms[slot]->room_id == room_id) {
+        room = rooms[slot];
+    }
+    if (room == NULL) {
+        pthread_mutex_unlock(&rooms_mutex);
+        return -1;
+    }
+
+    if (room->spectators == NULL) {
+        room->spectators = spectator_list_create(room->room_id);
+    }
+
+    // Events are published only by this worker, so nothing slips between the snapshot
+    // and the first event the fan-out thread delivers
+    if (spectator_attach(room->spectators, client, room->event_seq) != 0) {
+        pthread_mutex_unlock(&rooms_mutex);
+        return -1;
+    }
+
+    char reply[MAX_MESSAGE_LENGTH];
+    char snapshot[MAX_MESSAGE_LENGTH];
+    snprintf(reply, sizeof(reply), "%s %d %s", CMD_SPECTATING, room->room_id, room->name);
+    snapshot[0] = '\0';
+
+    game_t *game = (game_t *)room->game;
+    if (game != NULL && game->state == GAME_STATE_PLAYING) {
+        int prefix = snprintf(snapshot, sizeof(snapshot), "%s %u ", CMD_SEQ, room->event_seq);
+        if (game_format_state_message(game, snapshot + prefix, sizeof(snapshot) - prefix) != 0) {
+            snapshot[0] = '\0';
+        }
+    }
+
+    pthread_mutex_unlock(&rooms_mutex);
+
+    client_send_message(client, reply);
+    if (snapshot[0] != '\0') {
+        client_send_message(client, snapshot);
+    }
+    return 0;
+}
+
+typedef struct {
+    worker_task_t task;
+    int room_id;
+    unsigned int timer_id;
+} turn_timeout_t;
+
+// Pass the turn of a player who let the turn timer run out. Runs where the room's
+// commands run (its worker, or inline work without workers), so the room can't be
+// destroyed while it's looked up and used here.
+static void run_turn_timeout(worker_task_t *task) {
+    turn_timeout_t *timeout = (turn_timeout_t *)task;
+    room_t *room = room_get_by_id(timeout->room_id);
+    unsigned int timer_id = timeout->timer_id;
+    free(timeout);
+
+    // The room is gone, the game ended or a newer turn re-armed the timer
+    if (room == NULL || room->game == NULL || room->turn_timer != timer_id) {
+        return;
+    }
+
+    game_t *game = (game_t *)room->game;
+    client_t *player = game_get_current_player(game);
+    if (player == NULL || game_skip_turn(game) != 0) {
+        return;
+    }
+    client_t *next_player = game_get_current_player(game);
+
+    char message[MAX_MESSAGE_LENGTH];
+    snprintf(message, sizeof(message), "%s %s %s", CMD_TURN_TIMEOUT, player->nickname, next_player->nickname);
+    room_broadcast(room, message);
+
+    logger_log(LOG_INFO, "Room %d: Turn of %s timed out after %d seconds, turn passed to %s",
+               room->room_id, player->nickname, room->turn_seconds, next_player->nickname);
+
+    room_start_turn(room);
+}
+
+// Timer thread: the game belongs to the room's worker, so the expiry runs there
+static void turn_timer_fired(int room_id, unsigned int timer_id) {
+    turn_timeout_t *timeout = (turn_timeout_t *)malloc(sizeof(turn_timeout_t));
+    if (timeout == NULL) {
+        logger_log(LOG_ERROR, "Room %d: Failed to allocate turn timeout", room_id);
+        return;
+    }
+
+    timeout->task.run = run_turn_timeout;
+    timeout->room_id = room_id;
+    timeout->timer_id = timer_id;
+    if (worker_pool_submit(room_id, &timeout->task) != 0) {
+        // No workers: run it here under the inline lock (see timer_callback_t)
+        worker_pool_run_inline(&timeout->task);
+    }
+}
+
+void room_start_turn(room_t *room) {
+    client_t *player = game_get_current_player((game_t *)room->game);
+    if (player == NULL) {
+        return;
+    }
+
+    client_send_message(player, CMD_YOUR_TURN);
+
+    // Re-arming replaces the previous turn's timer, which then fires as a no-op
+    room->turn_timer = 0;
+    if (room->turn_seconds > 0) {
+        room->turn_timer = timer_schedule(CLOCK_MS(room->turn_seconds), turn_timer_fired, room->room_id);
+    }
+}
+
 void room_destroy(room_t *room) {
     if (room == NULL) {
         return;
@@ -396,14 +617,22 @@ void room_destroy(room_t *room) {
         }
     }
 
-    // Remove room from global rooms array
-    for (int i = 0; i < max_rooms; i++) {
-        if (rooms[i] == room) {
-            rooms[i] = NULL;
-            break;
+    // Remove room from global rooms array and retire its ID
+    int slot = room_slot_for_id(room->room_id);
+    if (slot >= 0 && rooms[slot] == room) {
+        rooms[slot] = NULL;
+        if (slot_generations[slot] < (unsigned int)((INT_MAX - max_rooms) / max_rooms)) {
+            slot_generations[slot]++;
+        } else {
+            slot_generations[slot] = 0;  // IDs wrap only after ~2^31 rooms
         }
+        free_slots[free_slot_count++] = slot;
     }
 
+    // Spectators get the room's last events, then LEFT_ROOM
+    spectator_close(room->spectators);
+    room->spectators = NULL;
+
     logger_log(LOG_INFO, "Room %d destroyed", room->room_id);
 
     pthread_mutex_unlock(&rooms_mutex);
@@ -425,6 +654,95 @@ room_t** room_get_all(int *count) {
     return rooms;
 }
 
+int room_get_info_all(room_info_t *out, int max_count) {
+    pthread_mutex_lock(&rooms_mutex);
+
+    int count = 0;
+    for (int i = 0; i < max_rooms && count < max_count; i++) {
+        room_t *room = rooms[i];
+        if (room == NULL) {
+            continue;
+        }
+
+        room_info_t *info = &out[count++];
+        memset(info, 0, sizeof(*info));
+        info->room_id = room->room_id;
+        snprintf(info->name, sizeof(info->name), "%s", room->name);
+        info->state = room->state;
+        info->player_count = room->player_count;
+        info->max_players = room->max_players;
+        info->board_size = room->board_size;
+        info->event_seq = room->event_seq;
+        info->spectators = spectator_count(room->spectators);
+        info->turn_seconds = room->turn_seconds;
+        if (room->owner != NULL) {
+            snprintf(info->owner, sizeof(info->owner), "%s", room->owner->nickname);
+        }
+
+        for (int j = 0; j < MAX_PLAYERS_PER_ROOM; j++) {
+            if (room->players[j] != NULL) {
+                info->player_ids[j] = room->players[j]->client_id;
+                snprintf(info->players[j], sizeof(info->players[j]), "%s", room->players[j]->nickname);
+            }
+        }
+
+        game_t *game = (game_t *)room->game;
+        if (game != NULL) {
+            info->has_game = 1;
+            info->game_state = game->state;
+            info->current_player = game->current_player_index;
+            info->matched_pairs = game->matched_pairs;
+            info->total_pairs = game->total_pairs;
+            for (int j = 0; j < game->player_count && j < MAX_PLAYERS_PER_ROOM; j++) {
+                info->scores[j] = game->player_scores[j];
+                info->ready[j] = game->player_ready[j];
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&rooms_mutex);
+    return count;
+}
+
+void room_close(room_t *room, const char *reason) {
+    if (room == NULL) {
+        return;
+    }
+
+    room_outbox_t outbox = { .count = 0 };
+    pthread_mutex_lock(&rooms_mutex);
+
+    int room_id = room->room_id;
+    char room_closed_msg[MAX_MESSAGE_LENGTH];
+    snprintf(room_closed_msg, sizeof(room_closed_msg), "ROOM_CLOSED %s", reason);
+    room_broadcast_except_locked(room, room_closed_msg, NULL, &outbox);
+
+    // Send everyone back to the lobby
+    for (int i = 0; i < MAX_PLAYERS_PER_ROOM; i++) {
+        client_t *player = room->players[i];
+        if (player != NULL) {
+            outbox.recipients[outbox.count] = player;
+            outbox.messages[outbox.count] = "LEFT_ROOM";
+            outbox.count++;
+            player->room = NULL;
+            player->state = STATE_IN_LOBBY;
+            room->players[i] = NULL;
+        }
+    }
+    room->player_count = 0;
+
+    if (room->game != NULL) {
+        game_destroy((game_t *)room->game);
+        room->game = NULL;
+    }
+
+    pthread_mutex_unlock(&rooms_mutex);
+    room_outbox_flush(&outbox);
+    room_destroy(room);
+
+    logger_log(LOG_INFO, "Room %d closed (%s)", room_id, reason);
+}
+
 int room_get_list_message(char *buffer, int buffer_size) {
     pthread_mutex_lock(&rooms_mutex);
 
@@ -475,19 +793,42 @@ int room_get_list_message(char *buffer, int buffer_size) {
     return offset;
 }
 
-// Internal function: broadcast without locking (assumes mutex is already held)
-static void room_broadcast_except_locked(room_t *room, const char *message, client_t *exclude_client) {
+// Internal function: stamp a broadcast (mutex held) and queue its sends in the outbox.
+// One broadcast per outbox; the caller flushes it after unlocking.
+static void room_broadcast_except_locked(room_t *room, const char *message, client_t *exclude_client,
+                                         room_outbox_t *outbox) {
     if (room == NULL || message == NULL) {
         return;
     }
 
+    // Stamp event with next sequence number and keep it in the history ring
+    room->event_seq++;
+    room_event_t *event = &room->events[room->event_seq % ROOM_EVENT_HISTORY];
+    event->seq = room->event_seq;
+    event->exclude_client_id = (exclude_client != NULL) ? exclude_client->client_id : 0;
+    snprintf(event->message, sizeof(event->message), "%s %u %s", CMD_SEQ, event->seq, message);
+
+    // Queued for the fan-out thread, so spectators never hold the room lock or delay players
+    spectator_publish(room->spectators, event->seq, event->message);
+
+    snprintf(outbox->event, sizeof(outbox->event), "%s", event->message);
     for (int i = 0; i < MAX_PLAYERS_PER_ROOM; i++) {
         if (room->players[i] != NULL && room->players[i] != exclude_client) {
-            client_send_message(room->players[i], message);
+            outbox->recipients[outbox->count] = room->players[i];
+            outbox->messages[outbox->count] = outbox->event;
+            outbox->count++;
         }
     }
 }
 
+// Send what was queued under the lock, all recipients in one batch (single submission
+// with io_uring). The recipients can't be freed meanwhile: clients leave a room and are
+// freed only through its worker, which is the thread flushing.
+static void room_outbox_flush(room_outbox_t *outbox) {
+    client_send_batch(outbox->recipients, outbox->messages, outbox->count);
+    outbox->count = 0;
+}
+
 void room_broadcast(room_t *room, const char *message) {
     room_broadcast_except(room, message, NULL);
 }
@@ -497,7 +838,139 @@ void room_broadcast_except(room_t *room, const char *message, client_t *exclude_
         return;
     }
 
+    room_outbox_t outbox = { .count = 0 };
     pthread_mutex_lock(&rooms_mutex);
-    room_broadcast_except_locked(room, message, exclude_client);
+    room_broadcast_except_locked(room, message, exclude_client, &outbox);
     pthread_mutex_unlock(&rooms_mutex);
+    room_outbox_flush(&outbox);
+}
+
+// Full room/game state for a reconnected client, stamped with the current room sequence
+// number so the client can resume delta resync from there (rooms_mutex held).
+// Returns the number of messages written to out.
+static int room_format_snapshot_locked(room_t *room, client_t *client, char out[2][MAX_MESSAGE_LENGTH]) {
+    int prefix = snprintf(out[0], MAX_MESSAGE_LENGTH, "%s %u ", CMD_SEQ, room->event_seq);
+    game_t *game = (game_t *)room->game;
+
+    if (game != NULL && game->state == GAME_STATE_PLAYING) {
+        // Game is actively playing - send full game state
+        if (game_format_state_message(game, out[0] + prefix, MAX_MESSAGE_LENGTH - prefix) != 0) {
+            return 0;
+        }
+        logger_log(LOG_INFO, "Client %d: Sent GAME_STATE for reconnection", client->client_id);
+        return 1;
+    }
+
+    // In room, no game running - send room info
+    snprintf(out[0] + prefix, MAX_MESSAGE_LENGTH - prefix, "%s %d %s", CMD_ROOM_JOINED, room->room_id, room->name);
+    if (game == NULL || game->state != GAME_STATE_WAITING) {
+        logger_log(LOG_INFO, "Client %d: Sent ROOM_JOINED for reconnection", client->client_id);
+        return 1;
+    }
+
+    // Game created but waiting for READY - remind about READY
+    snprintf(out[1], MAX_MESSAGE_LENGTH, "%s %d Send READY when you are prepared to play",
+             CMD_GAME_CREATED, game->board_size);
+    logger_log(LOG_INFO, "Client %d: Sent ROOM_JOINED and GAME_CREATED for reconnection", client->client_id);
+    return 2;
+}
+
+int room_reattach_player(room_t *room, client_t *old_client, client_t *new_client, unsigned int last_seq) {
+    if (room == NULL || old_client == NULL || new_client == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&rooms_mutex);
+
+    // The seat hints point straight at the player's slots; scan only if they went stale
+    int slot = old_client->room_slot;
+    if (slot >= 0 && slot < MAX_PLAYERS_PER_ROOM && room->players[slot] == old_client) {
+        room->players[slot] = new_client;
+    } else {
+        slot = -1;
+        for (int i = 0; i < MAX_PLAYERS_PER_ROOM; i++) {
+            if (room->players[i] == old_client) {
+                room->players[i] = new_client;
+                slot = i;
+            }
+        }
+        if (slot >= 0) {
+            logger_log(LOG_WARNING, "Client %d: Stale room seat hint in room %d (found at %d)",
+                      new_client->client_id, room->room_id, slot);
+        }
+    }
+    new_client->room_slot = slot;
+    if (room->owner == old_client) {
+        room->owner = new_client;
+    }
+
+    game_t *game = (game_t *)room->game;
+    if (game != NULL) {
+        slot = old_client->game_slot;
+        if (slot >= 0 && slot < game->player_count && game->players[slot] == old_client) {
+            game->players[slot] = new_client;
+        } else {
+            slot = -1;
+            for (int i = 0; i < game->player_count; i++) {
+                if (game->players[i] == old_client) {
+                    game->players[i] = new_client;
+                    slot = i;
+                }
+            }
+            if (slot >= 0) {
+                logger_log(LOG_WARNING, "Client %d: Stale game seat hint (found at %d)",
+                          new_client->client_id, slot);
+            }
+        }
+        new_client->game_slot = slot;
+    }
+
+    // Replay or snapshot go out as one batch after the lock is released - sends to the
+    // same socket stay in order, and only this worker adds events, so the ring entries
+    // and the snapshot's SEQ stay valid until then
+    client_t *recipients[ROOM_EVENT_HISTORY + 1];
+    const char *messages[ROOM_EVENT_HISTORY + 1];
+    char snapshot[2][MAX_MESSAGE_LENGTH];
+    int count = 0;
+    int replayed = -1;
+
+    // Delta resync is only possible if every missed event is still in the ring
+    unsigned int missed = room->event_seq - last_seq;
+    if (last_seq == 0 || last_seq > room->event_seq || missed > ROOM_EVENT_HISTORY) {
+        logger_log(LOG_INFO, "Room %d: Client %d needs full snapshot (last_seq=%u, room_seq=%u)",
+                  room->room_id, new_client->client_id, last_seq, room->event_seq);
+        int snapshot_count = room_format_snapshot_locked(room, new_client, snapshot);
+        for (int i = 0; i < snapshot_count; i++) {
+            recipients[count] = new_client;
+            messages[count] = snapshot[i];
+            count++;
+        }
+    } else {
+        replayed = 0;
+        for (unsigned int seq = last_seq + 1; seq <= room->event_seq; seq++) {
+            room_event_t *event = &room->events[seq % ROOM_EVENT_HISTORY];
+            if (event->seq != seq || event->exclude_client_id == new_client->client_id) {
+                continue;
+            }
+            recipients[count] = new_client;
+            messages[count] = event->message;
+            count++;
+            replayed++;
+        }
+        logger_log(LOG_INFO, "Room %d: Replayed %d missed event(s) to client %d (seq %u..%u)",
+                  room->room_id, replayed, new_client->client_id, last_seq + 1, room->event_seq);
+    }
+
+    // The turn may be the reconnected player's
+    if (game != NULL && game->state == GAME_STATE_PLAYING && game_get_current_player(game) == new_client) {
+        recipients[count] = new_client;
+        messages[count] = CMD_YOUR_TURN;
+        count++;
+        logger_log(LOG_INFO, "Client %d: It's your turn after reconnection", new_client->client_id);
+    }
+
+    pthread_mutex_unlock(&rooms_mutex);
+
+    client_send_batch(recipients, messages, count);
+    return replayed;
 }
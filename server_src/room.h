@@ -2,9 +2,14 @@
 #define ROOM_H
 
 #include "client_handler.h"
+#include "spectator.h"
 
 /**
  * Room module - manages lobby and game rooms
+ *
+ * Rooms live in a fixed slot array. A room ID maps straight to its slot and
+ * carries the slot's generation, so create (free-slot stack), lookup and
+ * destroy are constant time and a stale ID never matches a newer room.
  */
 
 // Forward declaration for game
@@ -19,6 +24,12 @@ typedef enum {
     ROOM_STATE_FINISHED    // Game finished
 } room_state_t;
 
+typedef struct {
+    unsigned int seq;            // Sequence number of this event (0 = empty slot)
+    int exclude_client_id;       // Client the broadcast skipped (0 = none)
+    char message[MAX_MESSAGE_LENGTH];  // Stamped message as sent ("SEQ <seq> ...")
+} room_event_t;
+
 typedef struct room_s {
     int room_id;
     char name[MAX_ROOM_NAME_LENGTH];
@@ -29,8 +40,36 @@ typedef struct room_s {
     room_state_t state;
     client_t *owner;  // Room creator
     struct game_s *game;  // Game instance (NULL if no game)
+    unsigned int event_seq;  // Sequence number of the last broadcast
+    room_event_t events[ROOM_EVENT_HISTORY];  // Ring of recent broadcasts for delta resync
+    spectator_list_t *spectators;  // Read-only watchers (NULL until the first SPECTATE)
+    int turn_seconds;  // Time limit per turn (0 = unlimited)
+    unsigned int turn_timer;  // Timer of the running turn (0 = none, see room_start_turn)
 } room_t;
 
+// Copy of a room's state for introspection (taken under the room lock)
+typedef struct {
+    int room_id;
+    char name[MAX_ROOM_NAME_LENGTH];
+    room_state_t state;
+    int player_count;
+    int max_players;
+    int board_size;
+    unsigned int event_seq;
+    int spectators;
+    int turn_seconds;
+    char owner[MAX_NICK_LENGTH];
+    int player_ids[MAX_PLAYERS_PER_ROOM];  // 0 = empty seat
+    char players[MAX_PLAYERS_PER_ROOM][MAX_NICK_LENGTH];
+    int has_game;
+    int game_state;              // game_state_t (if has_game)
+    int current_player;          // Seat index whose turn it is
+    int matched_pairs;
+    int total_pairs;
+    int scores[MAX_PLAYERS_PER_ROOM];
+    int ready[MAX_PLAYERS_PER_ROOM];
+} room_info_t;
+
 /**
  * Initialize room system
  * @param max_rooms Maximum number of rooms
@@ -48,13 +87,33 @@ void room_system_shutdown(void);
  * @param name Room name
  * @param max_players Maximum number of players (2-4)
  * @param board_size Board size for game (4, 6, or 8)
+ * @param turn_seconds Time limit per turn (0 = unlimited)
  * @param owner Room creator
  * @return Pointer to room or NULL on error
  */
-room_t* room_create(const char *name, int max_players, int board_size, client_t *owner);
+room_t* room_create(const char *name, int max_players, int board_size, int turn_seconds, client_t *owner);
+
+/**
+ * Create a room whose seats are all taken by the given players, so nobody else can
+ * join it before it is set up. From now on the players' commands are routed to the
+ * room's worker; room_seat_players() puts them in the room there.
+ * @param name Room name
+ * @param board_size Board size for game (4, 6, or 8)
+ * @param turn_seconds Time limit per turn (0 = unlimited)
+ * @param players Players in seat order, the first one owns the room
+ * @param count Number of players (2-4), also the room's capacity
+ * @return Pointer to room or NULL on error
+ */
+room_t* room_create_full(const char *name, int board_size, int turn_seconds, client_t **players, int count);
+
+/**
+ * Point every seated player of a room created by room_create_full() at the room
+ * @param room Room (room's worker)
+ */
+void room_seat_players(room_t *room);
 
 /**
- * Get room by ID
+ * Get room by ID (constant time, IDs of destroyed rooms return NULL)
  * @param room_id Room ID
  * @return Pointer to room or NULL if not found
  */
@@ -76,6 +135,26 @@ int room_add_player(room_t *room, client_t *client);
  */
 int room_remove_player(room_t *room, client_t *client);
 
+/**
+ * Attach a spectator to a room: subscribes the client to the room's events and
+ * takes a GAME_STATE snapshot of a running game under the room lock, then replies
+ * SPECTATING and sends the snapshot. Runs on the room's worker, so no event can
+ * come between the snapshot and the event stream.
+ * @param room_id Room ID
+ * @param client Client in the lobby
+ * @return 0 on success, -1 if the room doesn't exist or the client already watches one
+ */
+int room_add_spectator(int room_id, client_t *client);
+
+/**
+ * Begin the turn of the game's current player: sends YOUR_TURN and, if the room
+ * has a turn limit, arms the turn timer. When it fires before the next turn
+ * starts, the room's worker hides a card revealed in that turn, broadcasts
+ * TURN_TIMEOUT and starts the next player's turn.
+ * @param room Room with a running game (room's worker, or whoever just started the game)
+ */
+void room_start_turn(room_t *room);
+
 /**
  * Destroy room
  * @param room Room to destroy
@@ -89,6 +168,22 @@ void room_destroy(room_t *room);
  */
 room_t** room_get_all(int *count);
 
+/**
+ * Copy state of all rooms (lock is held only while copying)
+ * @param out Output array
+ * @param max_count Size of output array
+ * @return Number of rooms copied
+ */
+int room_get_info_all(room_info_t *out, int max_count);
+
+/**
+ * Close a room on behalf of the server: players get ROOM_CLOSED and LEFT_ROOM
+ * and return to the lobby, a running game is discarded
+ * @param room Room to close
+ * @param reason Reason sent with ROOM_CLOSED
+ */
+void room_close(room_t *room, const char *reason);
+
 /**
  * Get room info as string for LIST_ROOMS response
  * @param buffer Output buffer
@@ -98,7 +193,7 @@ room_t** room_get_all(int *count);
 int room_get_list_message(char *buffer, int buffer_size);
 
 /**
- * Broadcast message to all players in room
+ * Broadcast message to all players in room (spectators get it from the fan-out thread)
  * @param room Room to broadcast to
  * @param message Message to send
  */
@@ -112,4 +207,17 @@ void room_broadcast(room_t *room, const char *message);
  */
 void room_broadcast_except(room_t *room, const char *message, client_t *exclude_client);
 
+/**
+ * Swap a reconnecting client into the seat of its old client and bring it up to
+ * date: replay the room events it missed while disconnected if the ring still
+ * holds them, otherwise a snapshot stamped with the room's SEQ, then YOUR_TURN if
+ * the turn is its. Runs on the room's worker, so no broadcast can interleave.
+ * @param room Room the old client was in
+ * @param old_client Client being replaced
+ * @param new_client Reconnected client
+ * @param last_seq Last sequence number the client has seen (0 = unknown)
+ * @return Number of replayed events, or -1 if a full snapshot was sent instead
+ */
+int room_reattach_player(room_t *room, client_t *old_client, client_t *new_client, unsigned int last_seq);
+
 #endif /* ROOM_H */
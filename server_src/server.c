@@ -1,15 +1,34 @@
+#define LOG_MODULE LOG_MODULE_SERVER
+
 #include "server.h"
 #include "client_handler.h"
 #include "client_list.h"
 #include "room.h"
+#include "matchmaker.h"
+#include "spectator.h"
 #include "game.h"
 #include "logger.h"
 #include "protocol.h"
+#include "worker_pool.h"
+#include "codec.h"
+#include "uring.h"
+#include "coro.h"
+#include "config.h"
+#include "admin.h"
+#include "eventlog.h"
+#include "clock.h"
+#include "timer.h"
+#include "bot.h"
+#include "stats.h"
+#include "board_pool.h"
+#include "ratelimit.h"
+#include "admission.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <pthread.h>
@@ -18,15 +37,57 @@
 static server_config_t server_config;
 static pthread_t ping_thread;
 static pthread_t timeout_thread;
+static pthread_t unix_thread;
+static int unix_thread_started = 0;
+static char unix_path[CONFIG_MAX_PATH];
 
 // Forward declarations
 static void* ping_thread_func(void *arg);
 static void* timeout_checker_thread_func(void *arg);
+static void* unix_accept_thread_func(void *arg);
 
 server_config_t* server_get_config(void) {
     return &server_config;
 }
 
+// Bind the extra listener for clients on the same host
+static int open_unix_listener(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    snprintf(unix_path, sizeof(unix_path), "%s", path);
+
+    server_config.unix_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_config.unix_fd < 0) {
+        logger_log(LOG_ERROR, "Failed to create Unix socket: %s", strerror(errno));
+        return -1;
+    }
+
+    // A stale socket file from a crashed run would make bind() fail
+    unlink(path);
+
+    if (bind(server_config.unix_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(server_config.unix_fd, config_get()->listen_backlog) < 0) {
+        logger_log(LOG_ERROR, "Failed to listen on Unix socket %s: %s", path, strerror(errno));
+        close(server_config.unix_fd);
+        server_config.unix_fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+// Close both listeners on a failed start
+static void close_listeners(void) {
+    close(server_config.listen_fd);
+    if (server_config.unix_fd >= 0) {
+        close(server_config.unix_fd);
+        server_config.unix_fd = -1;
+        unlink(unix_path);
+    }
+}
+
 int server_init(const char *ip, int port, int max_rooms, int max_clients) {
     // Initialize configuration
     strncpy(server_config.ip, ip, sizeof(server_config.ip) - 1);
@@ -35,7 +96,8 @@ int server_init(const char *ip, int port, int max_rooms, int max_clients) {
     server_config.max_rooms = max_rooms;
     server_config.max_clients = max_clients;
     server_config.running = 1;
-    server_config.next_client_id = 1;
+    server_config.unix_fd = -1;
+    atomic_init(&server_config.next_client_id, 1);
 
     // Create socket
     server_config.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -71,24 +133,80 @@ int server_init(const char *ip, int port, int max_rooms, int max_clients) {
     }
 
     // Listen for connections
-    if (listen(server_config.listen_fd, 10) < 0) {
+    if (listen(server_config.listen_fd, config_get()->listen_backlog) < 0) {
         logger_log(LOG_ERROR, "Failed to listen: %s", strerror(errno));
         close(server_config.listen_fd);
         return -1;
     }
 
+    // Local proxies and bots connect here without the TCP loopback stack
+    if (config_get()->unix_socket[0] != '\0' && open_unix_listener(config_get()->unix_socket) != 0) {
+        close(server_config.listen_fd);
+        return -1;
+    }
+
+    ratelimit_init();
+    if (admission_init(config_get()->admission_queue) != 0) {
+        close_listeners();
+        return -1;
+    }
+
     // Initialize room system
     if (room_system_init(max_rooms) != 0) {
         logger_log(LOG_ERROR, "Failed to initialize room system");
-        close(server_config.listen_fd);
+        close_listeners();
+        return -1;
+    }
+
+    if (matchmaker_init() != 0) {
+        room_system_shutdown();
+        close_listeners();
+        return -1;
+    }
+
+    if (spectator_init() != 0) {
+        room_system_shutdown();
+        close_listeners();
         return -1;
     }
 
     // Initialize client list
     if (client_list_init(max_clients) != 0) {
         logger_log(LOG_ERROR, "Failed to initialize client list");
+        spectator_shutdown();
         room_system_shutdown();
-        close(server_config.listen_fd);
+        close_listeners();
+        return -1;
+    }
+
+    // Pick the I/O backend (io_uring if the kernel supports it)
+    uring_init();
+
+    // Coroutine handlers (falls back to a thread per client)
+    runtime_config_t *config = config_get();
+    if (config->coroutines && coro_init(config->coro_schedulers, (size_t)config->coro_stack_kb * 1024) != 0) {
+        logger_log(LOG_WARNING, "Coroutine mode unavailable, using a thread per client");
+    }
+
+    // Start room workers before any client can submit room commands
+    if (worker_pool_init(config->worker_threads) != 0) {
+        logger_log(LOG_ERROR, "Failed to start room workers");
+        coro_shutdown();
+        client_list_shutdown();
+        spectator_shutdown();
+        room_system_shutdown();
+        close_listeners();
+        return -1;
+    }
+
+    // Turn timers submit their expiry to the room workers
+    if (timer_init() != 0) {
+        worker_pool_shutdown();
+        coro_shutdown();
+        client_list_shutdown();
+        spectator_shutdown();
+        room_system_shutdown();
+        close_listeners();
         return -1;
     }
 
@@ -96,9 +214,13 @@ int server_init(const char *ip, int port, int max_rooms, int max_clients) {
     int result = pthread_create(&ping_thread, NULL, ping_thread_func, NULL);
     if (result != 0) {
         logger_log(LOG_ERROR, "Failed to create PING thread: %s", strerror(result));
+        timer_shutdown();
+        worker_pool_shutdown();
+        coro_shutdown();
         client_list_shutdown();
+        spectator_shutdown();
         room_system_shutdown();
-        close(server_config.listen_fd);
+        close_listeners();
         return -1;
     }
     logger_log(LOG_INFO, "PING thread started");
@@ -107,87 +229,225 @@ int server_init(const char *ip, int port, int max_rooms, int max_clients) {
     result = pthread_create(&timeout_thread, NULL, timeout_checker_thread_func, NULL);
     if (result != 0) {
         logger_log(LOG_ERROR, "Failed to create timeout checker thread: %s", strerror(result));
+        timer_shutdown();
+        worker_pool_shutdown();
+        coro_shutdown();
         client_list_shutdown();
+        spectator_shutdown();
         room_system_shutdown();
-        close(server_config.listen_fd);
+        close_listeners();
         return -1;
     }
     logger_log(LOG_INFO, "Timeout checker thread started");
 
+    // Event log is optional too - the text log keeps working without it
+    if (eventlog_init(config->event_log, (size_t)config->event_log_segment_kb * 1024) != 0) {
+        logger_log(LOG_WARNING, "Event log unavailable, continuing without it");
+    }
+
+    // Without the board pool games shuffle their boards on creation
+    if (board_pool_init() != 0) {
+        logger_log(LOG_WARNING, "Board pool unavailable, shuffling boards on game creation");
+    }
+
+    // Statistics fall back to memory if the file can't be used
+    if (stats_init(config->stats_file) != 0) {
+        logger_log(LOG_WARNING, "Stats file unavailable, keeping statistics in memory only");
+    }
+
+    // Admin socket is optional - the game runs without it
+    if (admin_init(config->admin_socket) != 0) {
+        logger_log(LOG_WARNING, "Admin socket unavailable, continuing without it");
+    }
+
     logger_log(LOG_INFO, "Server initialized: %s:%d (max_rooms=%d, max_clients=%d)",
                ip, port, max_rooms, max_clients);
+    if (server_config.unix_fd >= 0) {
+        logger_log(LOG_INFO, "Also accepting clients on Unix socket %s", unix_path);
+    }
 
     return 0;
 }
 
-void server_run(void) {
-    logger_log(LOG_INFO, "Server started, waiting for connections...");
+// Close with a reset: nothing is sent and no TIME_WAIT is left behind
+static void refuse_connection(int client_fd) {
+    struct linger linger = { 1, 0 };
+    setsockopt(client_fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    close(client_fd);
+}
 
-    while (server_config.running) {
-        struct sockaddr_in client_addr;
-        socklen_t client_addr_len = sizeof(client_addr);
+// Set up a client for an accepted socket and start its handler thread
+void server_accept_client(int client_fd) {
+    struct sockaddr_in client_addr;
+    socklen_t client_addr_len = sizeof(client_addr);
+    memset(&client_addr, 0, sizeof(client_addr));
+    getpeername(client_fd, (struct sockaddr *)&client_addr, &client_addr_len);
+
+    // Checked before anything is allocated; only TCP peers have an address to limit
+    int is_tcp = client_addr.sin_family == AF_INET;
+    uint32_t peer_addr = is_tcp ? client_addr.sin_addr.s_addr : 0;
+    int peer_port = is_tcp ? ntohs(client_addr.sin_port) : 0;
+    if (!ratelimit_allow_connection(peer_addr)) {
+        logger_log_ratelimited(LOG_WARNING, 5, "Connection refused: rate limit exceeded (fd=%d)", client_fd);
+        refuse_connection(client_fd);
+        return;
+    }
 
-        // Accept new connection
-        int client_fd = accept(server_config.listen_fd, (struct sockaddr *)&client_addr, &client_addr_len);
+    // Get client IP address
+    if (is_tcp) {
+        char client_ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+        logger_log(LOG_INFO, "New connection from %s:%d (fd=%d)", client_ip, peer_port, client_fd);
+    } else {
+        logger_log(LOG_INFO, "New local connection on %s (fd=%d)", unix_path, client_fd);
+    }
+
+    // Create client structure
+    client_t *client = (client_t *)malloc(sizeof(client_t));
+    if (client == NULL) {
+        logger_log(LOG_ERROR, "Failed to allocate memory for client");
+        close(client_fd);
+        return;
+    }
+
+    client->socket_fd = client_fd;
+    client->state = STATE_CONNECTED;
+    client->last_activity_ms = clock_now_ms();
+    client->invalid_message_count = 0;
+    client->client_id = atomic_fetch_add(&server_config.next_client_id, 1);
+    atomic_init(&client->refs, 1);
+    client->list_slot = -1;
+    client->room = NULL;
+    atomic_init(&client->room_mailbox, 0);
+    client->room_slot = -1;
+    client->game_slot = -1;
+    atomic_init(&client->match_bucket, -1);
+    client->spectating = NULL;
+    client->is_disconnected = 0;
+    client->disconnect_time_ms = 0;
+    client->waiting_for_pong = 0;
+    client->last_ping_ms = 0;
+    client->last_pong_ms = client->last_activity_ms;  // Initialize to current time
+    client->ping_sent_ms = 0;
+    client->srtt_ms = -1;
+    client->rttvar_ms = 0;
+    client->heartbeat_interval = config_get()->pong_wait_interval;
+    client->binary_mode = 0;
+    coro_wait_init(&client->pending_commands);
+    atomic_init(&client->bytes_in, 0);
+    atomic_init(&client->bytes_out, 0);
+    pthread_mutex_init(&client->send_lock, NULL);
+    client->bot = NULL;
+    client->peer_addr = peer_addr;
+    memset(client->nickname, 0, sizeof(client->nickname));
+    client->session_token[0] = '\0';
+
+    eventlog_record(EVENT_CONNECT, client->client_id, -1, (int)peer_addr, peer_port);
+
+    // While anyone waits for a slot, newcomers queue behind them
+    int result = admission_waiting() > 0 ? 1 : server_start_client(client);
+    if (result == 1 && admission_enqueue(client) != 0) {
+        logger_log_ratelimited(LOG_WARNING, 5, "Client %d: Server and waiting queue full, closing connection",
+                               client->client_id);
+        refuse_connection(client_fd);
+        free(client);
+    }
+}
+
+int server_start_client(client_t *client) {
+    if (client_list_add(client) != 0) {
+        return 1;
+    }
+
+    // Coroutine mode: handler runs on a scheduler thread instead of its own thread
+    if (coro_enabled()) {
+        if (coro_spawn(client_handler_thread, client) != 0) {
+            logger_log(LOG_ERROR, "Failed to create coroutine for client %d", client->client_id);
+            client_list_remove(client);
+            close(client->socket_fd);
+            client_list_release(client);
+            return -1;
+        }
+        logger_log(LOG_INFO, "Client %d: Coroutine created successfully", client->client_id);
+        return 0;
+    }
+
+    // Create thread for client (stack size from config, 0 = system default)
+    pthread_t thread_id;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (config_get()->thread_stack_kb > 0 &&
+        pthread_attr_setstacksize(&attr, (size_t)config_get()->thread_stack_kb * 1024) != 0) {
+        logger_log(LOG_WARNING, "Invalid thread stack size %d KB, using default", config_get()->thread_stack_kb);
+    }
+    int result = pthread_create(&thread_id, &attr, client_handler_thread, client);
+    pthread_attr_destroy(&attr);
+    if (result != 0) {
+        logger_log(LOG_ERROR, "Failed to create thread for client %d: %s", client->client_id, strerror(result));
+        client_list_remove(client);
+        close(client->socket_fd);
+        client_list_release(client);
+        return -1;
+    }
+
+    // Detach thread so it cleans up automatically when done
+    pthread_detach(thread_id);
+
+    logger_log(LOG_INFO, "Client %d: Thread created successfully", client->client_id);
+    return 0;
+}
+
+// Accept loop of the Unix listener, next to the TCP one in server_run
+static void* unix_accept_thread_func(void *arg) {
+    (void)arg;
+
+    while (server_config.running) {
+        int client_fd = accept(server_config.unix_fd, NULL, NULL);
 
         if (client_fd < 0) {
             if (server_config.running) {
-                logger_log(LOG_ERROR, "Failed to accept connection: %s", strerror(errno));
+                logger_log(LOG_ERROR, "Failed to accept Unix connection: %s", strerror(errno));
             }
             continue;
         }
 
-        // Get client IP address
-        char client_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+        server_accept_client(client_fd);
+    }
 
-        logger_log(LOG_INFO, "New connection from %s:%d (fd=%d)",
-                   client_ip, ntohs(client_addr.sin_port), client_fd);
+    return NULL;
+}
 
-        // Create client structure
-        client_t *client = (client_t *)malloc(sizeof(client_t));
-        if (client == NULL) {
-            logger_log(LOG_ERROR, "Failed to allocate memory for client");
-            close(client_fd);
-            continue;
-        }
+void server_run(void) {
+    logger_log(LOG_INFO, "Server started, waiting for connections...");
 
-        client->socket_fd = client_fd;
-        client->state = STATE_CONNECTED;
-        client->last_activity = time(NULL);
-        client->invalid_message_count = 0;
-        client->client_id = server_config.next_client_id++;
-        client->room = NULL;
-        client->is_disconnected = 0;
-        client->disconnect_time = 0;
-        client->waiting_for_pong = 0;
-        client->last_ping_time = 0;
-        client->last_pong_time = time(NULL);  // Initialize to current time
-        memset(client->nickname, 0, sizeof(client->nickname));
-
-        // Add to client list
-        if (client_list_add(client) != 0) {
-            logger_log(LOG_ERROR, "Failed to add client %d to list", client->client_id);
-            close(client_fd);
-            free(client);
-            continue;
+    // Unix clients get their own accept thread (DON'T detach - joined on shutdown)
+    if (server_config.unix_fd >= 0) {
+        int result = pthread_create(&unix_thread, NULL, unix_accept_thread_func, NULL);
+        if (result != 0) {
+            logger_log(LOG_ERROR, "Failed to create Unix accept thread: %s", strerror(result));
+        } else {
+            unix_thread_started = 1;
         }
+    }
 
-        // Create thread for client
-        pthread_t thread_id;
-        int result = pthread_create(&thread_id, NULL, client_handler_thread, client);
-        if (result != 0) {
-            logger_log(LOG_ERROR, "Failed to create thread for client %d: %s", client->client_id, strerror(result));
-            client_list_remove(client);
-            close(client_fd);
-            free(client);
+    // Multishot accept on io_uring; falls back to accept() if the kernel can't do it
+    if (uring_enabled() && uring_accept_loop(server_config.listen_fd, &server_config.running, server_accept_client) == 0) {
+        logger_log(LOG_INFO, "Server stopped accepting connections");
+        return;
+    }
+
+    while (server_config.running) {
+        // Accept new connection
+        int client_fd = accept(server_config.listen_fd, NULL, NULL);
+
+        if (client_fd < 0) {
+            if (server_config.running) {
+                logger_log(LOG_ERROR, "Failed to accept connection: %s", strerror(errno));
+            }
             continue;
         }
 
-        // Detach thread so it cleans up automatically when done
-        pthread_detach(thread_id);
-
-        logger_log(LOG_INFO, "Client %d: Thread created successfully", client->client_id);
+        server_accept_client(client_fd);
     }
 
     logger_log(LOG_INFO, "Server stopped accepting connections");
@@ -198,6 +458,19 @@ void server_shutdown(void) {
 
     server_config.running = 0;
 
+    // No new local clients either (shutdown() wakes the blocked accept)
+    if (unix_thread_started) {
+        shutdown(server_config.unix_fd, SHUT_RDWR);
+        pthread_join(unix_thread, NULL);
+        unix_thread_started = 0;
+    }
+
+    // Stop admin commands before state is torn down
+    admin_shutdown();
+
+    // Waiting connections never got a handler, close them before they could
+    admission_shutdown();
+
     // Notify all clients about server shutdown
     client_t *clients[server_config.max_clients];
     int count = client_list_get_all(clients, server_config.max_clients);
@@ -207,6 +480,7 @@ void server_shutdown(void) {
         if (clients[i] != NULL && !clients[i]->is_disconnected) {
             client_send_message(clients[i], "SERVER_SHUTDOWN Server is shutting down");
         }
+        client_list_release(clients[i]);
     }
 
     // Give messages time to be sent before closing connections
@@ -220,6 +494,7 @@ void server_shutdown(void) {
             shutdown(clients[i]->socket_fd, SHUT_RDWR);
             logger_log(LOG_INFO, "Client %d: Socket shutdown for forced disconnect", clients[i]->client_id);
         }
+        client_list_release(clients[i]);
     }
 
     // Wait for PING and timeout checker threads to finish FIRST
@@ -237,11 +512,23 @@ void server_shutdown(void) {
     logger_log(LOG_INFO, "Waiting for handler threads to finish...");
     sleep(3);  // Increased to 3 seconds to ensure all handler threads exit
 
+    // No turn expiries after this point, then drain room mailboxes before rooms go away
+    timer_shutdown();
+    worker_pool_shutdown();
+    coro_shutdown();
+    board_pool_shutdown();
+
+    // Deliver what spectators still have queued, rooms free their lists next
+    spectator_shutdown();
+
     // Shutdown room system FIRST (it accesses client pointers)
     logger_log(LOG_INFO, "Shutting down room system...");
     room_system_shutdown();
     logger_log(LOG_INFO, "Room system shutdown complete");
 
+    // Bots are referenced by rooms only
+    bot_shutdown();
+
     // NOW it's safe to shutdown client list (no threads accessing it, rooms cleared)
     client_list_shutdown();
 
@@ -249,13 +536,111 @@ void server_shutdown(void) {
         close(server_config.listen_fd);
         server_config.listen_fd = -1;
     }
+    if (server_config.unix_fd >= 0) {
+        close(server_config.unix_fd);
+        server_config.unix_fd = -1;
+        unlink(unix_path);
+    }
+
+    eventlog_shutdown();
+    stats_shutdown();
 
     logger_log(LOG_INFO, "Server shutdown complete");
 }
 
+// End the game of a player whose reconnect window expired (runs on the room's worker)
+static void forfeit_game(void *arg) {
+    client_t *client = (client_t *)arg;
+    room_t *room = client->room;
+    if (room == NULL || room->game == NULL) {
+        return;
+    }
+
+    game_t *game = room->game;
+    int room_id = room->room_id;
+
+    stats_record_game(game, client);
+
+    // Give forfeit win to player(s) with highest score
+    int remaining_pairs = game->total_pairs - game->matched_pairs;
+
+    // Find highest score among remaining players (exclude disconnected client)
+    int highest_score = -1;
+    int winner_count = 0;
+
+    for (int j = 0; j < game->player_count; j++) {
+        if (game->players[j] != NULL && game->players[j] != client) {
+            if (game->player_scores[j] > highest_score) {
+                highest_score = game->player_scores[j];
+                winner_count = 1;
+            } else if (game->player_scores[j] == highest_score) {
+                winner_count++;
+            }
+        }
+    }
+
+    // Distribute remaining pairs to winner(s)
+    if (winner_count > 0 && remaining_pairs > 0) {
+        int bonus_per_winner = remaining_pairs / winner_count;
+        int extra_pairs = remaining_pairs % winner_count;
+
+        for (int j = 0; j < game->player_count; j++) {
+            if (game->players[j] != NULL && game->players[j] != client) {
+                if (game->player_scores[j] == highest_score) {
+                    game->player_scores[j] += bonus_per_winner;
+                    if (extra_pairs > 0) {
+                        game->player_scores[j]++;
+                        extra_pairs--;
+                    }
+                    logger_log(LOG_INFO, "Room %d: Player %s gets forfeit bonus (new score: %d)",
+                              room_id, game->players[j]->nickname, game->player_scores[j]);
+                }
+            }
+        }
+    }
+
+    // Build GAME_END_FORFEIT message
+    char game_end_msg[MAX_MESSAGE_LENGTH];
+    int offset = snprintf(game_end_msg, sizeof(game_end_msg), "GAME_END_FORFEIT");
+
+    for (int j = 0; j < game->player_count; j++) {
+        if (game->players[j] != NULL) {
+            offset += snprintf(game_end_msg + offset, sizeof(game_end_msg) - offset,
+                              " %s %d", game->players[j]->nickname, game->player_scores[j]);
+        }
+    }
+
+    // Broadcast game end to remaining players
+    room_broadcast_except(room, game_end_msg, client);
+
+    logger_log(LOG_INFO, "Room %d: Game ended by forfeit (reconnect timeout)", room_id);
+
+    // Clean up game
+    game_destroy(game);
+    room->game = NULL;
+    room->state = ROOM_STATE_WAITING;
+
+    // Remove all players from room inline
+    for (int j = 0; j < MAX_PLAYERS_PER_ROOM; j++) {
+        if (room->players[j] != NULL) {
+            room->players[j]->room = NULL;
+            room->players[j]->state = STATE_IN_LOBBY;
+            room->players[j] = NULL;
+            logger_log(LOG_INFO, "Player removed from room after forfeit timeout");
+        }
+    }
+    room->player_count = 0;
+
+    logger_log(LOG_INFO, "Room %d is now empty after forfeit, destroying", room_id);
+
+    // Destroy the room
+    room_destroy(room);
+}
+
 /**
- * PING thread - sends PING to clients that have responded to previous PING
- * Only sends new PING 5 seconds after receiving PONG
+ * PING thread - sends PING <ms> to clients that have responded to previous PING
+ * Sends a new PING heartbeat_interval seconds after receiving PONG; the payload is
+ * built once per tick and written without blocking so one slow socket can't stall the batch
  */
 static void* ping_thread_func(void *arg) {
     (void)arg;
@@ -263,20 +648,33 @@ static void* ping_thread_func(void *arg) {
     logger_log(LOG_INFO, "PING thread running");
 
     while (server_config.running) {
-        sleep(1);  // Check every second for more responsive timing
+        clock_sleep_ms(PING_TICK_MS);
 
         if (!server_config.running) break;
 
-        time_t now = time(NULL);
+        // Apply a SIGHUP config reload from this thread (signal handler only sets a flag)
+        config_reload_if_requested();
+
+        int64_t now = clock_now_ms();
+        unsigned int now_ms = (unsigned int)now;  // PING payload wraps every ~49 days
 
         // Get all clients
         client_t *clients[server_config.max_clients];
         int count = client_list_get_all(clients, server_config.max_clients);
 
+        // One PING per tick, in both wire formats
+        char ping_msg[32];
+        char ping_line[34];
+        unsigned char ping_frame[32];
+        snprintf(ping_msg, sizeof(ping_msg), "%s %u", CMD_PING, now_ms);
+        int line_len = snprintf(ping_line, sizeof(ping_line), "%s\n", ping_msg);
+        int frame_len = codec_encode_frame(ping_msg, ping_frame, sizeof(ping_frame));
+        int sent_count = 0;
+
         // Send PING only to clients that:
         // 1. Are authenticated and not disconnected
         // 2. Are not waiting for PONG (responded to previous PING)
-        // 3. Have waited at least PONG_WAIT_INTERVAL (5s) since last PONG
+        // 3. Have waited at least their heartbeat interval since last PONG
         for (int i = 0; i < count; i++) {
             client_t *client = clients[i];
 
@@ -284,21 +682,44 @@ static void* ping_thread_func(void *arg) {
                 // Check if we're not waiting for PONG
                 if (!client->waiting_for_pong) {
                     // Check if enough time has passed since last PONG
-                    time_t time_since_pong = now - client->last_pong_time;
-
-                    if (time_since_pong >= PONG_WAIT_INTERVAL) {
-                        // Send PING
-                        int result = client_send_message(client, CMD_PING);
+                    int64_t time_since_pong = now - client->last_pong_ms;
+
+                    if (time_since_pong >= CLOCK_MS(client->heartbeat_interval)) {
+                        // Arm before sending: a fast PONG may be handled before send() returns
+                        client->ping_sent_ms = now_ms;
+                        client->last_ping_ms = now;
+                        client->waiting_for_pong = 1;
+
+                        // Never blocks on the client: if a handler is writing, try again next tick
+                        int result = client->binary_mode
+                            ? client_send_nowait(client, ping_frame, frame_len, 0)
+                            : client_send_nowait(client, ping_line, line_len, 0);
                         if (result > 0) {
-                            client->waiting_for_pong = 1;
-                            client->last_ping_time = now;
-                            logger_log(LOG_INFO, "PING sent to client %d (%s)",
-                                      client->client_id, client->nickname);
+                            sent_count++;
+                        } else {
+                            client->waiting_for_pong = 0;
+                        }
+                        if (result < 0) {
+                            // Not even a PING fits, or part of one went out - the stream is unusable
+                            logger_log_ratelimited(LOG_WARNING, 5, "Client %d: PING send failed, closing connection",
+                                                   client->client_id);
+                            int fd = client->socket_fd;
+                            if (fd >= 0) {
+                                shutdown(fd, SHUT_RDWR);
+                            }
                         }
                     }
                 }
             }
         }
+
+        for (int i = 0; i < count; i++) {
+            client_list_release(clients[i]);
+        }
+
+        if (sent_count > 0) {
+            logger_log(LOG_DEBUG, "PING %u sent to %d clients", now_ms, sent_count);
+        }
     }
 
     logger_log(LOG_INFO, "PING thread terminated");
@@ -315,32 +736,28 @@ static void* timeout_checker_thread_func(void *arg) {
     logger_log(LOG_INFO, "Timeout checker thread running");
 
     while (server_config.running) {
-        sleep(5); // Check every 5 seconds
+        clock_sleep_ms(TIMEOUT_CHECK_MS);
 
         if (!server_config.running) break;
 
-        time_t now = time(NULL);
+        int64_t now = clock_now_ms();
+        runtime_config_t *config = config_get();
         client_t *clients[server_config.max_clients];
         int count = client_list_get_all(clients, server_config.max_clients);
 
         for (int i = 0; i < count; i++) {
             client_t *client = clients[i];
 
-            // Skip if client was already processed and freed in this iteration
-            if (client == NULL) {
-                continue;
-            }
-
-            // CRITICAL: Copy ALL client data locally at the START of iteration
-            // to prevent use-after-free if handle_reconnect frees the client during iteration
+            // CRITICAL: Copy ALL client data locally at the START of iteration,
+            // handle_reconnect may take the client over during iteration
             int client_id = client->client_id;
             int socket_fd = client->socket_fd;
             client_state_t state = client->state;
             int waiting_for_pong = client->waiting_for_pong;
-            time_t last_ping_time = client->last_ping_time;
-            time_t last_activity = client->last_activity;
+            int64_t last_ping_ms = client->last_ping_ms;
+            int64_t last_activity_ms = client->last_activity_ms;
             int is_disconnected = client->is_disconnected;
-            time_t disconnect_time = client->disconnect_time;
+            int64_t disconnect_time_ms = client->disconnect_time_ms;
             char nickname_copy[MAX_NICK_LENGTH];
             strncpy(nickname_copy, client->nickname, sizeof(nickname_copy) - 1);
             nickname_copy[sizeof(nickname_copy) - 1] = '\0';
@@ -354,20 +771,18 @@ static void* timeout_checker_thread_func(void *arg) {
 
             // Only check authenticated clients with valid socket
             if (state >= STATE_AUTHENTICATED && socket_fd >= 0) {
-                // Check if client hasn't responded to PING within PONG_TIMEOUT
+                // Check if client hasn't responded to PING within pong_timeout
                 if (waiting_for_pong) {
-                    time_t ping_wait_time = now - last_ping_time;
-
-                    if (ping_wait_time > PONG_TIMEOUT) {
-                        logger_log(LOG_WARNING, "Client %d (%s): PONG timeout (%d seconds)",
-                                  client_id, nickname_copy, PONG_TIMEOUT);
+                    if (now - last_ping_ms > CLOCK_MS(config->pong_timeout)) {
+                        logger_log_ratelimited(LOG_WARNING, 10, "Client %d (%s): PONG timeout (%d seconds)",
+                                  client_id, nickname_copy, config->pong_timeout);
 
                         // Mark client as disconnected for reconnect instead of immediate cleanup
                         if (!is_disconnected) {
                             client->is_disconnected = 1;
-                            client->disconnect_time = now;
+                            client->disconnect_time_ms = now;
                             logger_log(LOG_INFO, "Client %d (%s): Marked for reconnect (timeout: %ds)",
-                                      client_id, nickname_copy, RECONNECT_TIMEOUT);
+                                      client_id, nickname_copy, config->reconnect_timeout);
                         }
 
                         // Close socket to trigger cleanup (but keep client in list)
@@ -380,13 +795,12 @@ static void* timeout_checker_thread_func(void *arg) {
                     }
                 }
 
-                // Also check for general inactivity (2 minutes)
-                time_t inactive_time = now - last_activity;
-                int timeout_threshold = 120;  // 2 minutes
+                // Also check for general inactivity (2 minutes by default)
+                int64_t inactive_ms = now - last_activity_ms;
 
-                if (inactive_time > timeout_threshold) {
+                if (inactive_ms > CLOCK_MS(config->inactivity_timeout)) {
                     logger_log(LOG_WARNING, "Client %d (%s) timed out (inactive for %ld seconds)",
-                              client_id, nickname_copy, inactive_time);
+                              client_id, nickname_copy, (long)(inactive_ms / 1000));
 
                     // Use shutdown() instead of close() to avoid closing recycled FDs
                     int fd = client->socket_fd;
@@ -399,105 +813,34 @@ static void* timeout_checker_thread_func(void *arg) {
 
             // Check for disconnected players waiting for reconnect
             if (is_disconnected && socket_fd == -1) {
-                time_t disconnect_duration = now - disconnect_time;
+                int64_t disconnect_ms = now - disconnect_time_ms;
 
-                if (disconnect_duration > RECONNECT_TIMEOUT) {
+                if (disconnect_ms > CLOCK_MS(config->reconnect_timeout)) {
                     logger_log(LOG_WARNING, "Client %d (%s): Reconnect timeout expired (%ld seconds)",
-                              client_id, nickname_copy, disconnect_duration);
-
-                    // Get room and game
-                    room_t *room = client->room;
-                    if (room != NULL && room->game != NULL) {
-                        game_t *game = room->game;
-                        int room_id = room->room_id;
-
-                        // Give forfeit win to player(s) with highest score
-                        int remaining_pairs = game->total_pairs - game->matched_pairs;
-
-                        // Find highest score among remaining players (exclude disconnected client)
-                        int highest_score = -1;
-                        int winner_count = 0;
-
-                        for (int j = 0; j < game->player_count; j++) {
-                            if (game->players[j] != NULL && game->players[j] != client) {
-                                if (game->player_scores[j] > highest_score) {
-                                    highest_score = game->player_scores[j];
-                                    winner_count = 1;
-                                } else if (game->player_scores[j] == highest_score) {
-                                    winner_count++;
-                                }
-                            }
-                        }
-
-                        // Distribute remaining pairs to winner(s)
-                        if (winner_count > 0 && remaining_pairs > 0) {
-                            int bonus_per_winner = remaining_pairs / winner_count;
-                            int extra_pairs = remaining_pairs % winner_count;
-
-                            for (int j = 0; j < game->player_count; j++) {
-                                if (game->players[j] != NULL && game->players[j] != client) {
-                                    if (game->player_scores[j] == highest_score) {
-                                        game->player_scores[j] += bonus_per_winner;
-                                        if (extra_pairs > 0) {
-                                            game->player_scores[j]++;
-                                            extra_pairs--;
-                                        }
-                                        logger_log(LOG_INFO, "Room %d: Player %s gets forfeit bonus (new score: %d)",
-                                                  room_id, game->players[j]->nickname, game->player_scores[j]);
-                                    }
-                                }
-                            }
-                        }
-
-                        // Build GAME_END_FORFEIT message
-                        char game_end_msg[MAX_MESSAGE_LENGTH];
-                        int offset = snprintf(game_end_msg, sizeof(game_end_msg), "GAME_END_FORFEIT");
-
-                        for (int j = 0; j < game->player_count; j++) {
-                            if (game->players[j] != NULL) {
-                                offset += snprintf(game_end_msg + offset, sizeof(game_end_msg) - offset,
-                                                  " %s %d", game->players[j]->nickname, game->player_scores[j]);
-                            }
-                        }
+                              client_id, nickname_copy, (long)(disconnect_ms / 1000));
 
-                        // Broadcast game end to remaining players
-                        room_broadcast_except(room, game_end_msg, client);
-
-                        logger_log(LOG_INFO, "Room %d: Game ended by forfeit (reconnect timeout)", room_id);
-
-                        // Clean up game
-                        game_destroy(game);
-                        room->game = NULL;
-                        room->state = ROOM_STATE_WAITING;
-
-                        // Remove all players from room inline
-                        for (int j = 0; j < MAX_PLAYERS_PER_ROOM; j++) {
-                            if (room->players[j] != NULL) {
-                                room->players[j]->room = NULL;
-                                room->players[j]->state = STATE_IN_LOBBY;
-                                room->players[j] = NULL;
-                                logger_log(LOG_INFO, "Player removed from room after forfeit timeout");
-                            }
-                        }
-                        room->player_count = 0;
-
-                        logger_log(LOG_INFO, "Room %d is now empty after forfeit, destroying", room_id);
+                    // Taking the client out of the list first settles a race with a RECONNECT
+                    // that found it meanwhile: only one of them gets the seat
+                    if (client_list_remove(client) != 0) {
+                        continue;
+                    }
 
-                        // Destroy the room
-                        room_destroy(room);
+                    // End the game on the room's worker, serialized with its commands
+                    // (forfeit_game rechecks the room there)
+                    int room_id = atomic_load(&client->room_mailbox);
+                    if (room_id != 0) {
+                        worker_pool_run_sync(room_id, forfeit_game, client);
                     }
 
-                    // Clean up disconnected client
                     logger_log(LOG_INFO, "Client %d (%s) cleaned up after reconnect timeout",
                               client_id, nickname_copy);
-                    client_list_remove(client);
-                    free(client);
-
-                    // Mark as NULL in local array to prevent double-free if client appears multiple times
-                    clients[i] = NULL;
                 }
             }
         }
+
+        for (int i = 0; i < count; i++) {
+            client_list_release(clients[i]);
+        }
     }
 
     logger_log(LOG_INFO, "Timeout checker thread terminated");
@@ -1,18 +1,27 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+#include "client_handler.h"
+
 /**
  * Server module - TCP socket management and accept loop
+ *
+ * An optional Unix socket listener (unix_socket) has its own accept thread and
+ * hands connections to the same server_accept_client() path as TCP.
  */
 
+#define PING_TICK_MS 1000        // PING thread wakes up this often
+#define TIMEOUT_CHECK_MS 1000    // Timeout checker period (timeouts are checked in ms)
+
 typedef struct {
     char ip[64];
     int port;
     int max_rooms;
     int max_clients;
     int listen_fd;
+    int unix_fd;         // Unix socket listener (-1 = disabled)
     int running;
-    int next_client_id;
+    atomic_int next_client_id;  // Both accept loops hand out ids
 } server_config_t;
 
 /**
@@ -30,6 +39,20 @@ int server_init(const char *ip, int port, int max_rooms, int max_clients);
  */
 void server_run(void);
 
+/**
+ * Set up a client for an accepted connection and start its handler
+ * @param client_fd Connected socket (closed on failure)
+ */
+void server_accept_client(int client_fd);
+
+/**
+ * Add a client to the client list and start its handler
+ * @param client Client set up for a connection
+ * @return 0 if started, 1 if the client list is full (client untouched),
+ *         -1 on error (connection closed, client freed)
+ */
+int server_start_client(client_t *client);
+
 /**
  * Shutdown the server and cleanup resources
  */
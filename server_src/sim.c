@@ -0,0 +1,741 @@
+/**
+ * Simulation driver - runs the real server modules against simulated clients
+ *
+ * Linked (make sim) in place of main.c. Time is virtual
+ * (clock_set_virtual) and advanced in fixed steps; clients talk to their
+ * handlers over in-memory socket pairs instead of TCP. Every client decision
+ * comes from one seeded generator and each step waits for the replies it
+ * expects, so a seed replays the same scenario (up to thread scheduling):
+ * paired games where players drop out, reconnect in time, reconnect too late
+ * or never come back (forfeit), and some never answer PING (PONG timeout).
+ *
+ * A SCENARIO argument runs a regression scenario instead of the games (see
+ * scenarios[]); it fails with a non-zero exit status or crashes the process.
+ *
+ * Usage: sim [OPTIONS] <CLIENTS> <SEED> <VIRTUAL_SECONDS> [SCENARIO]
+ */
+
+#include "server.h"
+#include "logger.h"
+#include "config.h"
+#include "clock.h"
+#include "protocol.h"
+#include "game.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#define SIM_STEP_MS 100               // Virtual time per step
+#define SIM_SETTLE_POLL_MS 2          // Real time to wait for server replies per poll
+#define SIM_SETTLE_IDLE_POLLS 2       // Quiet polls before a step counts as settled
+#define SIM_SETTLE_LIMIT_MS 2000      // Give up waiting for missing replies
+#define SIM_DROP_PER_MILLE 4          // Chance per step that a player in a game drops
+#define SIM_SILENT_PERCENT 2          // Clients that never answer PING
+#define SIM_BACKGROUND_SLEEPERS 3     // PING thread, timeout checker and timer thread
+#define SIM_MAX_CARDS 64
+#define SIM_BUFFER_SIZE 4096
+#define SIM_REPLY_TIMEOUT_MS 5000     // Real time a scenario waits for one reply
+#define SIM_LEAVE_READY_ROUNDS 500    // CREATE_ROOM, LEAVE_ROOM, READY burst per client
+#define SIM_LEAVE_READY_BURST 20
+
+typedef enum {
+    SIM_CONNECTING,     // HELLO sent
+    SIM_LOBBY,          // Waiting for the room (owner: created, guest: joined)
+    SIM_ROOM,           // In room, game not started yet
+    SIM_GAME,           // Game running
+    SIM_OFFLINE,        // Dropped, waiting to reconnect
+    SIM_RECONNECTING,   // RECONNECT sent
+    SIM_DONE            // Game over or given up
+} sim_state_t;
+
+typedef enum {
+    SIM_RETURN_IN_TIME,
+    SIM_RETURN_LATE,
+    SIM_RETURN_NEVER
+} sim_return_t;
+
+typedef struct {
+    int index;
+    int fd;
+    int client_id;
+    char session_token[SESSION_TOKEN_LENGTH + 1];
+    sim_state_t state;
+    int silent;
+    int room_id;
+    int64_t return_at_ms;       // When an offline client reconnects (-1 = never)
+    unsigned int last_seq;
+    int total_cards;
+    int known[SIM_MAX_CARDS];   // Revealed value per card (0 = unknown, -1 = matched)
+    int reveals[2];             // Cards revealed in the current turn
+    int reveal_count;
+    int my_turn;
+    int in_game;                // Game started (a reconnect resumes it)
+    int awaiting;               // Sent a command, reply not seen yet
+    int game_counted;           // Owner only: game result already counted
+    char buffer[SIM_BUFFER_SIZE];
+    int buffer_length;
+} sim_client_t;
+
+typedef struct {
+    int games_started;
+    int games_finished;
+    int games_forfeited;
+    int drops;
+    int reconnects;
+    int reconnects_expired;
+    int pong_timeouts;
+    int errors;
+} sim_stats_t;
+
+static sim_client_t *sim_clients = NULL;
+static int sim_client_count = 0;
+static unsigned int sim_random_state = 0;
+static sim_stats_t stats;
+static int awaiting_replies = 0;  // Clients waiting for the reply to a command
+static volatile int ticking = 0;
+static atomic_int scenario_errors = 0;  // Failures seen by scenario threads
+
+static int sim_random(int range) {
+    return (int)(rand_r(&sim_random_state) % (unsigned int)range);
+}
+
+static void sim_set_awaiting(sim_client_t *client, int awaiting) {
+    awaiting_replies += awaiting - client->awaiting;
+    client->awaiting = awaiting;
+}
+
+static void sim_send(sim_client_t *client, int expects_reply, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// Commands that expect a reply hold the step open until it arrives
+static void sim_send(sim_client_t *client, int expects_reply, const char *format, ...) {
+    char line[MAX_MESSAGE_LENGTH];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line) - 1, format, args);
+    va_end(args);
+    line[length++] = '\n';
+
+    if (client->fd >= 0 && send(client->fd, line, length, MSG_NOSIGNAL) < 0) {
+        logger_log(LOG_WARNING, "Sim %d: send failed", client->index);
+        return;
+    }
+    if (expects_reply) {
+        sim_set_awaiting(client, 1);
+    }
+}
+
+// New in-memory connection handed to the server like an accepted socket
+static int sim_connect(sim_client_t *client) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        return -1;
+    }
+
+    client->fd = pair[0];
+    client->buffer_length = 0;
+    server_accept_client(pair[1]);
+    return 0;
+}
+
+static void sim_close(sim_client_t *client) {
+    sim_set_awaiting(client, 0);
+    if (client->fd >= 0) {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
+
+// Drop the connection and decide if and when the player comes back
+static void sim_drop(sim_client_t *client, int64_t now_ms) {
+    int reconnect_ms = config_get()->reconnect_timeout * 1000;
+    int roll = sim_random(10);
+    sim_return_t plan = roll < 6 ? SIM_RETURN_IN_TIME : (roll < 8 ? SIM_RETURN_LATE : SIM_RETURN_NEVER);
+
+    sim_close(client);
+    client->state = SIM_OFFLINE;
+    client->my_turn = 0;
+    stats.drops++;
+
+    if (plan == SIM_RETURN_IN_TIME) {
+        client->return_at_ms = now_ms + 1000 + sim_random(reconnect_ms / 2);
+    } else if (plan == SIM_RETURN_LATE) {
+        client->return_at_ms = now_ms + reconnect_ms + 5000 + sim_random(10000);
+    } else {
+        client->return_at_ms = -1;
+    }
+}
+
+// Remembering player: complete a known pair if possible, otherwise turn an unknown card
+static int sim_pick_card(sim_client_t *client) {
+    int first = client->reveal_count == 1 ? client->reveals[0] : -1;
+    int candidates[SIM_MAX_CARDS];
+    int candidate_count = 0;
+
+    for (int i = 0; i < client->total_cards; i++) {
+        if (client->known[i] <= 0 || i == first) {
+            continue;
+        }
+        if (first >= 0 && client->known[i] == client->known[first]) {
+            return i;
+        }
+        for (int j = i + 1; first < 0 && j < client->total_cards; j++) {
+            if (client->known[j] == client->known[i]) {
+                return i;
+            }
+        }
+    }
+
+    for (int i = 0; i < client->total_cards; i++) {
+        if (client->known[i] == 0 && i != first) {
+            candidates[candidate_count++] = i;
+        }
+    }
+    if (candidate_count > 0) {
+        return candidates[sim_random(candidate_count)];
+    }
+
+    // Only remembered cards left
+    for (int i = 0; i < client->total_cards; i++) {
+        if (client->known[i] > 0 && i != first) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void sim_take_turn(sim_client_t *client) {
+    if (client->state != SIM_GAME || !client->my_turn || client->reveal_count >= 2) {
+        return;
+    }
+
+    int card = sim_pick_card(client);
+    if (card >= 0) {
+        sim_send(client, 1, "FLIP %d", card);
+        client->my_turn = client->reveal_count == 0;  // Second flip still to come
+    }
+}
+
+static void sim_game_over(sim_client_t *client, int forfeit) {
+    // Both players get the result, count it once per pair (on the owner)
+    sim_client_t *owner = &sim_clients[client->index & ~1];
+    if (!owner->game_counted) {
+        owner->game_counted = 1;
+        if (forfeit) {
+            stats.games_forfeited++;
+        } else {
+            stats.games_finished++;
+        }
+    }
+    client->state = SIM_DONE;
+    sim_close(client);
+}
+
+// Snapshot after a reconnect the room could not replay: GAME_STATE <size> <current> (<nick> <score>)x2 <cards>
+static void sim_load_state(sim_client_t *client, char *params) {
+    char *saveptr = NULL;
+    char *token = strtok_r(params, " ", &saveptr);
+    int board_size = token != NULL ? atoi(token) : 0;
+
+    client->total_cards = board_size * board_size;
+    client->reveal_count = 0;
+    for (int skip = 0; skip < 5 && token != NULL; skip++) {
+        token = strtok_r(NULL, " ", &saveptr);
+    }
+
+    for (int i = 0; i < client->total_cards && (token = strtok_r(NULL, " ", &saveptr)) != NULL; i++) {
+        int value = atoi(token);
+        if (value > 0) {
+            client->known[i] = -1;
+        } else if (value < 0) {
+            client->known[i] = -value;
+            if (client->reveal_count < 2) {
+                client->reveals[client->reveal_count++] = i;
+            }
+        }
+    }
+}
+
+static void sim_handle_line(sim_client_t *client, char *line) {
+    // Room events carry SEQ <n>; keep the number for RECONNECT
+    if (strncmp(line, CMD_SEQ " ", strlen(CMD_SEQ) + 1) == 0) {
+        client->last_seq = (unsigned int)strtoul(line + strlen(CMD_SEQ) + 1, &line, 10);
+        line++;
+    }
+
+    char command[32] = {0};
+    sscanf(line, "%31s", command);
+    char *params = strchr(line, ' ') != NULL ? strchr(line, ' ') + 1 : line + strlen(line);
+
+    // Direct replies to the commands the simulated clients send
+    static const char *replies[] = {
+        "WELCOME", "ERROR", "ROOM_CREATED", "ROOM_JOINED", "READY_OK", "GAME_CREATED", "CARD_REVEAL"
+    };
+    for (size_t i = 0; i < sizeof(replies) / sizeof(replies[0]); i++) {
+        if (strcmp(command, replies[i]) == 0) {
+            sim_set_awaiting(client, 0);
+        }
+    }
+
+    if (strcmp(command, "PING") == 0) {
+        if (!client->silent) {
+            sim_send(client, 0, "PONG %s", params);
+        }
+    } else if (strcmp(command, "WELCOME") == 0) {
+        if (client->state == SIM_RECONNECTING) {
+            stats.reconnects++;
+            client->state = client->in_game ? SIM_GAME : SIM_ROOM;
+            return;
+        }
+        // WELCOME <client_id> SESSION <token>
+        client->client_id = atoi(params);
+        const char *session = strstr(params, "SESSION ");
+        if (session != NULL) {
+            snprintf(client->session_token, sizeof(client->session_token), "%s", session + strlen("SESSION "));
+        }
+        client->state = SIM_LOBBY;
+        if (client->index % 2 == 0) {
+            sim_send(client, 1, "CREATE_ROOM sim%d 2 4", client->index);
+        }
+    } else if (strcmp(command, "ROOM_CREATED") == 0) {
+        client->room_id = atoi(params);
+        client->state = SIM_ROOM;
+        if (client->index + 1 < sim_client_count) {
+            sim_clients[client->index + 1].room_id = client->room_id;
+        }
+    } else if (strcmp(command, "ROOM_JOINED") == 0) {
+        client->state = client->state == SIM_LOBBY ? SIM_ROOM : client->state;
+    } else if (strcmp(command, "PLAYER_JOINED") == 0) {
+        if (client->index % 2 == 0 && client->state == SIM_ROOM) {
+            sim_send(client, 1, "START_GAME");
+        }
+    } else if (strcmp(command, "GAME_CREATED") == 0) {
+        client->total_cards = atoi(params) * atoi(params);
+        sim_send(client, 1, "READY");
+    } else if (strcmp(command, "GAME_START") == 0) {
+        client->state = SIM_GAME;
+        client->in_game = 1;
+        memset(client->known, 0, sizeof(client->known));
+        client->reveal_count = 0;
+        if (client->index % 2 == 0) {
+            stats.games_started++;
+        }
+    } else if (strcmp(command, "GAME_STATE") == 0) {
+        sim_load_state(client, params);
+    } else if (strcmp(command, "YOUR_TURN") == 0) {
+        client->state = SIM_GAME;
+        client->my_turn = 1;
+    } else if (strcmp(command, "CARD_REVEAL") == 0) {
+        int card, value;
+        if (sscanf(params, "%d %d", &card, &value) == 2 && card >= 0 && card < SIM_MAX_CARDS) {
+            client->known[card] = value;
+            if (client->reveal_count < 2) {
+                client->reveals[client->reveal_count++] = card;
+            }
+        }
+    } else if (strcmp(command, "MATCH") == 0) {
+        for (int i = 0; i < client->reveal_count; i++) {
+            client->known[client->reveals[i]] = -1;
+        }
+        client->reveal_count = 0;
+    } else if (strcmp(command, "MISMATCH") == 0) {
+        client->reveal_count = 0;
+        client->my_turn = 0;
+    } else if (strcmp(command, "GAME_END") == 0) {
+        sim_game_over(client, 0);
+    } else if (strcmp(command, "GAME_END_FORFEIT") == 0) {
+        sim_game_over(client, 1);
+    } else if (strcmp(command, "ERROR") == 0) {
+        if (client->state == SIM_RECONNECTING) {
+            stats.reconnects_expired++;
+            client->state = SIM_DONE;
+            sim_close(client);
+            return;
+        }
+        stats.errors++;
+        logger_log(LOG_WARNING, "Sim %d: %s", client->index, line);
+    }
+
+}
+
+static void sim_read(sim_client_t *client, int64_t now_ms) {
+    int received = recv(client->fd, client->buffer + client->buffer_length,
+                        SIM_BUFFER_SIZE - client->buffer_length - 1, MSG_DONTWAIT);
+    if (received <= 0) {
+        // Server closed the connection (PONG timeout or shutdown)
+        if (client->state != SIM_DONE) {
+            if (client->silent) {
+                stats.pong_timeouts++;
+            }
+            client->silent = 0;
+            sim_drop(client, now_ms);
+        }
+        return;
+    }
+
+    client->buffer_length += received;
+    client->buffer[client->buffer_length] = '\0';
+
+    char *start = client->buffer;
+    char *newline;
+    while (client->fd >= 0 && (newline = strchr(start, '\n')) != NULL) {
+        *newline = '\0';
+        sim_handle_line(client, start);
+        start = newline + 1;
+    }
+
+    if (client->fd < 0) {
+        client->buffer_length = 0;
+        return;
+    }
+    client->buffer_length -= (int)(start - client->buffer);
+    memmove(client->buffer, start, client->buffer_length);
+}
+
+// Handle messages until every command got its reply and the server has been quiet for a few polls
+static void sim_settle(struct pollfd *fds, int64_t now_ms) {
+    int idle_polls = 0;
+    int waited_ms = 0;
+
+    while (idle_polls < SIM_SETTLE_IDLE_POLLS || awaiting_replies > 0) {
+        if (waited_ms > SIM_SETTLE_LIMIT_MS) {
+            logger_log(LOG_WARNING, "Sim: %d replies missing after %d ms", awaiting_replies, waited_ms);
+            break;
+        }
+        for (int i = 0; i < sim_client_count; i++) {
+            fds[i].fd = sim_clients[i].fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+
+        int ready = poll(fds, sim_client_count, SIM_SETTLE_POLL_MS);
+        if (ready <= 0) {
+            idle_polls++;
+            waited_ms += SIM_SETTLE_POLL_MS;
+            continue;
+        }
+
+        idle_polls = 0;
+        for (int i = 0; i < sim_client_count; i++) {
+            if (fds[i].revents != 0 && sim_clients[i].fd >= 0) {
+                sim_read(&sim_clients[i], now_ms);
+            }
+        }
+    }
+}
+
+// Per-step client actions, in client order so a seed replays the same choices
+static void sim_act(int64_t now_ms) {
+    for (int i = 0; i < sim_client_count; i++) {
+        sim_client_t *client = &sim_clients[i];
+
+        switch (client->state) {
+            case SIM_LOBBY:
+                if (client->index % 2 == 1 && client->room_id > 0) {
+                    sim_send(client, 1, "JOIN_ROOM %d", client->room_id);
+                    client->room_id = 0;
+                }
+                break;
+            case SIM_GAME:
+                if (sim_random(1000) < SIM_DROP_PER_MILLE) {
+                    sim_drop(client, now_ms);
+                } else {
+                    sim_take_turn(client);
+                }
+                break;
+            case SIM_OFFLINE:
+                if (client->return_at_ms >= 0 && now_ms >= client->return_at_ms) {
+                    if (sim_connect(client) == 0) {
+                        client->state = SIM_RECONNECTING;
+                        sim_send(client, 1, "RECONNECT %s %u", client->session_token, client->last_seq);
+                    }
+                } else if (client->return_at_ms < 0) {
+                    client->state = SIM_DONE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Blocking read of the next line for scenarios (0 on success, -1 on timeout or EOF)
+static int sim_read_line(sim_client_t *client, char *line, size_t size) {
+    while (1) {
+        char *end = memchr(client->buffer, '\n', client->buffer_length);
+        if (end != NULL) {
+            size_t length = (size_t)(end - client->buffer);
+            snprintf(line, size, "%.*s", (int)length, client->buffer);
+            client->buffer_length -= (int)length + 1;
+            memmove(client->buffer, end + 1, client->buffer_length);
+            return 0;
+        }
+
+        struct pollfd pfd = { client->fd, POLLIN, 0 };
+        if (client->buffer_length >= SIM_BUFFER_SIZE || poll(&pfd, 1, SIM_REPLY_TIMEOUT_MS) <= 0) {
+            return -1;
+        }
+        ssize_t received = recv(client->fd, client->buffer + client->buffer_length,
+                                SIM_BUFFER_SIZE - client->buffer_length, 0);
+        if (received <= 0) {
+            return -1;
+        }
+        client->buffer_length += (int)received;
+    }
+}
+
+// Skip lines until one starts with prefix (0 if found)
+static int sim_expect(sim_client_t *client, const char *prefix, char *line, size_t size) {
+    while (sim_read_line(client, line, size) == 0) {
+        if (strncmp(line, prefix, strlen(prefix)) == 0) {
+            return 0;
+        }
+    }
+    logger_log(LOG_ERROR, "Sim %d: no reply starting with '%s'", client->index, prefix);
+    return -1;
+}
+
+// READY right behind LEAVE_ROOM, while the room worker may be clearing client->room
+static void* leave_ready_client(void *arg) {
+    sim_client_t *client = (sim_client_t *)arg;
+    char line[MAX_MESSAGE_LENGTH];
+    char marker[32];
+
+    for (int round = 1; round <= SIM_LEAVE_READY_ROUNDS; round++) {
+        sim_send(client, 0, "CREATE_ROOM r%d 2 4", client->index);
+        sim_send(client, 0, "LEAVE_ROOM");
+        for (int i = 0; i < SIM_LEAVE_READY_BURST; i++) {
+            sim_send(client, 0, "READY");
+        }
+
+        // Replies to a non-room command come after all earlier room commands ran
+        sim_send(client, 0, "#%d LIST_ROOMS", round);
+        snprintf(marker, sizeof(marker), "#%d %s", round, CMD_ROOM_LIST);
+        if (sim_expect(client, marker, line, sizeof(line)) != 0) {
+            atomic_fetch_add(&scenario_errors, 1);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int scenario_leave_ready(void) {
+    pthread_t threads[sim_client_count];
+    char line[MAX_MESSAGE_LENGTH];
+    int started = 0;
+
+    for (int i = 0; i < sim_client_count; i++) {
+        sim_client_t *client = &sim_clients[i];
+        sim_send(client, 0, "HELLO lr%d", i);
+        if (sim_expect(client, CMD_WELCOME, line, sizeof(line)) != 0 ||
+            pthread_create(&threads[started], NULL, leave_ready_client, client) != 0) {
+            atomic_fetch_add(&scenario_errors, 1);
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int errors = atomic_load(&scenario_errors);
+    printf("leave-ready: %d clients x %d rounds, %d errors\n", sim_client_count, SIM_LEAVE_READY_ROUNDS, errors);
+    return errors;
+}
+
+// Session tokens come from getrandom(); linked with --wrap=getrandom so scenarios can fail it
+static atomic_int fail_getrandom = 0;
+
+ssize_t __real_getrandom(void *buffer, size_t length, unsigned int flags);
+
+ssize_t __wrap_getrandom(void *buffer, size_t length, unsigned int flags) {
+    if (atomic_load(&fail_getrandom)) {
+        errno = EIO;
+        return -1;
+    }
+    return __real_getrandom(buffer, length, flags);
+}
+
+// A HELLO that claimed the nickname but couldn't open a session must give the nickname back
+static int scenario_hello_session_fail(void) {
+    char line[MAX_MESSAGE_LENGTH];
+    int errors = 0;
+
+    if (sim_client_count < 2) {
+        fprintf(stderr, "hello-session-fail needs at least 2 clients\n");
+        return 1;
+    }
+
+    atomic_store(&fail_getrandom, 1);
+    sim_send(&sim_clients[0], 0, "HELLO hsf");
+    errors += sim_expect(&sim_clients[0], "ERROR", line, sizeof(line)) != 0;
+    atomic_store(&fail_getrandom, 0);
+
+    // Another client gets the nickname, the failed one can still log in under another
+    sim_send(&sim_clients[1], 0, "HELLO hsf");
+    errors += sim_expect(&sim_clients[1], CMD_WELCOME, line, sizeof(line)) != 0;
+    sim_send(&sim_clients[0], 0, "HELLO hsf0");
+    errors += sim_expect(&sim_clients[0], CMD_WELCOME, line, sizeof(line)) != 0;
+
+    printf("hello-session-fail: %d errors\n", errors);
+    return errors;
+}
+
+typedef struct {
+    const char *name;
+    int (*run)(void);  // Returns the number of failures
+} sim_scenario_t;
+
+static const sim_scenario_t scenarios[] = {
+    { "leave-ready", scenario_leave_ready },
+    { "hello-session-fail", scenario_hello_session_fail },
+};
+
+// Keeps virtual time moving while the server shuts down (its threads sleep on it)
+static void* shutdown_ticker(void *arg) {
+    (void)arg;
+    while (ticking) {
+        clock_advance_ms(SIM_STEP_MS);
+        usleep(1000);
+    }
+    return NULL;
+}
+
+// The paired games (no SCENARIO): returns the number of clients still active
+static int run_games(struct pollfd *fds, unsigned int seed, int64_t duration_ms) {
+    for (int i = 0; i < sim_client_count; i++) {
+        sim_client_t *client = &sim_clients[i];
+        client->silent = sim_random(100) < SIM_SILENT_PERCENT;
+        if (sim_connect(client) == 0) {
+            sim_send(client, 1, "HELLO sim%d", i);
+        }
+    }
+
+    struct timespec wall_start;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    int64_t now_ms = 0;
+    int active = sim_client_count;
+    while (now_ms < duration_ms && active > 0) {
+        sim_settle(fds, now_ms);
+        sim_act(now_ms);
+
+        // Let the background threads finish this tick before clients react
+        clock_advance_ms(SIM_STEP_MS);
+        now_ms += SIM_STEP_MS;
+        clock_wait_sleepers(SIM_BACKGROUND_SLEEPERS, 1000);
+
+        active = 0;
+        for (int i = 0; i < sim_client_count; i++) {
+            active += sim_clients[i].state != SIM_DONE;
+        }
+    }
+
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall_seconds = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+    printf("seed %u: %d clients, %.1f virtual s in %.2f wall s\n",
+           seed, sim_client_count, now_ms / 1000.0, wall_seconds);
+    printf("  games: %d started, %d finished, %d forfeited\n",
+           stats.games_started, stats.games_finished, stats.games_forfeited);
+    printf("  drops: %d (%d PONG timeouts), %d reconnected, %d expired\n",
+           stats.drops, stats.pong_timeouts, stats.reconnects, stats.reconnects_expired);
+    printf("  unexpected errors: %d, clients still active: %d\n", stats.errors, active);
+    return active;
+}
+
+int main(int argc, char *argv[]) {
+    char *args[4];
+    int positional = config_load(argc, argv, args, 4);
+    if (positional != 3 && positional != 4) {
+        fprintf(stderr, "Usage: %s [OPTIONS] <CLIENTS> <SEED> <VIRTUAL_SECONDS> [SCENARIO]\n", argv[0]);
+        return 1;
+    }
+
+    const sim_scenario_t *scenario = NULL;
+    if (positional == 4) {
+        for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+            if (strcmp(args[3], scenarios[i].name) == 0) {
+                scenario = &scenarios[i];
+            }
+        }
+        if (scenario == NULL) {
+            fprintf(stderr, "Error: Unknown scenario '%s'\n", args[3]);
+            return 1;
+        }
+    }
+
+    sim_client_count = atoi(args[0]) & ~1;  // Clients play in pairs
+    unsigned int seed = (unsigned int)strtoul(args[1], NULL, 10);
+    sim_random_state = seed;
+    int64_t duration_ms = CLOCK_MS(atoi(args[2]));
+    if (sim_client_count < 2 || duration_ms <= 0) {
+        fprintf(stderr, "Error: Need at least 2 clients and a positive duration\n");
+        return 1;
+    }
+
+    // Boards and client choices both follow the seed
+    game_set_seed(seed != 0 ? seed : 1);
+    clock_set_virtual(0);
+    signal(SIGPIPE, SIG_IGN);
+
+    runtime_config_t *config = config_get();
+    config->admin_socket[0] = '\0';
+    config->stats_file[0] = '\0';
+    if (logger_configure(config->log_level) != 0 || logger_init("sim.log") != 0) {
+        fprintf(stderr, "Error: Cannot set up logging\n");
+        return 1;
+    }
+
+    // Scenario clients may all hold a room at once
+    int max_rooms = scenario != NULL ? sim_client_count : sim_client_count / 2 + 1;
+    sim_clients = (sim_client_t *)calloc(sim_client_count, sizeof(sim_client_t));
+    struct pollfd *fds = (struct pollfd *)calloc(sim_client_count, sizeof(struct pollfd));
+    if (sim_clients == NULL || fds == NULL ||
+        server_init("127.0.0.1", 0, max_rooms, sim_client_count * 2) != 0) {
+        fprintf(stderr, "Error: Cannot start server\n");
+        return 1;
+    }
+
+    for (int i = 0; i < sim_client_count; i++) {
+        sim_clients[i].index = i;
+        sim_clients[i].fd = -1;
+    }
+
+    int failed;
+    if (scenario != NULL) {
+        for (int i = 0; i < sim_client_count; i++) {
+            sim_connect(&sim_clients[i]);
+        }
+        failed = scenario->run() != 0;
+    } else {
+        failed = run_games(fds, seed, duration_ms) > 0;
+    }
+
+    for (int i = 0; i < sim_client_count; i++) {
+        sim_close(&sim_clients[i]);
+    }
+
+    pthread_t ticker;
+    ticking = 1;
+    pthread_create(&ticker, NULL, shutdown_ticker, NULL);
+    server_get_config()->running = 0;
+    server_shutdown();
+    ticking = 0;
+    pthread_join(ticker, NULL);
+    logger_shutdown();
+
+    free(fds);
+    free(sim_clients);
+    return failed;
+}
@@ -0,0 +1,428 @@
+#define LOG_MODULE LOG_MODULE_ROOM
+
+#include "spectator.h"
+#include "codec.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#define SPECTATOR_INITIAL_CAPACITY 8
+
+#define SEND_BUSY 2  // send_nonblocking(): the spectator's own reply is being written
+
+typedef struct {
+    client_t *client;
+    unsigned int from_seq;  // Events up to this one are covered by the client's snapshot
+    int retry;              // Send lock was busy, try again after the other spectators
+} spectator_t;
+
+typedef struct spectator_event_s {
+    struct spectator_event_s *next;
+    struct spectator_list_s *list;
+    unsigned int seq;
+    int close;  // Room destroyed: send LEFT_ROOM and free the list
+    char message[MAX_MESSAGE_LENGTH];
+} spectator_event_t;
+
+struct spectator_list_s {
+    int room_id;
+    spectator_t *spectators;
+    int capacity;
+    atomic_int count;            // Read without a lock by spectator_publish()
+    unsigned int delivered_seq;  // Last event handed to the spectators
+    spectator_event_t close_event;  // Preallocated, so closing a room can't fail
+};
+
+// One event in both wire formats, each encoded on first use
+typedef struct {
+    const char *message;
+    unsigned char text[CLIENT_WIRE_BUFFER_SIZE];
+    int text_len;
+    unsigned char frame[CLIENT_WIRE_BUFFER_SIZE];
+    int frame_len;
+} wire_message_t;
+
+// Guards the lists and client->spectating; the fan-out thread holds it while sending
+static pthread_mutex_t spectators_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_ready = PTHREAD_COND_INITIALIZER;
+static spectator_event_t *queue_head = NULL;
+static spectator_event_t *queue_tail = NULL;
+static int queue_length = 0;
+static int running = 0;
+static pthread_t fanout_thread;
+
+// Encoded bytes of a message for a client's wire format (0 on error)
+static int wire_encode(wire_message_t *wire, client_t *client, const unsigned char **data) {
+    if (client->binary_mode) {
+        if (wire->frame_len == 0) {
+            wire->frame_len = codec_encode_frame(wire->message, wire->frame, sizeof(wire->frame));
+        }
+        *data = wire->frame;
+        return wire->frame_len > 0 ? wire->frame_len : 0;
+    }
+
+    if (wire->text_len == 0) {
+        wire->text_len = snprintf((char *)wire->text, sizeof(wire->text), "%s\n", wire->message);
+        if (wire->text_len >= (int)sizeof(wire->text)) {
+            wire->text_len = -1;
+        }
+    }
+    *data = wire->text;
+    return wire->text_len > 0 ? wire->text_len : 0;
+}
+
+// Send without waiting for buffer space or for the spectator's send lock: 0 if sent, 1 if
+// the socket didn't take the whole message at once (the spectator is too slow or gone),
+// SEND_BUSY if the spectator's own thread is writing a reply, -1 if there's nothing to send
+static int send_nonblocking(client_t *client, wire_message_t *wire) {
+    if (client->is_disconnected || client->socket_fd < 0) {
+        return -1;
+    }
+
+    const unsigned char *data;
+    int len = wire_encode(wire, client, &data);
+    if (len == 0) {
+        return -1;
+    }
+
+    int result = client_send_nowait(client, data, len, 0);
+    if (result == 0) {
+        return SEND_BUSY;
+    }
+    return result == 1 ? 0 : 1;
+}
+
+// Why a spectator is dropped for a send_nonblocking() result
+static const char* send_failure(int result) {
+    if (result == SEND_BUSY) {
+        return "busy writing its own reply";
+    }
+    return result > 0 ? "socket buffer full or closed" : "send failed";
+}
+
+// Remove a spectator and close its connection (spectators_mutex held)
+static void drop_spectator(spectator_list_t *list, int index, const char *reason) {
+    client_t *client = list->spectators[index].client;
+    int count = atomic_load(&list->count);
+
+    logger_log(LOG_WARNING, "Room %d: Dropping spectator %d (%s): %s",
+               list->room_id, client->client_id, client->nickname, reason);
+
+    // The stream may end mid-message, so close it; the handler thread gets EOF and cleans up
+    client->spectating = NULL;
+    if (client->socket_fd >= 0) {
+        shutdown(client->socket_fd, SHUT_RDWR);
+    }
+
+    list->spectators[index] = list->spectators[count - 1];
+    atomic_store(&list->count, count - 1);
+}
+
+static void free_list(spectator_list_t *list) {
+    free(list->spectators);
+    free(list);
+}
+
+// Send one event to a room's spectators and free it
+static void deliver(spectator_event_t *event) {
+    spectator_list_t *list = event->list;
+    wire_message_t wire;
+    wire.message = event->message;
+    wire.text_len = 0;
+    wire.frame_len = 0;
+
+    pthread_mutex_lock(&spectators_mutex);
+
+    if (event->close) {
+        int count = atomic_load(&list->count);
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < count; i++) {
+                spectator_t *spectator = &list->spectators[i];
+                if (pass == 0 || spectator->retry) {
+                    spectator->retry = (send_nonblocking(spectator->client, &wire) == SEND_BUSY);
+                }
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            list->spectators[i].client->spectating = NULL;
+        }
+        pthread_mutex_unlock(&spectators_mutex);
+
+        if (count > 0) {
+            logger_log(LOG_INFO, "Room %d: %d spectator(s) returned to the lobby", list->room_id, count);
+        }
+        free_list(list);  // Also frees the event
+        return;
+    }
+
+    // Published before the current spectators attached
+    if (event->seq <= list->delivered_seq) {
+        pthread_mutex_unlock(&spectators_mutex);
+        free(event);
+        return;
+    }
+
+    // Events were discarded while the queue was full - the spectators' view can't be repaired
+    if (event->seq != list->delivered_seq + 1) {
+        while (atomic_load(&list->count) > 0) {
+            drop_spectator(list, 0, "missed events");
+        }
+    }
+    list->delivered_seq = event->seq;
+
+    int i = 0;
+    while (i < atomic_load(&list->count)) {
+        spectator_t *spectator = &list->spectators[i];
+        int result = (spectator->from_seq >= event->seq) ? 0 : send_nonblocking(spectator->client, &wire);
+        spectator->retry = (result == SEND_BUSY);
+        if (result == 0 || result == SEND_BUSY) {
+            i++;
+        } else {
+            drop_spectator(list, i, send_failure(result));
+        }
+    }
+
+    // A spectator whose own thread was writing gets one more try after the others. A
+    // skipped event would leave a gap in its view, so if it's still busy it is dropped
+    // like a full socket; a reply to a client that reads only takes microseconds.
+    i = 0;
+    while (i < atomic_load(&list->count)) {
+        spectator_t *spectator = &list->spectators[i];
+        int result = spectator->retry ? send_nonblocking(spectator->client, &wire) : 0;
+        spectator->retry = 0;
+        if (result == 0) {
+            i++;
+        } else {
+            drop_spectator(list, i, send_failure(result));
+        }
+    }
+
+    pthread_mutex_unlock(&spectators_mutex);
+    free(event);
+}
+
+static void* fanout_thread_func(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&queue_mutex);
+    while (running || queue_head != NULL) {
+        if (queue_head == NULL) {
+            pthread_cond_wait(&queue_ready, &queue_mutex);
+            continue;
+        }
+
+        // Take the whole queue, publishers keep appending meanwhile
+        spectator_event_t *event = queue_head;
+        queue_head = NULL;
+        queue_tail = NULL;
+        queue_length = 0;
+        pthread_mutex_unlock(&queue_mutex);
+
+        while (event != NULL) {
+            spectator_event_t *next = event->next;
+            deliver(event);
+            event = next;
+        }
+
+        pthread_mutex_lock(&queue_mutex);
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    return NULL;
+}
+
+// Append to the fan-out queue (queue_mutex held)
+static void queue_push(spectator_event_t *event) {
+    event->next = NULL;
+    if (queue_tail != NULL) {
+        queue_tail->next = event;
+    } else {
+        queue_head = event;
+    }
+    queue_tail = event;
+    queue_length++;
+    pthread_cond_signal(&queue_ready);
+}
+
+int spectator_init(void) {
+    pthread_mutex_lock(&queue_mutex);
+    running = 1;
+    pthread_mutex_unlock(&queue_mutex);
+
+    int result = pthread_create(&fanout_thread, NULL, fanout_thread_func, NULL);
+    if (result != 0) {
+        logger_log(LOG_ERROR, "Failed to create spectator fan-out thread: %s", strerror(result));
+        running = 0;
+        return -1;
+    }
+
+    logger_log(LOG_INFO, "Spectator fan-out thread started");
+    return 0;
+}
+
+void spectator_shutdown(void) {
+    pthread_mutex_lock(&queue_mutex);
+    if (!running) {
+        pthread_mutex_unlock(&queue_mutex);
+        return;
+    }
+    running = 0;
+    pthread_cond_signal(&queue_ready);
+    pthread_mutex_unlock(&queue_mutex);
+
+    pthread_join(fanout_thread, NULL);
+    logger_log(LOG_INFO, "Spectator fan-out thread stopped");
+}
+
+spectator_list_t* spectator_list_create(int room_id) {
+    spectator_list_t *list = (spectator_list_t *)calloc(1, sizeof(spectator_list_t));
+    if (list == NULL) {
+        logger_log(LOG_ERROR, "Failed to allocate spectator list for room %d", room_id);
+        return NULL;
+    }
+
+    list->room_id = room_id;
+    atomic_init(&list->count, 0);
+    return list;
+}
+
+int spectator_attach(spectator_list_t *list, client_t *client, unsigned int seq) {
+    if (list == NULL || client == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&spectators_mutex);
+
+    if (client->spectating != NULL) {
+        pthread_mutex_unlock(&spectators_mutex);
+        return -1;
+    }
+
+    int count = atomic_load(&list->count);
+    if (count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : SPECTATOR_INITIAL_CAPACITY;
+        spectator_t *grown = (spectator_t *)realloc(list->spectators, (size_t)capacity * sizeof(spectator_t));
+        if (grown == NULL) {
+            logger_log(LOG_ERROR, "Room %d: Failed to grow spectator list", list->room_id);
+            pthread_mutex_unlock(&spectators_mutex);
+            return -1;
+        }
+        list->spectators = grown;
+        list->capacity = capacity;
+    }
+
+    // Nothing was published while the list was empty, so the stream restarts here
+    if (count == 0) {
+        list->delivered_seq = seq;
+    }
+
+    list->spectators[count].client = client;
+    list->spectators[count].from_seq = seq;
+    list->spectators[count].retry = 0;
+    atomic_store(&list->count, count + 1);
+    client->spectating = list;
+
+    pthread_mutex_unlock(&spectators_mutex);
+
+    logger_log(LOG_INFO, "Client %d (%s) is watching room %d (%d spectator(s), from seq %u)",
+               client->client_id, client->nickname, list->room_id, count + 1, seq);
+    return 0;
+}
+
+int spectator_detach(client_t *client) {
+    if (client == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&spectators_mutex);
+
+    spectator_list_t *list = client->spectating;
+    if (list == NULL) {
+        pthread_mutex_unlock(&spectators_mutex);
+        return 0;
+    }
+
+    int count = atomic_load(&list->count);
+    for (int i = 0; i < count; i++) {
+        if (list->spectators[i].client == client) {
+            list->spectators[i] = list->spectators[count - 1];
+            atomic_store(&list->count, count - 1);
+            break;
+        }
+    }
+    client->spectating = NULL;
+    int room_id = list->room_id;
+
+    pthread_mutex_unlock(&spectators_mutex);
+
+    logger_log(LOG_INFO, "Client %d (%s) stopped watching room %d", client->client_id, client->nickname, room_id);
+    return 1;
+}
+
+int spectator_is_watching(client_t *client) {
+    pthread_mutex_lock(&spectators_mutex);
+    int watching = (client->spectating != NULL);
+    pthread_mutex_unlock(&spectators_mutex);
+    return watching;
+}
+
+int spectator_count(spectator_list_t *list) {
+    return list != NULL ? atomic_load(&list->count) : 0;
+}
+
+void spectator_publish(spectator_list_t *list, unsigned int seq, const char *message) {
+    if (list == NULL || atomic_load_explicit(&list->count, memory_order_relaxed) == 0) {
+        return;
+    }
+
+    spectator_event_t *event = (spectator_event_t *)malloc(sizeof(spectator_event_t));
+    if (event == NULL) {
+        logger_log(LOG_ERROR, "Room %d: Failed to allocate spectator event", list->room_id);
+        return;
+    }
+    event->list = list;
+    event->seq = seq;
+    event->close = 0;
+    snprintf(event->message, sizeof(event->message), "%s", message);
+
+    pthread_mutex_lock(&queue_mutex);
+    if (!running || queue_length >= SPECTATOR_QUEUE_LIMIT) {
+        pthread_mutex_unlock(&queue_mutex);
+        free(event);
+        // The sequence gap makes the fan-out thread drop this room's spectators
+        logger_log_ratelimited(LOG_WARNING, 5, "Room %d: Spectator queue full, event %u discarded",
+                               list->room_id, seq);
+        return;
+    }
+    queue_push(event);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+void spectator_close(spectator_list_t *list) {
+    if (list == NULL) {
+        return;
+    }
+
+    spectator_event_t *event = &list->close_event;
+    event->list = list;
+    event->seq = 0;
+    event->close = 1;
+    snprintf(event->message, sizeof(event->message), "%s", CMD_LEFT_ROOM);
+
+    // Not limited: the list must always reach the fan-out thread, after the room's last events
+    pthread_mutex_lock(&queue_mutex);
+    if (running) {
+        queue_push(event);
+        pthread_mutex_unlock(&queue_mutex);
+        return;
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    // Shutdown: the spectators' clients may be gone already, don't touch them
+    free_list(list);
+}
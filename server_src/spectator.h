@@ -0,0 +1,87 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include "client_handler.h"
+
+/**
+ * Spectator module - read-only watchers of a room (SPECTATE)
+ *
+ * Every room with spectators owns a spectator list. Room broadcasts are copied
+ * into a queue under the room lock (one small copy, no socket I/O) and a single
+ * fan-out thread delivers them later, encoding each event once per wire format
+ * and sending the same bytes to every watcher. The queue and the lists are
+ * guarded by mutexes that only this module takes, never the room lock. Sends
+ * don't wait for buffer space or for the spectator's send lock: a spectator
+ * whose socket buffer is full, or whose own reply is still being written after
+ * the others got the event, is dropped, so players are never slowed down.
+ */
+
+#define SPECTATOR_QUEUE_LIMIT 4096  // Events waiting for fan-out before new ones are discarded
+
+typedef struct spectator_list_s spectator_list_t;
+
+/**
+ * Start the fan-out thread
+ * @return 0 on success, -1 on error
+ */
+int spectator_init(void);
+
+/**
+ * Deliver pending events and stop the fan-out thread
+ */
+void spectator_shutdown(void);
+
+/**
+ * Create an empty spectator list for a room
+ * @param room_id Room ID (for logging)
+ * @return New list or NULL on error
+ */
+spectator_list_t* spectator_list_create(int room_id);
+
+/**
+ * Subscribe a client to a room's events (room lock held)
+ * @param list Room's spectator list
+ * @param client Client to attach
+ * @param seq Last room event the client already knows from its snapshot
+ * @return 0 on success, -1 if the client already watches a room or on error
+ */
+int spectator_attach(spectator_list_t *list, client_t *client, unsigned int seq);
+
+/**
+ * Stop watching (call before any other room change and on disconnect)
+ * Once this returns, the fan-out thread no longer touches the client.
+ * @param client Client to detach
+ * @return 1 if the client was watching a room, 0 otherwise
+ */
+int spectator_detach(client_t *client);
+
+/**
+ * Check if a client watches a room
+ * @param client Client
+ * @return 1 if watching, 0 otherwise
+ */
+int spectator_is_watching(client_t *client);
+
+/**
+ * Get number of spectators
+ * @param list Spectator list (can be NULL)
+ * @return Number of attached spectators
+ */
+int spectator_count(spectator_list_t *list);
+
+/**
+ * Queue a room event for the spectators (room lock held, never blocks)
+ * @param list Spectator list (can be NULL)
+ * @param seq Sequence number of the event
+ * @param message Stamped event as sent to the players
+ */
+void spectator_publish(spectator_list_t *list, unsigned int seq, const char *message);
+
+/**
+ * Hand the list of a destroyed room to the fan-out thread: spectators get the
+ * events still queued, then LEFT_ROOM, and the list is freed
+ * @param list Spectator list (can be NULL)
+ */
+void spectator_close(spectator_list_t *list);
+
+#endif /* SPECTATOR_H */
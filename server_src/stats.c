@@ -0,0 +1,448 @@
+#define LOG_MODULE LOG_MODULE_GAME
+
+#include "stats.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#define STATS_INITIAL_CAPACITY 64
+
+typedef struct {
+    stats_record_t record;
+    int dirty;  // Queued for the writer
+} stats_entry_t;
+
+// Entry i is record slot i of the file
+static stats_entry_t *entries = NULL;
+static int entry_count = 0;
+static int entry_capacity = 0;
+
+// Nickname index: open addressing with linear probing, at most half full (entry + 1, 0 = empty)
+static int *buckets = NULL;
+static unsigned int bucket_mask = 0;
+
+static int *dirty = NULL;  // Entries changed since the last write
+static int dirty_count = 0;
+
+static int top[STATS_TOP_K];  // Entries, best first
+static int top_count = 0;
+
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wakeup;  // Uses CLOCK_MONOTONIC, set up in stats_init()
+static int stats_fd = -1;
+static int running = 0;
+static pthread_t writer_thread;
+
+// FNV-1a
+static unsigned int nickname_hash(const char *nickname) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)nickname; *p != '\0'; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// Bucket holding the nickname, or the empty bucket ending its probe run (stats_mutex held)
+static unsigned int find_bucket(const char *nickname) {
+    unsigned int slot = nickname_hash(nickname) & bucket_mask;
+    while (buckets[slot] != 0 && strcmp(entries[buckets[slot] - 1].record.nickname, nickname) != 0) {
+        slot = (slot + 1) & bucket_mask;
+    }
+    return slot;
+}
+
+// Double the bucket array and reinsert all entries (stats_mutex held)
+static int grow_index(void) {
+    unsigned int count = (bucket_mask + 1) * 2;
+    int *grown = (int *)calloc(count, sizeof(int));
+    if (grown == NULL) {
+        return -1;
+    }
+
+    free(buckets);
+    buckets = grown;
+    bucket_mask = count - 1;
+    for (int i = 0; i < entry_count; i++) {
+        buckets[find_bucket(entries[i].record.nickname)] = i + 1;
+    }
+    return 0;
+}
+
+// Entry of a nickname, created if missing (stats_mutex held)
+static int entry_for(const char *nickname) {
+    unsigned int slot = find_bucket(nickname);
+    if (buckets[slot] != 0) {
+        return buckets[slot] - 1;
+    }
+
+    if (entry_count == entry_capacity) {
+        int capacity = entry_capacity * 2;
+        stats_entry_t *grown = (stats_entry_t *)realloc(entries, capacity * sizeof(stats_entry_t));
+        if (grown == NULL) {
+            return -1;
+        }
+        entries = grown;
+        int *grown_dirty = (int *)realloc(dirty, capacity * sizeof(int));
+        if (grown_dirty == NULL) {
+            return -1;
+        }
+        dirty = grown_dirty;
+        entry_capacity = capacity;
+    }
+
+    if ((unsigned int)(entry_count + 1) * 2 > bucket_mask + 1) {
+        if (grow_index() != 0) {
+            return -1;
+        }
+        slot = find_bucket(nickname);
+    }
+
+    stats_entry_t *entry = &entries[entry_count];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->record.nickname, sizeof(entry->record.nickname), "%s", nickname);
+    buckets[slot] = entry_count + 1;
+    return entry_count++;
+}
+
+// Leaderboard order: wins, then pairs (both only grow), nickname breaks ties
+static int ranks_above(int a, int b) {
+    const stats_record_t *ra = &entries[a].record;
+    const stats_record_t *rb = &entries[b].record;
+    if (ra->wins != rb->wins) {
+        return ra->wins > rb->wins;
+    }
+    if (ra->pairs != rb->pairs) {
+        return ra->pairs > rb->pairs;
+    }
+    return strcmp(ra->nickname, rb->nickname) < 0;
+}
+
+// Move an entry whose totals grew into place (stats_mutex held); an entry
+// outside the table can only overtake the last one through its own update
+static void top_update(int index) {
+    int pos = -1;
+    for (int i = 0; i < top_count; i++) {
+        if (top[i] == index) {
+            pos = i;
+            break;
+        }
+    }
+
+    if (pos < 0) {
+        if (top_count < STATS_TOP_K) {
+            pos = top_count++;
+        } else if (ranks_above(index, top[STATS_TOP_K - 1])) {
+            pos = STATS_TOP_K - 1;
+        } else {
+            return;
+        }
+        top[pos] = index;
+    }
+
+    while (pos > 0 && ranks_above(top[pos], top[pos - 1])) {
+        int tmp = top[pos];
+        top[pos] = top[pos - 1];
+        top[pos - 1] = tmp;
+        pos--;
+    }
+}
+
+static void mark_dirty(int index) {
+    if (stats_fd >= 0 && !entries[index].dirty) {
+        entries[index].dirty = 1;
+        dirty[dirty_count++] = index;
+    }
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Write dirty records, consecutive slots in one pwrite() (only one thread flushes at a time)
+static void flush_dirty(void) {
+    pthread_mutex_lock(&stats_mutex);
+    int count = dirty_count;
+    if (count == 0 || stats_fd < 0) {
+        pthread_mutex_unlock(&stats_mutex);
+        return;
+    }
+
+    int *slots = (int *)malloc(count * sizeof(int));
+    stats_record_t *records = (stats_record_t *)malloc(count * sizeof(stats_record_t));
+    if (slots == NULL || records == NULL) {
+        pthread_mutex_unlock(&stats_mutex);
+        free(slots);
+        free(records);
+        logger_log(LOG_ERROR, "Stats: Failed to allocate write batch");
+        return;
+    }
+
+    // Copy under the lock, write without it
+    qsort(dirty, count, sizeof(int), compare_ints);
+    for (int i = 0; i < count; i++) {
+        slots[i] = dirty[i];
+        records[i] = entries[dirty[i]].record;
+        entries[dirty[i]].dirty = 0;
+    }
+    dirty_count = 0;
+    int fd = stats_fd;
+    pthread_mutex_unlock(&stats_mutex);
+
+    int writes = 0;
+    for (int start = 0; start < count; ) {
+        int end = start + 1;
+        while (end < count && slots[end] == slots[end - 1] + 1) {
+            end++;
+        }
+
+        size_t bytes = (size_t)(end - start) * sizeof(stats_record_t);
+        off_t offset = (off_t)sizeof(stats_file_header_t) + (off_t)slots[start] * (off_t)sizeof(stats_record_t);
+        if (pwrite(fd, &records[start], bytes, offset) != (ssize_t)bytes) {
+            logger_log(LOG_ERROR, "Stats: Failed to write records: %s", strerror(errno));
+        }
+        writes++;
+        start = end;
+    }
+
+    logger_log(LOG_DEBUG, "Stats: Wrote %d record(s) in %d write(s)", count, writes);
+    free(slots);
+    free(records);
+}
+
+static void* stats_writer_func(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&stats_mutex);
+    while (running) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_sec += STATS_FLUSH_INTERVAL_MS / 1000;
+        ts.tv_nsec += (STATS_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&writer_wakeup, &stats_mutex, &ts);
+
+        pthread_mutex_unlock(&stats_mutex);
+        flush_dirty();
+        pthread_mutex_lock(&stats_mutex);
+    }
+    pthread_mutex_unlock(&stats_mutex);
+
+    return NULL;
+}
+
+// Read the header and all records into memory (stats_mutex held)
+static int load_file(int fd, const char *path) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        logger_log(LOG_ERROR, "Stats: Cannot stat %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    stats_file_header_t header;
+    if (st.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, STATS_MAGIC, sizeof(STATS_MAGIC));
+        header.version = STATS_VERSION;
+        header.record_size = sizeof(stats_record_t);
+        if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+            logger_log(LOG_ERROR, "Stats: Cannot write header to %s: %s", path, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header.magic, STATS_MAGIC, sizeof(STATS_MAGIC)) != 0 ||
+        header.version != STATS_VERSION || header.record_size != sizeof(stats_record_t)) {
+        logger_log(LOG_ERROR, "Stats: %s is not a version %d stats file", path, STATS_VERSION);
+        return -1;
+    }
+
+    // A torn last record (crash mid-write) is dropped
+    int slots = (int)((st.st_size - (off_t)sizeof(header)) / (off_t)sizeof(stats_record_t));
+    for (int slot = 0; slot < slots; slot++) {
+        stats_record_t record;
+        off_t offset = (off_t)sizeof(header) + (off_t)slot * (off_t)sizeof(stats_record_t);
+        if (pread(fd, &record, sizeof(record), offset) != (ssize_t)sizeof(record)) {
+            logger_log(LOG_ERROR, "Stats: Cannot read %s: %s", path, strerror(errno));
+            return -1;
+        }
+        record.nickname[sizeof(record.nickname) - 1] = '\0';
+
+        // Slots must stay in file order, so even a damaged record keeps its entry
+        int index = entry_for(record.nickname);
+        if (index != slot) {
+            logger_log(LOG_ERROR, "Stats: Duplicate or bad record %d in %s", slot, path);
+            return -1;
+        }
+        entries[index].record = record;
+        top_update(index);
+    }
+
+    return 0;
+}
+
+int stats_init(const char *path) {
+    pthread_mutex_lock(&stats_mutex);
+
+    entries = (stats_entry_t *)malloc(STATS_INITIAL_CAPACITY * sizeof(stats_entry_t));
+    dirty = (int *)malloc(STATS_INITIAL_CAPACITY * sizeof(int));
+    buckets = (int *)calloc(STATS_INITIAL_CAPACITY * 2, sizeof(int));
+    if (entries == NULL || dirty == NULL || buckets == NULL) {
+        pthread_mutex_unlock(&stats_mutex);
+        logger_log(LOG_ERROR, "Stats: Failed to allocate tables");
+        return -1;
+    }
+    entry_capacity = STATS_INITIAL_CAPACITY;
+    bucket_mask = STATS_INITIAL_CAPACITY * 2 - 1;
+
+    if (path == NULL || path[0] == '\0') {
+        pthread_mutex_unlock(&stats_mutex);
+        logger_log(LOG_INFO, "Stats: Kept in memory only");
+        return 0;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        pthread_mutex_unlock(&stats_mutex);
+        logger_log(LOG_ERROR, "Stats: Cannot open %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    if (load_file(fd, path) != 0) {
+        // Start empty rather than overwrite a file we don't understand
+        entry_count = 0;
+        top_count = 0;
+        memset(buckets, 0, (bucket_mask + 1) * sizeof(int));
+        close(fd);
+        pthread_mutex_unlock(&stats_mutex);
+        return -1;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&writer_wakeup, &attr);
+    pthread_condattr_destroy(&attr);
+
+    stats_fd = fd;
+    running = 1;
+    int players = entry_count;
+    pthread_mutex_unlock(&stats_mutex);
+
+    int result = pthread_create(&writer_thread, NULL, stats_writer_func, NULL);
+    if (result != 0) {
+        logger_log(LOG_ERROR, "Stats: Failed to create writer thread: %s", strerror(result));
+        pthread_mutex_lock(&stats_mutex);
+        running = 0;
+        stats_fd = -1;
+        pthread_mutex_unlock(&stats_mutex);
+        pthread_cond_destroy(&writer_wakeup);
+        close(fd);
+        return -1;
+    }
+
+    logger_log(LOG_INFO, "Stats: Loaded %d player(s) from %s", players, path);
+    return 0;
+}
+
+void stats_shutdown(void) {
+    pthread_mutex_lock(&stats_mutex);
+    int was_running = running;
+    running = 0;
+    if (was_running) {
+        pthread_cond_signal(&writer_wakeup);
+    }
+    pthread_mutex_unlock(&stats_mutex);
+
+    if (was_running) {
+        pthread_join(writer_thread, NULL);
+        flush_dirty();
+        fdatasync(stats_fd);
+        close(stats_fd);
+        pthread_cond_destroy(&writer_wakeup);
+        logger_log(LOG_INFO, "Stats: Saved %d player(s)", entry_count);
+    }
+
+    pthread_mutex_lock(&stats_mutex);
+    stats_fd = -1;
+    free(entries);
+    free(dirty);
+    free(buckets);
+    entries = NULL;
+    dirty = NULL;
+    buckets = NULL;
+    entry_count = 0;
+    entry_capacity = 0;
+    dirty_count = 0;
+    bucket_mask = 0;
+    top_count = 0;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+void stats_record_game(game_t *game, client_t *forfeiter) {
+    if (game == NULL) {
+        return;
+    }
+
+    // Highest score among the players who stayed (same rule as game_get_winners)
+    int best_score = -1;
+    for (int i = 0; i < game->player_count; i++) {
+        if (game->players[i] != NULL && game->players[i] != forfeiter && game->player_scores[i] > best_score) {
+            best_score = game->player_scores[i];
+        }
+    }
+
+    pthread_mutex_lock(&stats_mutex);
+    if (entries == NULL) {
+        pthread_mutex_unlock(&stats_mutex);
+        return;
+    }
+
+    for (int i = 0; i < game->player_count; i++) {
+        client_t *player = game->players[i];
+        if (player == NULL || player->bot != NULL) {
+            continue;
+        }
+
+        int index = entry_for(player->nickname);
+        if (index < 0) {
+            logger_log(LOG_ERROR, "Stats: No room for player %s", player->nickname);
+            continue;
+        }
+
+        stats_record_t *record = &entries[index].record;
+        record->games++;
+        record->pairs += (uint32_t)game->player_scores[i];
+        record->flips += (uint32_t)game->player_flips[i];
+        if (player != forfeiter && game->player_scores[i] == best_score) {
+            record->wins++;
+        }
+        mark_dirty(index);
+        top_update(index);
+    }
+
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+int stats_get_top(stats_record_t *out, int max_count) {
+    pthread_mutex_lock(&stats_mutex);
+    int count = top_count < max_count ? top_count : max_count;
+    for (int i = 0; i < count; i++) {
+        out[i] = entries[top[i]].record;
+    }
+    pthread_mutex_unlock(&stats_mutex);
+    return count;
+}
@@ -0,0 +1,69 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "game.h"
+#include <stdint.h>
+
+/**
+ * Stats module - per-nickname player statistics and the leaderboard
+ *
+ * Totals (games, wins, pairs, flips) live in memory in an open-addressing
+ * hash index keyed by nickname. Each nickname owns a fixed-size record slot in
+ * the stats file, read once at startup. Updates only change memory and mark the
+ * record dirty; a background thread writes dirty records to their slots in
+ * batches (write-behind). A top-K table ordered by wins, then pairs, is kept up
+ * to date on every finished game. Totals only grow, so a player can only enter
+ * the table through their own update, and LEADERBOARD is answered from the table
+ * without touching the disk or the other players.
+ */
+
+#define STATS_MAGIC "PXSTATS"           // First bytes of the stats file
+#define STATS_VERSION 1
+#define STATS_TOP_K 10                  // Players kept in the leaderboard
+#define STATS_FLUSH_INTERVAL_MS 1000    // Write-behind period
+#define DEFAULT_STATS_FILE "pexeso-stats.db"
+
+typedef struct {
+    char nickname[MAX_NICK_LENGTH];
+    uint32_t games;
+    uint32_t wins;
+    uint32_t pairs;         // Pairs found (forfeit bonus not included)
+    uint32_t flips;         // Cards flipped
+} stats_record_t;
+
+typedef struct {
+    char magic[8];          // STATS_MAGIC
+    uint32_t version;       // STATS_VERSION
+    uint32_t record_size;   // sizeof(stats_record_t)
+    uint32_t reserved[4];
+} stats_file_header_t;
+
+/**
+ * Load the stats file and start the write-behind thread
+ * @param path Stats file ("" keeps statistics in memory only)
+ * @return 0 on success, -1 if the file can't be used (statistics stay in memory)
+ */
+int stats_init(const char *path);
+
+/**
+ * Write pending records and stop the write-behind thread
+ */
+void stats_shutdown(void);
+
+/**
+ * Add a finished game to its players' totals (bots are skipped). Only memory is
+ * touched, so it may be called with the room lock held.
+ * @param game Game before game_destroy(), scores without forfeit bonus
+ * @param forfeiter Player whose leaving ended the game (never wins), or NULL
+ */
+void stats_record_game(game_t *game, client_t *forfeiter);
+
+/**
+ * Copy the leaderboard (best first)
+ * @param out Output array
+ * @param max_count Size of output array
+ * @return Number of records copied
+ */
+int stats_get_top(stats_record_t *out, int max_count);
+
+#endif /* STATS_H */
@@ -0,0 +1,221 @@
+#define LOG_MODULE LOG_MODULE_SERVER
+
+#include "timer.h"
+#include "clock.h"
+#include "logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define TIMER_INITIAL_CAPACITY 64
+#define TIMER_BATCH 32  // Due timers taken per lock round
+
+typedef struct {
+    int64_t deadline_ms;
+    unsigned int id;
+    int key;
+    timer_callback_t callback;
+} timer_entry_t;
+
+static pthread_mutex_t timers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timers_changed;  // Uses CLOCK_MONOTONIC, set up in timer_init()
+static timer_entry_t *heap = NULL;
+static int heap_size = 0;
+static int heap_capacity = 0;
+static unsigned int next_timer_id = 1;
+static int running = 0;
+static pthread_t timer_thread;
+
+static void heap_swap(int a, int b) {
+    timer_entry_t tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+}
+
+static void heap_push(const timer_entry_t *entry) {
+    int i = heap_size++;
+    heap[i] = *entry;
+    while (i > 0 && heap[(i - 1) / 2].deadline_ms > heap[i].deadline_ms) {
+        heap_swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static timer_entry_t heap_pop(void) {
+    timer_entry_t top = heap[0];
+    heap[0] = heap[--heap_size];
+
+    int i = 0;
+    for (;;) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < heap_size && heap[left].deadline_ms < heap[smallest].deadline_ms) {
+            smallest = left;
+        }
+        if (right < heap_size && heap[right].deadline_ms < heap[smallest].deadline_ms) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        heap_swap(i, smallest);
+        i = smallest;
+    }
+    return top;
+}
+
+// Sleep until the earliest deadline, a sooner timer or shutdown (timers_mutex held)
+static void wait_for_deadline(void) {
+    if (clock_is_virtual()) {
+        // Virtual time only moves in clock_advance_ms() steps, so sleeping to the
+        // next step is exact and lets clock_wait_sleepers() count this thread
+        pthread_mutex_unlock(&timers_mutex);
+        clock_sleep_ms(1);
+        pthread_mutex_lock(&timers_mutex);
+        return;
+    }
+
+    if (heap_size == 0) {
+        pthread_cond_wait(&timers_changed, &timers_mutex);
+        return;
+    }
+
+    int64_t remaining_ms = heap[0].deadline_ms - clock_now_ms();
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += remaining_ms / 1000;
+    ts.tv_nsec += (remaining_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&timers_changed, &timers_mutex, &ts);
+}
+
+static void* timer_thread_func(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&timers_mutex);
+    while (running) {
+        if (heap_size == 0 || heap[0].deadline_ms > clock_now_ms()) {
+            wait_for_deadline();
+            continue;
+        }
+
+        // Callbacks run unlocked so they may arm new timers
+        timer_entry_t due[TIMER_BATCH];
+        int count = 0;
+        int64_t now = clock_now_ms();
+        while (count < TIMER_BATCH && heap_size > 0 && heap[0].deadline_ms <= now) {
+            due[count++] = heap_pop();
+        }
+        pthread_mutex_unlock(&timers_mutex);
+
+        for (int i = 0; i < count; i++) {
+            due[i].callback(due[i].key, due[i].id);
+        }
+
+        pthread_mutex_lock(&timers_mutex);
+    }
+    pthread_mutex_unlock(&timers_mutex);
+
+    return NULL;
+}
+
+int timer_init(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timers_changed, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_lock(&timers_mutex);
+    heap = (timer_entry_t *)malloc(TIMER_INITIAL_CAPACITY * sizeof(timer_entry_t));
+    if (heap == NULL) {
+        pthread_mutex_unlock(&timers_mutex);
+        logger_log(LOG_ERROR, "Failed to allocate timer heap");
+        return -1;
+    }
+    heap_capacity = TIMER_INITIAL_CAPACITY;
+    heap_size = 0;
+    running = 1;
+    pthread_mutex_unlock(&timers_mutex);
+
+    int result = pthread_create(&timer_thread, NULL, timer_thread_func, NULL);
+    if (result != 0) {
+        logger_log(LOG_ERROR, "Failed to create timer thread: %s", strerror(result));
+        running = 0;
+        free(heap);
+        heap = NULL;
+        return -1;
+    }
+
+    logger_log(LOG_INFO, "Timer thread started");
+    return 0;
+}
+
+void timer_shutdown(void) {
+    pthread_mutex_lock(&timers_mutex);
+    if (!running) {
+        pthread_mutex_unlock(&timers_mutex);
+        return;
+    }
+    running = 0;
+    pthread_cond_signal(&timers_changed);
+    pthread_mutex_unlock(&timers_mutex);
+
+    pthread_join(timer_thread, NULL);
+
+    if (heap_size > 0) {
+        logger_log(LOG_INFO, "Discarding %d pending timer(s)", heap_size);
+    }
+    free(heap);
+    heap = NULL;
+    heap_size = 0;
+    heap_capacity = 0;
+    pthread_cond_destroy(&timers_changed);
+    logger_log(LOG_INFO, "Timer thread stopped");
+}
+
+unsigned int timer_schedule(int64_t delay_ms, timer_callback_t callback, int key) {
+    if (callback == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&timers_mutex);
+    if (!running) {
+        pthread_mutex_unlock(&timers_mutex);
+        return 0;
+    }
+
+    if (heap_size == heap_capacity) {
+        timer_entry_t *grown = (timer_entry_t *)realloc(heap, heap_capacity * 2 * sizeof(timer_entry_t));
+        if (grown == NULL) {
+            pthread_mutex_unlock(&timers_mutex);
+            logger_log(LOG_ERROR, "Failed to grow timer heap");
+            return 0;
+        }
+        heap = grown;
+        heap_capacity *= 2;
+    }
+
+    timer_entry_t entry;
+    entry.deadline_ms = clock_now_ms() + delay_ms;
+    entry.id = next_timer_id++;
+    if (next_timer_id == 0) {
+        next_timer_id = 1;  // 0 means "no timer" to the owners
+    }
+    entry.key = key;
+    entry.callback = callback;
+    heap_push(&entry);
+
+    // Wake the thread if the new timer is now the earliest
+    if (heap[0].id == entry.id) {
+        pthread_cond_signal(&timers_changed);
+    }
+    pthread_mutex_unlock(&timers_mutex);
+
+    return entry.id;
+}
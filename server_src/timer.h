@@ -0,0 +1,49 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+/**
+ * Timer module - one-shot deadlines on the clock module's time
+ *
+ * Pending timers sit in a min-heap ordered by deadline; a single thread sleeps
+ * until the earliest one is due (or a sooner one is added) and runs the
+ * callbacks, so there is no polling and no scan over idle owners. Timers can't
+ * be cancelled: an owner remembers the ID it armed last and ignores the others
+ * when they fire.
+ */
+
+/**
+ * Called on the timer thread when a timer is due, with no timer lock held.
+ * Callbacks run one after another, so a slow one delays every later timer;
+ * hand longer work to another thread. Without room workers the turn and bot
+ * callbacks run room work right here (worker_pool_run_inline(): inline lock,
+ * room lock, socket sends). That can't deadlock: timer_schedule() only takes
+ * the timer lock for the heap push, and since timers aren't cancelled no thread
+ * (e.g. room_start_turn() re-arming under the inline lock) waits for a callback.
+ * @param key Value passed to timer_schedule() (e.g. a room ID)
+ * @param id ID returned by timer_schedule()
+ */
+typedef void (*timer_callback_t)(int key, unsigned int id);
+
+/**
+ * Start the timer thread
+ * @return 0 on success, -1 on error
+ */
+int timer_init(void);
+
+/**
+ * Stop the timer thread, pending timers are discarded
+ */
+void timer_shutdown(void);
+
+/**
+ * Arm a one-shot timer
+ * @param delay_ms Milliseconds from now
+ * @param callback Function to call when the timer is due
+ * @param key Value handed to the callback
+ * @return Timer ID (never 0), or 0 on error
+ */
+unsigned int timer_schedule(int64_t delay_ms, timer_callback_t callback, int key);
+
+#endif /* TIMER_H */
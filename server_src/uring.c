@@ -0,0 +1,392 @@
+#define LOG_MODULE LOG_MODULE_IO
+
+#include "uring.h"
+#include "logger.h"
+
+#if USE_IO_URING && defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+
+#ifdef HAVE_IO_URING
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+typedef struct {
+    int ring_fd;
+    unsigned int sq_entries;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr;
+    void *cq_ptr;
+    size_t sq_size;
+    size_t cq_size;
+    size_t sqes_size;
+    unsigned int pending;  // SQEs prepared but not yet submitted
+} uring_t;
+
+static int enabled = 0;
+static pthread_key_t ring_key;
+
+static int sys_io_uring_setup(unsigned int entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(int ring_fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int ring_fd, unsigned int opcode, void *arg, unsigned int nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+static void ring_free(uring_t *ring) {
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED && ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_size);
+    }
+    if (ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED) {
+        munmap(ring->sq_ptr, ring->sq_size);
+    }
+    if (ring->ring_fd >= 0) {
+        close(ring->ring_fd);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+}
+
+static int ring_init(uring_t *ring, unsigned int entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+
+    ring->ring_fd = sys_io_uring_setup(entries, &params);
+    if (ring->ring_fd < 0) {
+        return -1;
+    }
+
+    ring->sq_entries = params.sq_entries;
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    // Both rings share one mapping on kernels with IORING_FEAT_SINGLE_MMAP
+    int single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && ring->cq_size > ring->sq_size) {
+        ring->sq_size = ring->cq_size;
+    }
+
+    ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        ring_free(ring);
+        return -1;
+    }
+
+    if (single_mmap) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->ring_fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            ring_free(ring);
+            return -1;
+        }
+    }
+
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring_free(ring);
+        return -1;
+    }
+
+    char *sq = (char *)ring->sq_ptr;
+    char *cq = (char *)ring->cq_ptr;
+    ring->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->pending = 0;
+
+    return 0;
+}
+
+// Next free SQE, or NULL when the submission queue is full
+static struct io_uring_sqe* ring_get_sqe(uring_t *ring) {
+    unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    unsigned int tail = *ring->sq_tail + ring->pending;
+
+    if (tail - head >= ring->sq_entries) {
+        return NULL;
+    }
+
+    unsigned int index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    ring->pending++;
+    return sqe;
+}
+
+// Publish prepared SQEs, submit them and wait for min_complete completions
+static int ring_submit_and_wait(uring_t *ring, unsigned int min_complete) {
+    unsigned int to_submit = ring->pending;
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + to_submit, __ATOMIC_RELEASE);
+    ring->pending = 0;
+
+    int result;
+    do {
+        result = sys_io_uring_enter(ring->ring_fd, to_submit, min_complete,
+                                    min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+    } while (result < 0 && errno == EINTR && min_complete == 0);
+
+    return result;
+}
+
+// Take one completion if available
+static int ring_peek_cqe(uring_t *ring, struct io_uring_cqe *out) {
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return 0;
+    }
+
+    *out = ring->cqes[head & *ring->cq_mask];
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static void thread_ring_destroy(void *arg) {
+    uring_t *ring = (uring_t *)arg;
+    ring_free(ring);
+    free(ring);
+}
+
+// Send ring of the calling thread, created on first use
+static uring_t* thread_ring(void) {
+    uring_t *ring = (uring_t *)pthread_getspecific(ring_key);
+    if (ring != NULL) {
+        return ring;
+    }
+
+    ring = (uring_t *)malloc(sizeof(uring_t));
+    if (ring == NULL) {
+        return NULL;
+    }
+    if (ring_init(ring, URING_SEND_ENTRIES) != 0) {
+        logger_log(LOG_WARNING, "io_uring: Failed to create send ring: %s", strerror(errno));
+        free(ring);
+        return NULL;
+    }
+
+    pthread_setspecific(ring_key, ring);
+    return ring;
+}
+
+int uring_init(void) {
+    uring_t probe_ring;
+    if (ring_init(&probe_ring, 2) != 0) {
+        logger_log(LOG_INFO, "io_uring not available (%s), using blocking socket I/O", strerror(errno));
+        return 0;
+    }
+
+    // Opcodes needed: ACCEPT (5.5) and SEND (5.6)
+    size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, probe_size);
+    int supported = 0;
+    if (probe != NULL && sys_io_uring_register(probe_ring.ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0) {
+        supported = probe->last_op >= IORING_OP_SEND &&
+                    (probe->ops[IORING_OP_ACCEPT].flags & IO_URING_OP_SUPPORTED) &&
+                    (probe->ops[IORING_OP_SEND].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    ring_free(&probe_ring);
+
+    if (!supported) {
+        logger_log(LOG_INFO, "io_uring lacks accept/send support, using blocking socket I/O");
+        return 0;
+    }
+
+    if (pthread_key_create(&ring_key, thread_ring_destroy) != 0) {
+        return 0;
+    }
+
+    enabled = 1;
+    logger_log(LOG_INFO, "io_uring backend enabled");
+    return 1;
+}
+
+int uring_enabled(void) {
+    return enabled;
+}
+
+int uring_send_batch(uring_send_t *sends, int count) {
+    if (!enabled) {
+        return -1;
+    }
+
+    uring_t *ring = thread_ring();
+    if (ring == NULL) {
+        return -1;
+    }
+
+    int done = 0;
+    while (done < count) {
+        int chunk = count - done;
+        if (chunk > (int)ring->sq_entries) {
+            chunk = (int)ring->sq_entries;
+        }
+
+        for (int i = 0; i < chunk; i++) {
+            uring_send_t *send_op = &sends[done + i];
+            struct io_uring_sqe *sqe = ring_get_sqe(ring);
+
+            sqe->opcode = IORING_OP_SEND;
+            sqe->fd = send_op->fd;
+            sqe->addr = (unsigned long)send_op->data;
+            sqe->len = (unsigned int)send_op->len;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            sqe->user_data = (unsigned long long)(done + i);
+
+            // Keep per-socket order: link to the next send on the same socket
+            if (i + 1 < chunk && sends[done + i + 1].fd == send_op->fd) {
+                sqe->flags |= IOSQE_IO_LINK;
+            }
+        }
+
+        if (ring_submit_and_wait(ring, (unsigned int)chunk) < 0) {
+            logger_log(LOG_ERROR, "io_uring: Send submission failed: %s", strerror(errno));
+            for (int i = 0; i < chunk; i++) {
+                sends[done + i].result = -errno;
+            }
+            return 0;
+        }
+
+        int completed = 0;
+        while (completed < chunk) {
+            struct io_uring_cqe cqe;
+            if (!ring_peek_cqe(ring, &cqe)) {
+                // Interrupted wait - block for the rest
+                sys_io_uring_enter(ring->ring_fd, 0, (unsigned int)(chunk - completed), IORING_ENTER_GETEVENTS);
+                continue;
+            }
+            sends[cqe.user_data].result = cqe.res;
+            completed++;
+        }
+
+        done += chunk;
+    }
+
+    return 0;
+}
+
+static int arm_multishot_accept(uring_t *ring, int listen_fd) {
+    struct io_uring_sqe *sqe = ring_get_sqe(ring);
+    if (sqe == NULL) {
+        return -1;
+    }
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = 1;
+    return ring_submit_and_wait(ring, 0) < 0 ? -1 : 0;
+}
+
+int uring_accept_loop(int listen_fd, volatile int *running, void (*on_accept)(int client_fd)) {
+    if (!enabled) {
+        return -1;
+    }
+
+    uring_t ring;
+    if (ring_init(&ring, 8) != 0 || arm_multishot_accept(&ring, listen_fd) != 0) {
+        logger_log(LOG_WARNING, "io_uring: Failed to arm accept: %s", strerror(errno));
+        return -1;
+    }
+
+    logger_log(LOG_INFO, "io_uring: Multishot accept armed");
+
+    int accepted = 0;
+    while (*running) {
+        // Sleep until at least one connection (or the shutdown error) completes
+        if (sys_io_uring_enter(ring.ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            logger_log(LOG_ERROR, "io_uring: Wait failed: %s", strerror(errno));
+            break;
+        }
+
+        struct io_uring_cqe cqe;
+        while (ring_peek_cqe(&ring, &cqe)) {
+            if (cqe.res >= 0) {
+                accepted++;
+                on_accept(cqe.res);
+            } else if (cqe.res == -EINVAL && accepted == 0 && *running) {
+                // Kernel before 5.19 - no multishot accept
+                logger_log(LOG_INFO, "io_uring: Multishot accept unsupported, using accept()");
+                ring_free(&ring);
+                return -1;
+            } else if (*running) {
+                logger_log(LOG_ERROR, "Failed to accept connection: %s", strerror(-cqe.res));
+            }
+
+            // The kernel drops a multishot request after errors - re-arm it
+            if (!(cqe.flags & IORING_CQE_F_MORE) && *running) {
+                if (arm_multishot_accept(&ring, listen_fd) != 0) {
+                    logger_log(LOG_ERROR, "io_uring: Failed to re-arm accept, using accept()");
+                    ring_free(&ring);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    ring_free(&ring);
+    return 0;
+}
+
+#else /* !HAVE_IO_URING */
+
+int uring_init(void) {
+    logger_log(LOG_INFO, "io_uring support not compiled in, using blocking socket I/O");
+    return 0;
+}
+
+int uring_enabled(void) {
+    return 0;
+}
+
+int uring_send_batch(uring_send_t *sends, int count) {
+    (void)sends;
+    (void)count;
+    return -1;
+}
+
+int uring_accept_loop(int listen_fd, volatile int *running, void (*on_accept)(int client_fd)) {
+    (void)listen_fd;
+    (void)running;
+    (void)on_accept;
+    return -1;
+}
+
+#endif /* HAVE_IO_URING */
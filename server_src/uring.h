@@ -0,0 +1,54 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+
+/**
+ * io_uring backend - multishot accept and batched sends
+ *
+ * Used instead of accept()/send() when the kernel supports it, probed once at
+ * startup. Without support every function reports failure and callers keep
+ * using the plain socket calls.
+ */
+
+#define USE_IO_URING 1          // Set to 0 to always use the plain socket path
+#define URING_SEND_ENTRIES 64   // Submission queue size of per-thread send rings
+
+typedef struct {
+    int fd;            // Socket to send on
+    const void *data;  // Bytes to send
+    size_t len;        // Number of bytes
+    int result;        // Bytes sent or -errno (filled in by uring_send_batch)
+} uring_send_t;
+
+/**
+ * Probe kernel support and enable the backend
+ * @return 1 if io_uring is used, 0 if falling back to plain sockets
+ */
+int uring_init(void);
+
+/**
+ * Check if the io_uring backend is active
+ * @return 1 if active, 0 otherwise
+ */
+int uring_enabled(void);
+
+/**
+ * Send a batch with one io_uring_enter per URING_SEND_ENTRIES sends.
+ * Consecutive sends to the same socket are linked so they keep their order.
+ * @param sends Sends to perform, result fields are filled in
+ * @param count Number of sends
+ * @return 0 when all sends were submitted, -1 if the caller must send itself
+ */
+int uring_send_batch(uring_send_t *sends, int count);
+
+/**
+ * Accept connections with a single multishot accept until running drops to 0
+ * @param listen_fd Listening socket
+ * @param running Loop flag (cleared by the signal handler)
+ * @param on_accept Called for every accepted socket
+ * @return 0 after shutdown, -1 if the caller must continue with accept()
+ */
+int uring_accept_loop(int listen_fd, volatile int *running, void (*on_accept)(int client_fd));
+
+#endif /* URING_H */
@@ -0,0 +1,237 @@
+#define LOG_MODULE LOG_MODULE_ROOM
+
+#include "worker_pool.h"
+#include "logger.h"
+#include "coro.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+typedef struct {
+    pthread_t thread;
+    int index;
+    _Atomic(worker_task_t *) head;  // Producers swap themselves in here
+    worker_task_t *tail;            // Consumer side (worker only)
+    worker_task_t stub;             // Placeholder node keeping the queue non-empty
+    sem_t wakeup;                   // One post per pushed task
+    atomic_int depth;
+} worker_t;
+
+typedef struct {
+    worker_task_t task;
+    void (*fn)(void *arg);
+    void *arg;
+    coro_wait_t done;
+} sync_task_t;
+
+static worker_t *workers = NULL;
+static int worker_count = 0;
+static atomic_int running = 0;
+static __thread worker_t *current_worker = NULL;  // Worker running on this thread
+
+// Room work without workers: one task at a time, on whichever thread brings it
+static pthread_mutex_t inline_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread int inline_depth = 0;  // Nested inline work already holds the lock
+
+// Vyukov intrusive MPSC queue: push is a single atomic exchange, wait-free for producers
+static void mailbox_push(worker_t *worker, worker_task_t *task) {
+    atomic_store_explicit((_Atomic(worker_task_t *) *)&task->next, NULL, memory_order_relaxed);
+    worker_task_t *prev = atomic_exchange_explicit(&worker->head, task, memory_order_acq_rel);
+    atomic_store_explicit((_Atomic(worker_task_t *) *)&prev->next, task, memory_order_release);
+}
+
+// Returns NULL if empty or if a producer is between exchange and link (caller retries)
+static worker_task_t* mailbox_pop(worker_t *worker) {
+    worker_task_t *tail = worker->tail;
+    worker_task_t *next = atomic_load_explicit((_Atomic(worker_task_t *) *)&tail->next, memory_order_acquire);
+
+    if (tail == &worker->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        worker->tail = next;
+        tail = next;
+        next = atomic_load_explicit((_Atomic(worker_task_t *) *)&tail->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        worker->tail = next;
+        return tail;
+    }
+
+    if (tail != atomic_load_explicit(&worker->head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    // Last real node - put the stub back behind it so it can be detached
+    mailbox_push(worker, &worker->stub);
+    next = atomic_load_explicit((_Atomic(worker_task_t *) *)&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        worker->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+static void* worker_thread_func(void *arg) {
+    worker_t *worker = (worker_t *)arg;
+    current_worker = worker;
+
+    logger_log(LOG_INFO, "Room worker %d running", worker->index);
+
+    while (1) {
+        sem_wait(&worker->wakeup);
+
+        if (!atomic_load(&running) && atomic_load(&worker->depth) == 0) {
+            break;
+        }
+
+        // A post guarantees a pushed task; it may not be linked yet
+        worker_task_t *task;
+        while ((task = mailbox_pop(worker)) == NULL) {
+            sched_yield();
+        }
+
+        atomic_fetch_sub(&worker->depth, 1);
+        task->run(task);
+    }
+
+    logger_log(LOG_INFO, "Room worker %d terminated", worker->index);
+    return NULL;
+}
+
+int worker_pool_init(int count) {
+    if (count <= 0) {
+        logger_log(LOG_INFO, "Room workers disabled, room commands run on handler threads");
+        return 0;
+    }
+
+    workers = (worker_t *)calloc(count, sizeof(worker_t));
+    if (workers == NULL) {
+        logger_log(LOG_ERROR, "Failed to allocate room workers");
+        return -1;
+    }
+
+    atomic_store(&running, 1);
+
+    for (int i = 0; i < count; i++) {
+        worker_t *worker = &workers[i];
+        worker->index = i;
+        worker->stub.next = NULL;
+        worker->tail = &worker->stub;
+        atomic_init(&worker->head, &worker->stub);
+        atomic_init(&worker->depth, 0);
+        sem_init(&worker->wakeup, 0, 0);
+
+        int result = pthread_create(&worker->thread, NULL, worker_thread_func, worker);
+        if (result != 0) {
+            logger_log(LOG_ERROR, "Failed to create room worker %d: %s", i, strerror(result));
+            worker_count = i;
+            worker_pool_shutdown();
+            return -1;
+        }
+    }
+
+    worker_count = count;
+    logger_log(LOG_INFO, "Room worker pool started (%d workers)", worker_count);
+    return 0;
+}
+
+void worker_pool_shutdown(void) {
+    if (workers == NULL) {
+        return;
+    }
+
+    atomic_store(&running, 0);
+
+    // Workers drain their mailboxes, then exit on the extra post
+    for (int i = 0; i < worker_count; i++) {
+        sem_post(&workers[i].wakeup);
+    }
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+        sem_destroy(&workers[i].wakeup);
+    }
+
+    free(workers);
+    workers = NULL;
+    worker_count = 0;
+
+    logger_log(LOG_INFO, "Room worker pool stopped");
+}
+
+int worker_pool_enabled(void) {
+    return worker_count > 0 && atomic_load(&running);
+}
+
+int worker_pool_on_worker(void) {
+    return current_worker != NULL;
+}
+
+static worker_t* worker_for_room(int room_id) {
+    unsigned int key = (unsigned int)room_id;
+    return &workers[key % (unsigned int)worker_count];
+}
+
+int worker_pool_submit(int room_id, worker_task_t *task) {
+    if (!worker_pool_enabled() || task == NULL) {
+        return -1;
+    }
+
+    worker_t *worker = worker_for_room(room_id);
+    atomic_fetch_add(&worker->depth, 1);
+    mailbox_push(worker, task);
+    sem_post(&worker->wakeup);
+    return 0;
+}
+
+void worker_pool_run_inline(worker_task_t *task) {
+    if (inline_depth > 0) {
+        task->run(task);
+        return;
+    }
+
+    pthread_mutex_lock(&inline_mutex);
+    inline_depth++;
+    task->run(task);
+    inline_depth--;
+    pthread_mutex_unlock(&inline_mutex);
+}
+
+static void run_sync_task(worker_task_t *task) {
+    sync_task_t *sync = (sync_task_t *)task;
+    sync->fn(sync->arg);
+    coro_wait_done(&sync->done);
+}
+
+void worker_pool_run_sync(int room_id, void (*fn)(void *arg), void *arg) {
+    // Already serialised with the room's commands; queueing would wait on ourselves
+    if (current_worker != NULL && current_worker == worker_for_room(room_id)) {
+        fn(arg);
+        return;
+    }
+
+    sync_task_t sync;
+    memset(&sync, 0, sizeof(sync));
+    sync.task.run = run_sync_task;
+    sync.fn = fn;
+    sync.arg = arg;
+    coro_wait_init(&sync.done);
+    coro_wait_add(&sync.done);
+
+    if (worker_pool_submit(room_id, &sync.task) != 0) {
+        worker_pool_run_inline(&sync.task);
+    }
+    coro_wait_all(&sync.done);
+}
+
+int worker_pool_queue_depth(int room_id) {
+    if (worker_count <= 0) {
+        return 0;
+    }
+    return atomic_load(&worker_for_room(room_id)->depth);
+}
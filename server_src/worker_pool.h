@@ -0,0 +1,81 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+/**
+ * Worker pool module - room actors
+ *
+ * Every room is owned by one worker (room_id % worker count). Work for a room is
+ * pushed into the owning worker's lock-free MPSC mailbox and executed there in
+ * FIFO order. In-room commands, joins, spectators, reconnects, disconnects, admin
+ * closes, turn and bot timers and the setup of quick match and benchmark games all
+ * change the room there; other threads only create rooms and read them under the
+ * room lock, which is never held across a socket send. Without workers (or once they
+ * stopped) room work runs on the calling thread under one lock, as if a single
+ * worker owned every room.
+ */
+
+#define WORKER_THREADS 4  // Number of room workers (0 = run room commands on handler threads)
+
+typedef struct worker_task_s {
+    struct worker_task_s *next;  // Mailbox link (owned by the pool)
+    void (*run)(struct worker_task_s *task);  // Called on the worker; must free the task if needed
+} worker_task_t;
+
+/**
+ * Start worker threads
+ * @param worker_count Number of workers (0 disables the pool)
+ * @return 0 on success, -1 on error
+ */
+int worker_pool_init(int worker_count);
+
+/**
+ * Drain mailboxes and stop worker threads
+ */
+void worker_pool_shutdown(void);
+
+/**
+ * Check if room work is executed on workers
+ * @return 1 if the pool is running, 0 if work runs inline
+ */
+int worker_pool_enabled(void);
+
+/**
+ * Check if the calling thread is a room worker
+ * @return 1 if called from a worker, 0 otherwise
+ */
+int worker_pool_on_worker(void);
+
+/**
+ * Enqueue a task to the worker owning a room (never blocks)
+ * @param room_id Room ID selecting the worker
+ * @param task Task to run
+ * @return 0 on success, -1 if the pool is not running
+ */
+int worker_pool_submit(int room_id, worker_task_t *task);
+
+/**
+ * Run a task on the calling thread, serialised with all other inline room work
+ * (for when worker_pool_submit() fails); may block while another thread runs one
+ * @param task Task to run
+ */
+void worker_pool_run_inline(worker_task_t *task);
+
+/**
+ * Run a function on the worker owning a room and wait for it to finish.
+ * Runs inline if the caller is that worker, or with worker_pool_run_inline() if the
+ * pool is disabled. Callers are handler, admin and timeout-checker threads; a worker
+ * must not wait on another worker's room (two workers doing so could deadlock).
+ * @param room_id Room ID selecting the worker
+ * @param fn Function to run
+ * @param arg Function argument
+ */
+void worker_pool_run_sync(int room_id, void (*fn)(void *arg), void *arg);
+
+/**
+ * Get number of tasks waiting in the mailbox of a room's worker
+ * @param room_id Room ID selecting the worker
+ * @return Mailbox depth
+ */
+int worker_pool_queue_depth(int room_id);
+
+#endif /* WORKER_POOL_H */